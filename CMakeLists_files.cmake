@@ -44,7 +44,9 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/grid/cpgpreprocess/preprocess.c
         opm/core/grid/cpgpreprocess/uniquepoints.c
         opm/core/grid/grid.c
+        opm/core/grid/grid_binary.c
         opm/core/grid/grid_equal.cpp
+        opm/core/io/AsyncOutputWriter.cpp
         opm/core/io/OutputWriter.cpp
         opm/core/io/eclipse/EclipseGridInspector.cpp
         opm/core/io/eclipse/EclipseReader.cpp
@@ -159,10 +161,17 @@ list (APPEND TEST_SOURCE_FILES
 	tests/test_dgbasis.cpp
 	tests/test_cartgrid.cpp
   tests/test_ug.cpp
+	tests/test_cpgpreprocess.cpp
+	tests/test_writevtkdata.cpp
 	tests/test_cubic.cpp
 	tests/test_event.cpp
+	tests/test_asyncoutputwriter.cpp
 	tests/test_flowdiagnostics.cpp
+	tests/test_reordersolver.cpp
+	tests/test_implicittransport.cpp
+	tests/test_blackoilpropertiesfromdeck.cpp
 	tests/test_nonuniformtablelinear.cpp
+	tests/test_regiontemperaturetable.cpp
 	tests/test_parallelistlinformation.cpp
 	tests/test_sparsevector.cpp
 	tests/test_sparsetable.cpp
@@ -218,6 +227,7 @@ list (APPEND TEST_DATA_FILES
 	tests/satfuncEPS_B.DATA
 	tests/satfuncEPS_C.DATA
 	tests/satfuncEPS_D.DATA
+	tests/satfuncEPS_2p.DATA
 	tests/testBlackoilState1.DATA
 	tests/testBlackoilState2.DATA
   tests/testBlackoilState3.DATA
@@ -289,11 +299,13 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/grid/MinpvProcessor.hpp
         opm/core/grid/PinchProcessor.hpp
         opm/core/grid/cart_grid.h
+        opm/core/grid/grid_binary.h
         opm/core/grid/cornerpoint_grid.h
         opm/core/grid/cpgpreprocess/facetopology.h
         opm/core/grid/cpgpreprocess/geometry.h
         opm/core/grid/cpgpreprocess/preprocess.h
         opm/core/grid/cpgpreprocess/uniquepoints.h
+        opm/core/io/AsyncOutputWriter.hpp
         opm/core/io/OutputWriter.hpp
         opm/core/io/eclipse/CornerpointChopper.hpp
         opm/core/io/eclipse/EclipseGridInspector.hpp
@@ -354,6 +366,7 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/props/phaseUsageFromDeck.hpp
         opm/core/props/pvt/PvtPropertiesBasic.hpp
         opm/core/props/pvt/PvtPropertiesIncompFromDeck.hpp
+        opm/core/props/pvt/RegionTemperatureTable.hpp
         opm/core/props/pvt/ThermalGasPvtWrapper.hpp
         opm/core/props/pvt/ThermalOilPvtWrapper.hpp
         opm/core/props/pvt/ThermalWaterPvtWrapper.hpp
@@ -34,10 +34,36 @@
 #include <numeric>
 #include <iostream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Opm
 {
 
 
+    /// Quadrature data depending only on grid geometry and basis, which
+    /// may be reused for any number of solves. The matrices are stored
+    /// with the same (Fortran) ordering as Workspace::jac.
+    struct TofDiscGalReorder::QuadratureCache
+    {
+        std::vector<double> cell_basis_integral; // \int_K b_j, num_basis per cell
+        std::vector<double> cell_mass;           // \int_K b_i b_j, num_basis^2 per cell
+        // Points for the cell integral of b_j (v \cdot \grad b_i).
+        std::vector<int> cell_quadpos;           // First point of each cell, size num_cells + 1
+        std::vector<double> quad_weight;         // One per point
+        std::vector<double> quad_coord;          // dim per point
+        std::vector<double> quad_basis;          // num_basis per point
+        std::vector<double> quad_grad_basis;     // num_basis*dim per point
+        // Face integrals, indexed by half-face (position in grid.cell_faces).
+        std::vector<double> hface_mass;          // \int_F b_i b_j, num_basis^2 per half-face
+        std::vector<double> hface_coupling;      // \int_F b_j b^{nb}_i, num_basis^2 per half-face,
+                                                 // b^{nb} being the basis of the neighbour cell
+    };
+
+
+
+
     /// Construct solver.
     TofDiscGalReorder::TofDiscGalReorder(const UnstructuredGrid& grid,
                                          const parameter::ParameterGroup& param)
@@ -47,8 +73,6 @@ namespace Opm
           limiter_relative_flux_threshold_(1e-3),
           limiter_method_(MinUpwindAverage),
           limiter_usage_(DuringComputations),
-          coord_(grid.dimensions),
-          velocity_(grid.dimensions),
           gauss_seidel_tol_(1e-3)
     {
         const int dg_degree = param.getDefault("dg_degree", 0);
@@ -62,6 +86,7 @@ namespace Opm
         tracers_ensure_unity_ = param.getDefault("tracers_ensure_unity", true);
 
         use_cvi_ = param.getDefault("use_cvi", use_cvi_);
+        setParallelComponents(param.getDefault("parallel_components", false));
         use_limiter_ = param.getDefault("use_limiter", use_limiter_);
         if (use_limiter_) {
             limiter_relative_flux_threshold_ = param.getDefault("limiter_relative_flux_threshold",
@@ -96,6 +121,17 @@ namespace Opm
         } else {
             velocity_interpolation_.reset(new VelocityInterpolationConstant(grid_));
         }
+        if (param.getDefault("precompute_quadrature", false)) {
+            precomputeQuadrature();
+        }
+    }
+
+
+
+
+    /// Destructor.
+    TofDiscGalReorder::~TofDiscGalReorder()
+    {
     }
 
 
@@ -122,14 +158,9 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis);
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
-        velocity_interpolation_->setupFluxes(darcyflux);
         num_tracers_ = 0;
+        setupWorkspace(1);
+        velocity_interpolation_->setupFluxes(darcyflux);
         num_multicell_ = 0;
         max_size_multicell_ = 0;
         max_iter_multicell_ = 0;
@@ -201,12 +232,7 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis*(num_tracers_ + 1));
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
+        setupWorkspace(num_tracers_ + 1);
         velocity_interpolation_->setupFluxes(darcyflux);
 
         // Set up tracer
@@ -272,29 +298,31 @@ namespace Opm
         // For tracers, the equation is the same, except for the last
         // term being zero (the one with \phi).
         //
-        // The rhs_ vector contains a (Fortran ordering) matrix of all
+        // The ws.rhs vector contains a (Fortran ordering) matrix of all
         // right-hand-sides, first for tof and then (optionally) for
         // all tracers.
 
         const int num_basis = basis_func_->numBasisFunc();
+#pragma omp atomic
         ++num_singlesolves_;
 
-        std::fill(rhs_.begin(), rhs_.end(), 0.0);
-        std::fill(jac_.begin(), jac_.end(), 0.0);
+        Workspace& ws = workspace();
+        std::fill(ws.rhs.begin(), ws.rhs.end(), 0.0);
+        std::fill(ws.jac.begin(), ws.jac.end(), 0.0);
 
-        // Add cell contributions to res_ and jac_.
-        cellContribs(cell);
+        // Add cell contributions to ws.rhs and ws.jac.
+        cellContribs(cell, ws);
 
-        // Add face contributions to res_ and jac_.
-        faceContribs(cell);
+        // Add face contributions to ws.rhs and ws.jac.
+        faceContribs(cell, ws);
 
         // Solve linear equation.
-        solveLinearSystem(cell);
+        solveLinearSystem(cell, ws);
 
-        // The solution ends up in rhs_, so we must copy it.
-        std::copy(rhs_.begin(), rhs_.begin() + num_basis, tof_coeff_ + num_basis*cell);
+        // The solution ends up in ws.rhs, so we must copy it.
+        std::copy(ws.rhs.begin(), ws.rhs.begin() + num_basis, tof_coeff_ + num_basis*cell);
         if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
-            std::copy(rhs_.begin() + num_basis, rhs_.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
+            std::copy(ws.rhs.begin() + num_basis, ws.rhs.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
         }
 
         // Apply limiter.
@@ -331,30 +359,50 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::cellContribs(const int cell)
+    void TofDiscGalReorder::cellContribs(const int cell, Workspace& ws)
     {
         const int num_basis = basis_func_->numBasisFunc();
         const int dim = grid_.dimensions;
 
         // Compute cell residual contribution.
-        {
+        if (quad_cache_) {
+            const double* bint = &quad_cache_->cell_basis_integral[num_basis*cell];
+            for (int j = 0; j < num_basis; ++j) {
+                ws.rhs[j] += bint[j] * porevolume_[cell] / grid_.cell_volumes[cell];
+            }
+        } else {
             const int deg_needed = basis_func_->degree();
             CellQuadrature quad(grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // Integral of: b_i \phi
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     // Only adding to the tof rhs.
-                    rhs_[j] += w * basis_[j] * porevolume_[cell] / grid_.cell_volumes[cell];
+                    ws.rhs[j] += w * ws.basis[j] * porevolume_[cell] / grid_.cell_volumes[cell];
                 }
             }
         }
 
         // Compute cell jacobian contribution. We use Fortran ordering
-        // for jac_, i.e. rows cycling fastest.
-        {
+        // for ws.jac, i.e. rows cycling fastest.
+        if (quad_cache_) {
+            const QuadratureCache& qc = *quad_cache_;
+            for (int qp = qc.cell_quadpos[cell]; qp < qc.cell_quadpos[cell + 1]; ++qp) {
+                const double* basis = &qc.quad_basis[num_basis*qp];
+                const double* grad_basis = &qc.quad_grad_basis[num_basis*dim*qp];
+                velocity_interpolation_->interpolate(cell, &qc.quad_coord[dim*qp], &ws.velocity[0]);
+                const double w = qc.quad_weight[qp];
+                for (int j = 0; j < num_basis; ++j) {
+                    for (int i = 0; i < num_basis; ++i) {
+                        for (int dd = 0; dd < dim; ++dd) {
+                            ws.jac[j*num_basis + i] -= w * basis[j] * grad_basis[dim*i + dd] * ws.velocity[dd];
+                        }
+                    }
+                }
+            }
+        } else {
             // Even with ECVI velocity interpolation, degree of precision 1
             // is sufficient for optimal convergence order for DG1 when we
             // use linear (total degree 1) basis functions.
@@ -368,15 +416,15 @@ namespace Opm
             CellQuadrature quad(grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // b_i (v \cdot \grad b_j)
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->evalGrad(cell, &coord_[0], &grad_basis_[0]);
-                velocity_interpolation_->interpolate(cell, &coord_[0], &velocity_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
+                basis_func_->evalGrad(cell, &ws.coord[0], &ws.grad_basis[0]);
+                velocity_interpolation_->interpolate(cell, &ws.coord[0], &ws.velocity[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
                         for (int dd = 0; dd < dim; ++dd) {
-                            jac_[j*num_basis + i] -= w * basis_[j] * grad_basis_[dim*i + dd] * velocity_[dd];
+                            ws.jac[j*num_basis + i] -= w * ws.basis[j] * ws.grad_basis[dim*i + dd] * ws.velocity[dd];
                         }
                     }
                 }
@@ -392,16 +440,23 @@ namespace Opm
             // A sink.
             const double flux = -source_[cell]; // Sign convention for flux: outflux > 0.
             const double flux_density = flux / grid_.cell_volumes[cell];
+            if (quad_cache_) {
+                const double* mass = &quad_cache_->cell_mass[num_basis*num_basis*cell];
+                for (int k = 0; k < num_basis*num_basis; ++k) {
+                    ws.jac[k] += flux_density * mass[k];
+                }
+                return;
+            }
             // Do quadrature over the cell to compute
             // \int_{K} b_i flux b_j dx
             CellQuadrature quad(grid_, cell, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * flux_density * basis_[j];
+                        ws.jac[j*num_basis + i] += w * ws.basis[i] * flux_density * ws.basis[j];
                     }
                 }
             }
@@ -411,7 +466,7 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::faceContribs(const int cell)
+    void TofDiscGalReorder::faceContribs(const int cell, Workspace& ws)
     {
         const int num_basis = basis_func_->numBasisFunc();
 
@@ -445,26 +500,45 @@ namespace Opm
             // velocity is constant (this assumption may have to go
             // for higher order than DG1).
             const double normal_velocity = flux / grid_.face_areas[face];
+            if (quad_cache_) {
+                // rhs_j -= normal_velocity * sum_i (\int_F b_j b^{up}_i) c^{up}_i
+                const double* coupling = &quad_cache_->hface_coupling[num_basis*num_basis*hface];
+                const double* up_tof_co = tof_coeff_ + num_basis*upstream_cell;
+                for (int j = 0; j < num_basis; ++j) {
+                    ws.rhs[j] -= normal_velocity * std::inner_product(up_tof_co, up_tof_co + num_basis,
+                                                                      coupling + num_basis*j, 0.0);
+                }
+                if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
+                    for (int tr = 0; tr < num_tracers_; ++tr) {
+                        const double* up_tr_co = tracer_coeff_ + num_tracers_*num_basis*upstream_cell + num_basis*tr;
+                        for (int j = 0; j < num_basis; ++j) {
+                            ws.rhs[num_basis*(tr + 1) + j] -= normal_velocity
+                                * std::inner_product(up_tr_co, up_tr_co + num_basis, coupling + num_basis*j, 0.0);
+                        }
+                    }
+                }
+                continue;
+            }
             const int deg_needed = 2*basis_func_->degree();
             FaceQuadrature quad(grid_, face, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->eval(upstream_cell, &coord_[0], &basis_nb_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
+                basis_func_->eval(upstream_cell, &ws.coord[0], &ws.basis_nb[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 // Modify tof rhs
-                const double tof_upstream = std::inner_product(basis_nb_.begin(), basis_nb_.end(),
+                const double tof_upstream = std::inner_product(ws.basis_nb.begin(), ws.basis_nb.end(),
                                                                tof_coeff_ + num_basis*upstream_cell, 0.0);
                 for (int j = 0; j < num_basis; ++j) {
-                    rhs_[j] -= w * tof_upstream * normal_velocity * basis_[j];
+                    ws.rhs[j] -= w * tof_upstream * normal_velocity * ws.basis[j];
                 }
                 // Modify tracer rhs
                 if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
                     for (int tr = 0; tr < num_tracers_; ++tr) {
                         const double* up_tr_co = tracer_coeff_ + num_tracers_*num_basis*upstream_cell + num_basis*tr;
-                        const double tracer_up = std::inner_product(basis_nb_.begin(), basis_nb_.end(), up_tr_co, 0.0);
+                        const double tracer_up = std::inner_product(ws.basis_nb.begin(), ws.basis_nb.end(), up_tr_co, 0.0);
                         for (int j = 0; j < num_basis; ++j) {
-                            rhs_[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * basis_[j];
+                            ws.rhs[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * ws.basis[j];
                         }
                     }
                 }
@@ -487,15 +561,22 @@ namespace Opm
             // Do quadrature over the face to compute
             // \int_{\partial K} b_i (v(x) \cdot n) b_j ds
             const double normal_velocity = flux / grid_.face_areas[face];
+            if (quad_cache_) {
+                const double* mass = &quad_cache_->hface_mass[num_basis*num_basis*hface];
+                for (int k = 0; k < num_basis*num_basis; ++k) {
+                    ws.jac[k] += normal_velocity * mass[k];
+                }
+                continue;
+            }
             FaceQuadrature quad(grid_, face, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // u^ext flux B   (B = {b_j})
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * normal_velocity * basis_[j];
+                        ws.jac[j*num_basis + i] += w * ws.basis[i] * normal_velocity * ws.basis[j];
                     }
                 }
             }
@@ -504,11 +585,11 @@ namespace Opm
 
 
 
-    // This function assumes that jac_ and rhs_ contain the
-    // linear system to be solved. They are stored in orig_jac_
-    // and orig_rhs_, then the system is solved via LAPACK,
-    // overwriting the input data (jac_ and rhs_).
-    void TofDiscGalReorder::solveLinearSystem(const int cell)
+    // This function assumes that ws.jac and ws.rhs contain the
+    // linear system to be solved. They are stored in ws.orig_jac
+    // and ws.orig_rhs, then the system is solved via LAPACK,
+    // overwriting the input data (ws.jac and ws.rhs).
+    void TofDiscGalReorder::solveLinearSystem(const int cell, Workspace& ws)
     {
         MAT_SIZE_T n = basis_func_->numBasisFunc();
         int num_tracer_to_compute = num_tracers_;
@@ -522,22 +603,22 @@ namespace Opm
         std::vector<MAT_SIZE_T> piv(n);
         MAT_SIZE_T ldb = n;
         MAT_SIZE_T info = 0;
-        orig_jac_ = jac_;
-        orig_rhs_ = rhs_;
-        dgesv_(&n, &nrhs, &jac_[0], &lda, &piv[0], &rhs_[0], &ldb, &info);
+        ws.orig_jac = ws.jac;
+        ws.orig_rhs = ws.rhs;
+        dgesv_(&n, &nrhs, &ws.jac[0], &lda, &piv[0], &ws.rhs[0], &ldb, &info);
         if (info != 0) {
             // Print the local matrix and rhs.
             std::cerr << "Failed solving single-cell system Ax = b in cell " << cell
                       << " with A = \n";
             for (int row = 0; row < n; ++row) {
                 for (int col = 0; col < n; ++col) {
-                    std::cerr << "    " << orig_jac_[row + n*col];
+                    std::cerr << "    " << ws.orig_jac[row + n*col];
                 }
                 std::cerr << '\n';
             }
             std::cerr << "and b = \n";
             for (int row = 0; row < n; ++row) {
-                std::cerr << "    " << orig_rhs_[row] << '\n';
+                std::cerr << "    " << ws.orig_rhs[row] << '\n';
             }
             OPM_THROW(std::runtime_error, "Lapack error: " << info << " encountered in cell " << cell);
         }
@@ -548,8 +629,6 @@ namespace Opm
 
     void TofDiscGalReorder::solveMultiCell(const int num_cells, const int* cells)
     {
-        ++num_multicell_;
-        max_size_multicell_ = std::max(max_size_multicell_, num_cells);
         // std::cout << "Multiblock solve with " << num_cells << " cells." << std::endl;
 
         // Using a Gauss-Seidel approach.
@@ -568,7 +647,150 @@ namespace Opm
             }
             // std::cout << "Max delta = " << max_delta << std::endl;
         }
-        max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
+        // Statistics are shared between threads when solving
+        // components in parallel.
+#pragma omp critical(TofDiscGalReorder_stats)
+        {
+            ++num_multicell_;
+            max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+            max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
+        }
+    }
+
+
+
+
+    // Allocate one single-cell workspace per thread.
+    // \param[in] num_rhs   Number of right-hand sides (tof and tracers).
+    void TofDiscGalReorder::setupWorkspace(const int num_rhs)
+    {
+        const int num_basis = basis_func_->numBasisFunc();
+        const int dim = grid_.dimensions;
+#ifdef _OPENMP
+        const int num_threads = parallelComponents() ? omp_get_max_threads() : 1;
+#else
+        const int num_threads = 1;
+#endif
+        workspace_.resize(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            Workspace& ws = workspace_[t];
+            ws.rhs.resize(num_basis*num_rhs);
+            ws.jac.resize(num_basis*num_basis);
+            ws.orig_jac.resize(num_basis*num_basis);
+            ws.coord.resize(dim);
+            ws.basis.resize(num_basis);
+            ws.basis_nb.resize(num_basis);
+            ws.grad_basis.resize(num_basis*dim);
+            ws.velocity.resize(dim);
+        }
+    }
+
+
+
+
+    // Return the workspace belonging to the calling thread.
+    TofDiscGalReorder::Workspace& TofDiscGalReorder::workspace() const
+    {
+#ifdef _OPENMP
+        if (workspace_.size() > 1) {
+            return workspace_[omp_get_thread_num()];
+        }
+#endif
+        return workspace_[0];
+    }
+
+
+
+
+    // Evaluate all quadrature rules used in cellContribs() and
+    // faceContribs() once, and store the integrals that do not depend
+    // on the fluxes. The quadrature degrees must match those used there.
+    void TofDiscGalReorder::precomputeQuadrature()
+    {
+        const int num_cells = grid_.number_of_cells;
+        const int num_basis = basis_func_->numBasisFunc();
+        const int nb2 = num_basis*num_basis;
+        const int dim = grid_.dimensions;
+        const int degree = basis_func_->degree();
+
+        std::unique_ptr<QuadratureCache> qc(new QuadratureCache);
+        qc->cell_basis_integral.assign(num_basis*num_cells, 0.0);
+        qc->cell_mass.assign(nb2*num_cells, 0.0);
+        qc->cell_quadpos.assign(1, 0);
+        const int num_hfaces = grid_.cell_facepos[num_cells];
+        qc->hface_mass.assign(nb2*num_hfaces, 0.0);
+        qc->hface_coupling.assign(nb2*num_hfaces, 0.0);
+
+        std::vector<double> coord(dim);
+        std::vector<double> basis(num_basis);
+        std::vector<double> basis_nb(num_basis);
+        std::vector<double> grad_basis(num_basis*dim);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            // \int_K b_j, as for the porosity term.
+            {
+                CellQuadrature quad(grid_, cell, degree);
+                double* bint = &qc->cell_basis_integral[num_basis*cell];
+                for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                    quad.quadPtCoord(quad_pt, &coord[0]);
+                    basis_func_->eval(cell, &coord[0], &basis[0]);
+                    const double w = quad.quadPtWeight(quad_pt);
+                    for (int j = 0; j < num_basis; ++j) {
+                        bint[j] += w * basis[j];
+                    }
+                }
+            }
+
+            // Points for the velocity term, and \int_K b_i b_j for sinks.
+            {
+                CellQuadrature quad(grid_, cell, 2*degree);
+                double* mass = &qc->cell_mass[nb2*cell];
+                for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                    quad.quadPtCoord(quad_pt, &coord[0]);
+                    basis_func_->eval(cell, &coord[0], &basis[0]);
+                    basis_func_->evalGrad(cell, &coord[0], &grad_basis[0]);
+                    const double w = quad.quadPtWeight(quad_pt);
+                    qc->quad_weight.push_back(w);
+                    qc->quad_coord.insert(qc->quad_coord.end(), coord.begin(), coord.end());
+                    qc->quad_basis.insert(qc->quad_basis.end(), basis.begin(), basis.end());
+                    qc->quad_grad_basis.insert(qc->quad_grad_basis.end(), grad_basis.begin(), grad_basis.end());
+                    for (int j = 0; j < num_basis; ++j) {
+                        for (int i = 0; i < num_basis; ++i) {
+                            mass[j*num_basis + i] += w * basis[i] * basis[j];
+                        }
+                    }
+                }
+                qc->cell_quadpos.push_back(qc->quad_weight.size());
+            }
+
+            // Face integrals \int_F b_i b_j and \int_F b_j b^{nb}_i.
+            for (int hface = grid_.cell_facepos[cell]; hface < grid_.cell_facepos[cell+1]; ++hface) {
+                const int face = grid_.cell_faces[hface];
+                const int neighbour = (cell == grid_.face_cells[2*face])
+                    ? grid_.face_cells[2*face + 1] : grid_.face_cells[2*face];
+                double* mass = &qc->hface_mass[nb2*hface];
+                double* coupling = &qc->hface_coupling[nb2*hface];
+                FaceQuadrature quad(grid_, face, 2*degree);
+                for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                    quad.quadPtCoord(quad_pt, &coord[0]);
+                    basis_func_->eval(cell, &coord[0], &basis[0]);
+                    const double w = quad.quadPtWeight(quad_pt);
+                    for (int j = 0; j < num_basis; ++j) {
+                        for (int i = 0; i < num_basis; ++i) {
+                            mass[j*num_basis + i] += w * basis[i] * basis[j];
+                        }
+                    }
+                    if (neighbour >= 0) {
+                        basis_func_->eval(neighbour, &coord[0], &basis_nb[0]);
+                        for (int j = 0; j < num_basis; ++j) {
+                            for (int i = 0; i < num_basis; ++i) {
+                                coupling[j*num_basis + i] += w * basis[j] * basis_nb[i];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        quad_cache_ = std::move(qc);
     }
 
 
@@ -747,11 +969,12 @@ namespace Opm
         // Evaluate the solution in all corners.
         const int dim = grid_.dimensions;
         const int num_basis = basis_func_->numBasisFunc();
+        Workspace& ws = workspace();
         double min_cornerval = 1e100;
         for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
             const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-            basis_func_->eval(cell, nc, &basis_[0]);
-            const double tof_corner = std::inner_product(basis_.begin(), basis_.end(),
+            basis_func_->eval(cell, nc, &ws.basis[0]);
+            const double tof_corner = std::inner_product(ws.basis.begin(), ws.basis.end(),
                                                          tof_coeff_ + num_basis*cell, 0.0);
             min_cornerval = std::min(min_cornerval, tof_corner);
         }
@@ -765,14 +988,15 @@ namespace Opm
         // Evaluate the solution in all corners of all faces. Extract max and min.
         const int dim = grid_.dimensions;
         const int num_basis = basis_func_->numBasisFunc();
+        Workspace& ws = workspace();
         double min_cornerval = 1e100;
         double max_cornerval = -1e100;
         for (int hface = grid_.cell_facepos[cell]; hface < grid_.cell_facepos[cell+1]; ++hface) {
             const int face = grid_.cell_faces[hface];
             for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
                 const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-                basis_func_->eval(cell, nc, &basis_[0]);
-                const double tracer_corner = std::inner_product(basis_.begin(), basis_.end(),
+                basis_func_->eval(cell, nc, &ws.basis[0]);
+                const double tracer_corner = std::inner_product(ws.basis.begin(), ws.basis.end(),
                                                                 local_coeff, 0.0);
                 min_cornerval = std::min(min_cornerval, tracer_corner);
                 max_cornerval = std::max(min_cornerval, tracer_corner);
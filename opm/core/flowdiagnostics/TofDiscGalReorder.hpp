@@ -57,6 +57,8 @@ namespace Opm
         ///   - \c use_tensorial_basis (false)             -- Use tensor-product basis, interpreting dg_degree as
         ///                                                   bi/tri-degree not total degree.
         ///   - \c use_cvi (false)                         -- Use ECVI velocity interpolation.
+        ///   - \c parallel_components (false)             -- Solve independent components in parallel,
+        ///                                                   see ReorderSolverInterface::setParallelComponents().
         ///   - \c use_limiter (false)                     -- Use a slope limiter. If true, the next three parameters are used.
         ///   - \c limiter_relative_flux_threshold (1e-3)  -- Ignore upstream fluxes below this threshold,
         ///                                                   relative to total cell flux.
@@ -71,9 +73,16 @@ namespace Opm
         ///                                             computing (unlimited) solution.
         ///             - AsSimultaneousPostProcess  -- Apply to each cell independently, using un-
         ///                                             limited solution in neighbouring cells.
+        ///   - \c precompute_quadrature (false)           -- Compute and store quadrature points, basis
+        ///                                                   function values and local mass matrices for
+        ///                                                   all cells and faces at construction, so that
+        ///                                                   repeated solves only do flux-dependent work.
         TofDiscGalReorder(const UnstructuredGrid& grid,
                           const parameter::ParameterGroup& param);
 
+        /// Destructor.
+        ~TofDiscGalReorder();
+
 
         /// Solve for time-of-flight.
         /// \param[in]  darcyflux         Array of signed face fluxes.
@@ -118,12 +127,18 @@ namespace Opm
                             std::vector<double>& tracer_coeff);
 
     private:
+        struct Workspace;
+        struct QuadratureCache;
+
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
 
-        void cellContribs(const int cell);
-        void faceContribs(const int cell);
-        void solveLinearSystem(const int cell);
+        void cellContribs(const int cell, Workspace& ws);
+        void faceContribs(const int cell, Workspace& ws);
+        void solveLinearSystem(const int cell, Workspace& ws);
+        void setupWorkspace(const int num_rhs);
+        Workspace& workspace() const;
+        void precomputeQuadrature();
 
     private:
         // Disable copying and assignment.
@@ -151,22 +166,30 @@ namespace Opm
         enum { NoTracerHead = -1 };
         std::vector<int> tracerhead_by_cell_;
         bool tracers_ensure_unity_;
-        // Used by solveSingleCell().
-        std::vector<double> rhs_;   // single-cell right-hand-sides
-        std::vector<double> jac_;   // single-cell jacobian
-        std::vector<double> orig_rhs_;   // single-cell right-hand-sides (copy)
-        std::vector<double> orig_jac_;   // single-cell jacobian (copy)
-        std::vector<double> coord_;
-        mutable std::vector<double> basis_;
-        mutable std::vector<double> basis_nb_;
-        std::vector<double> grad_basis_;
-        std::vector<double> velocity_;
+        // Used by solveSingleCell(). There is one workspace
+        // for each thread, since components may be solved in
+        // parallel (see ReorderSolverInterface).
+        struct Workspace
+        {
+            std::vector<double> rhs;        // single-cell right-hand-sides
+            std::vector<double> jac;        // single-cell jacobian
+            std::vector<double> orig_rhs;   // single-cell right-hand-sides (copy)
+            std::vector<double> orig_jac;   // single-cell jacobian (copy)
+            std::vector<double> coord;
+            std::vector<double> basis;
+            std::vector<double> basis_nb;
+            std::vector<double> grad_basis;
+            std::vector<double> velocity;
+        };
+        mutable std::vector<Workspace> workspace_;
         int num_singlesolves_;
         // Used by solveMultiCell():
         double gauss_seidel_tol_;
         int num_multicell_;
         int max_size_multicell_;
         int max_iter_multicell_;
+        // Static quadrature data, null unless precompute_quadrature is set.
+        std::unique_ptr<QuadratureCache> quad_cache_;
 
         // Private methods
 
@@ -42,6 +42,8 @@ namespace Opm
           porevolume_(0),
           source_(0),
           tof_(0),
+          tracer_(0),
+          num_tracers_(0),
           gauss_seidel_tol_(1e-3),
           use_multidim_upwind_(use_multidim_upwind)
     {
@@ -129,10 +131,6 @@ namespace Opm
             std::fill(face_part_tof_.begin(), face_part_tof_.end(), 0.0);
         }
 
-        // Execute solve for tof
-        compute_tracer_ = false;
-        executeSolve();
-
         // Find the tracer heads (injectors).
         const int num_tracers = tracerheads.size();
         tracer.resize(num_cells*num_tracers);
@@ -145,22 +143,43 @@ namespace Opm
             const unsigned int tracerheadsSize = tracerheads[tr].size();
             for (unsigned int i = 0; i < tracerheadsSize; ++i) {
                 const int cell = tracerheads[tr][i];
-                tracer[num_cells * tr + cell] = 1.0;
+                tracer[num_tracers * cell + tr] = 1.0;
                 tracerhead_by_cell_[cell] = tr;
             }
         }
 
-        // Execute solve for tracers.
+        if (!use_multidim_upwind_) {
+            // Compute tof and all tracers in a single sweep, with
+            // the tracers stored per cell.
+            compute_tracer_ = false;
+            tracer_ = num_tracers > 0 ? tracer.data() : 0;
+            num_tracers_ = num_tracers;
+            executeSolve();
+            tracer_ = 0;
+            num_tracers_ = 0;
+            return;
+        }
+
+        // Execute solve for tof
+        compute_tracer_ = false;
+        executeSolve();
+
+        // Execute solve for tracers, one at a time.
+        std::vector<double> computed(num_cells*num_tracers);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            for (int tr = 0; tr < num_tracers; ++tr) {
+                computed[num_cells * tr + cell] = tracer[num_tracers * cell + tr];
+            }
+        }
         std::vector<double> fake_pv(num_cells, 0.0);
         porevolume_ = fake_pv.data();
         for (int tr = 0; tr < num_tracers; ++tr) {
-            tof_ = tracer.data() + tr * num_cells;
+            tof_ = computed.data() + tr * num_cells;
             compute_tracer_ = true;
             executeSolve();
         }
 
         // Write output tracer data (transposing the computed data).
-        std::vector<double> computed = tracer;
         for (int cell = 0; cell < num_cells; ++cell) {
             for (int tr = 0; tr < num_tracers; ++tr) {
                 tracer[num_tracers * cell + tr] = computed[num_cells * tr + cell];
@@ -198,6 +217,10 @@ namespace Opm
         // to the downwind_flux (note sign change resulting from
         // different sign conventions: pos. source is injection,
         // pos. flux is outflow).
+        if (tracer_) {
+            solveSingleCellTracers(cell);
+            return;
+        }
         if (compute_tracer_ && tracerhead_by_cell_[cell] != NoTracerHead) {
             // This is a tracer head cell, already has solution.
             return;
@@ -236,6 +259,62 @@ namespace Opm
 
 
 
+    void TofReorder::solveSingleCellTracers(const int cell)
+    {
+        // As solveSingleCell(), but also computes all tracers, that
+        // have zero pore volume. Each upwind neighbour contributes
+        // to the tof and to the tracer row of this cell, which is
+        // used as accumulator.
+        const int nt = num_tracers_;
+        const bool is_head = tracerhead_by_cell_[cell] != NoTracerHead;
+        double* tr_cell = tracer_ + nt*cell;
+        if (!is_head) {
+            std::fill(tr_cell, tr_cell + nt, 0.0);
+        }
+        double upwind_term = 0.0;
+        double downwind_flux = std::max(-source_[cell], 0.0);
+        for (int i = grid_.cell_facepos[cell]; i < grid_.cell_facepos[cell+1]; ++i) {
+            int f = grid_.cell_faces[i];
+            double flux;
+            int other;
+            // Compute cell flux
+            if (cell == grid_.face_cells[2*f]) {
+                flux  = darcyflux_[f];
+                other = grid_.face_cells[2*f+1];
+            } else {
+                flux  =-darcyflux_[f];
+                other = grid_.face_cells[2*f];
+            }
+            // Add flux to upwind terms or downwind_flux
+            if (flux < 0.0) {
+                if (other != -1) {
+                    upwind_term += flux*tof_[other];
+                    if (!is_head) {
+                        const double* tr_other = tracer_ + nt*other;
+                        for (int tr = 0; tr < nt; ++tr) {
+                            tr_cell[tr] += flux*tr_other[tr];
+                        }
+                    }
+                }
+            } else {
+                downwind_flux += flux;
+            }
+        }
+
+        // Compute tof and tracers. Tracer head cells keep their
+        // given tracer values.
+        tof_[cell] = (porevolume_[cell] - upwind_term)/downwind_flux;
+        if (!is_head) {
+            const double factor = -1.0/downwind_flux;
+            for (int tr = 0; tr < nt; ++tr) {
+                tr_cell[tr] *= factor;
+            }
+        }
+    }
+
+
+
+
     void TofReorder::solveSingleCellMultidimUpwind(const int cell)
     {
         // Compute flux terms.
@@ -304,25 +383,41 @@ namespace Opm
 
     void TofReorder::solveMultiCell(const int num_cells, const int* cells)
     {
-        ++num_multicell_;
-        max_size_multicell_ = std::max(max_size_multicell_, num_cells);
         // std::cout << "Multiblock solve with " << num_cells << " cells." << std::endl;
 
         // Using a Gauss-Seidel approach.
         double max_delta = 1e100;
         int num_iter = 0;
+        std::vector<double> tracer_before(tracer_ ? num_tracers_ : 0);
         while (max_delta > gauss_seidel_tol_) {
             max_delta = 0.0;
             ++num_iter;
             for (int ci = 0; ci < num_cells; ++ci) {
                 const int cell = cells[ci];
                 const double tof_before = tof_[cell];
+                if (tracer_) {
+                    const double* tr_cell = tracer_ + num_tracers_*cell;
+                    std::copy(tr_cell, tr_cell + num_tracers_, tracer_before.begin());
+                }
                 solveSingleCell(cell);
                 max_delta = std::max(max_delta, std::fabs(tof_[cell] - tof_before));
+                if (tracer_) {
+                    const double* tr_cell = tracer_ + num_tracers_*cell;
+                    for (int tr = 0; tr < num_tracers_; ++tr) {
+                        max_delta = std::max(max_delta, std::fabs(tr_cell[tr] - tracer_before[tr]));
+                    }
+                }
             }
             // std::cout << "Max delta = " << max_delta << std::endl;
         }
-        max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
+        // Statistics are shared between threads when solving
+        // components in parallel.
+#pragma omp critical(TofReorder_stats)
+        {
+            ++num_multicell_;
+            max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+            max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
+        }
     }
 
 
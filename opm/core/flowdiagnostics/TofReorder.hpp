@@ -72,6 +72,8 @@ namespace Opm
         /// \param[out] tof               Array of time-of-flight values (1 per cell).
         /// \param[out] tracer            Array of tracer values. N per cell, where N is
         ///                               equalt to tracerheads.size().
+        /// Unless multidimensional upwinding is used, the tof and all
+        /// tracers are computed in a single ordered sweep.
         void solveTofTracer(const double* darcyflux,
                             const double* porevolume,
                             const double* source,
@@ -82,6 +84,7 @@ namespace Opm
     private:
         void executeSolve();
         virtual void solveSingleCell(const int cell);
+        void solveSingleCellTracers(const int cell);
         void solveSingleCellMultidimUpwind(const int cell);
         void assembleSingleCell(const int cell,
                                 std::vector<int>& local_column,
@@ -100,6 +103,8 @@ namespace Opm
         const double* porevolume_;  // one volume per cell
         const double* source_;      // one volumetric source term per cell
         double* tof_;
+        double* tracer_;            // num_tracers_ per cell, null unless solving for tof and tracers together
+        int num_tracers_;
         bool compute_tracer_;
         enum { NoTracerHead = -1 };
         std::vector<int> tracerhead_by_cell_;
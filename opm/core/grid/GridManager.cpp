@@ -23,6 +23,7 @@
 #include <opm/core/grid.h>
 #include <opm/core/grid/cart_grid.h>
 #include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/core/grid/grid_binary.h>
 #include <opm/core/grid/MinpvProcessor.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/parser/eclipse/Deck/DeckItem.hpp>
@@ -32,21 +33,61 @@
 
 #include <array>
 #include <algorithm>
+#include <cstring>
+#include <iomanip>
 #include <numeric>
+#include <sstream>
 
 namespace Opm
 {
 
+    namespace {
+        /// 64-bit FNV-1a hash over the raw bytes of the grid input,
+        /// consumed a word at a time.  Used as cache key only.
+        class GridInputHash
+        {
+        public:
+            GridInputHash() : h_(14695981039346656037ULL) {}
+
+            template <typename T>
+            void add(const T* data, std::size_t n)
+            {
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+                std::size_t nbytes = n * sizeof(T);
+                mix(nbytes);
+                for (; nbytes >= sizeof(uint64_t); nbytes -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+                    uint64_t w;
+                    std::memcpy(&w, p, sizeof w);
+                    mix(w);
+                }
+                uint64_t tail = 0;
+                std::memcpy(&tail, p, nbytes);
+                mix(tail);
+            }
+
+            uint64_t value() const { return h_; }
+
+        private:
+            void mix(uint64_t w)
+            {
+                h_ ^= w;
+                h_ *= 1099511628211ULL;
+            }
+
+            uint64_t h_;
+        };
+    } // anonymous namespace
+
     /// Construct a 3d corner-point grid from a deck.
     GridManager::GridManager(Opm::EclipseGridConstPtr eclipseGrid)
-        : ug_(0)
+        : ug_(0), mapped_(false)
     {
         initFromEclipseGrid(eclipseGrid, std::vector<double>());
     }
 
 
     GridManager::GridManager(Opm::DeckConstPtr deck)
-        : ug_(0)
+        : ug_(0), mapped_(false)
     {
         auto eclipseGrid = std::make_shared<const Opm::EclipseGrid>(deck);
         initFromEclipseGrid(eclipseGrid, std::vector<double>());
@@ -55,14 +96,24 @@ namespace Opm
 
     GridManager::GridManager(Opm::EclipseGridConstPtr eclipseGrid,
                              const std::vector<double>& poreVolumes)
-        : ug_(0)
+        : ug_(0), mapped_(false)
     {
         initFromEclipseGrid(eclipseGrid, poreVolumes);
     }
 
 
+    GridManager::GridManager(Opm::EclipseGridConstPtr eclipseGrid,
+                             const std::vector<double>& poreVolumes,
+                             const std::string& cacheDir)
+        : ug_(0), mapped_(false)
+    {
+        initFromEclipseGrid(eclipseGrid, poreVolumes, cacheDir);
+    }
+
+
     /// Construct a 2d cartesian grid with cells of unit size.
     GridManager::GridManager(int nx, int ny)
+        : ug_(0), mapped_(false)
     {
         ug_ = create_grid_cart2d(nx, ny, 1.0, 1.0);
         if (!ug_) {
@@ -71,6 +122,7 @@ namespace Opm
     }
 
     GridManager::GridManager(int nx, int ny,double dx, double dy)
+        : ug_(0), mapped_(false)
     {
         ug_ = create_grid_cart2d(nx, ny, dx, dy);
         if (!ug_) {
@@ -81,6 +133,7 @@ namespace Opm
 
     /// Construct a 3d cartesian grid with cells of unit size.
     GridManager::GridManager(int nx, int ny, int nz)
+        : ug_(0), mapped_(false)
     {
         ug_ = create_grid_cart3d(nx, ny, nz);
         if (!ug_) {
@@ -94,6 +147,7 @@ namespace Opm
     /// Construct a 3d cartesian grid with cells of size [dx, dy, dz].
     GridManager::GridManager(int nx, int ny, int nz,
                              double dx, double dy, double dz)
+        : ug_(0), mapped_(false)
     {
         ug_ = create_grid_hexa3d(nx, ny, nz, dx, dy, dz);
         if (!ug_) {
@@ -105,10 +159,17 @@ namespace Opm
 
 
     /// Construct a grid from an input file.
-    /// The file format used is currently undocumented,
+    /// The file is either in the binary format of grid_binary.h,
+    /// or in a text format which is currently undocumented,
     /// and is therefore only suited for internal use.
     GridManager::GridManager(const std::string& input_filename)
+        : ug_(0), mapped_(false)
     {
+        ug_ = map_grid_binary(input_filename.c_str(), NULL);
+        if (ug_) {
+            mapped_ = true;
+            return;
+        }
         ug_ = read_grid(input_filename.c_str());
         if (!ug_) {
             OPM_THROW(std::runtime_error, "Failed to read grid from file " << input_filename);
@@ -118,7 +179,11 @@ namespace Opm
     /// Destructor.
     GridManager::~GridManager()
     {
-        destroy_grid(ug_);
+        if (mapped_) {
+            unmap_grid_binary(ug_);
+        } else {
+            destroy_grid(ug_);
+        }
     }
 
 
@@ -137,7 +202,8 @@ namespace Opm
 
     // Construct corner-point grid from EclipseGrid.
     void GridManager::initFromEclipseGrid(Opm::EclipseGridConstPtr eclipseGrid,
-                                          const std::vector<double>& poreVolumes)
+                                          const std::vector<double>& poreVolumes,
+                                          const std::string& cacheDir)
     {
         struct grdecl g;
         std::vector<int> actnum;
@@ -170,10 +236,44 @@ namespace Opm
 
         const double z_tolerance = eclipseGrid->isPinchActive() ?
             eclipseGrid->getPinchThresholdThickness() : 0.0;
+
+        // Look for a processed grid from identical input.
+        std::string cacheFile;
+        uint64_t key = 0;
+        if (!cacheDir.empty()) {
+            GridInputHash hash;
+            const int version = GRID_BINARY_VERSION;
+            hash.add(&version, 1);
+            hash.add(g.dims, 3);
+            hash.add(coord.data(), coord.size());
+            hash.add(zcorn.data(), zcorn.size());
+            hash.add(actnum.data(), actnum.size());
+            hash.add(&z_tolerance, 1);
+            key = hash.value();
+
+            std::ostringstream name;
+            name << cacheDir << "/grid-" << std::hex << std::setw(16)
+                 << std::setfill('0') << key << ".ugb";
+            cacheFile = name.str();
+
+            uint64_t storedKey = 0;
+            ug_ = map_grid_binary(cacheFile.c_str(), &storedKey);
+            if (ug_ && storedKey == key) {
+                mapped_ = true;
+                return;
+            }
+            unmap_grid_binary(ug_);
+            ug_ = 0;
+        }
+
         ug_ = create_grid_cornerpoint(&g, z_tolerance);
         if (!ug_) {
             OPM_THROW(std::runtime_error, "Failed to construct grid.");
         }
+
+        if (!cacheFile.empty() && !write_grid_binary(ug_, key, cacheFile.c_str())) {
+            OPM_MESSAGE("Could not write grid cache file " << cacheFile);
+        }
     }
 
 
@@ -24,6 +24,7 @@
 #include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
 
 #include <string>
+#include <vector>
 
 struct UnstructuredGrid;
 struct grdecl;
@@ -55,6 +56,20 @@ namespace Opm
         GridManager(Opm::EclipseGridConstPtr eclipseGrid,
                     const std::vector<double>& poreVolumes);
 
+        /// Construct a grid from an EclipseState::EclipseGrid instance,
+        /// as above, caching the processed corner-point grid.
+        /// The cache holds one binary grid file (see grid_binary.h) per
+        /// distinct grid input, keyed by a hash of the dimensions, COORD,
+        /// ZCORN (after MINPV processing), ACTNUM and pinch tolerance.
+        /// On a hit the grid is mapped from file instead of processed.
+        /// \input[in] eclipseGrid    encapsulates a corner-point grid given from a deck
+        /// \input[in] poreVolumes    one element per logical cartesian grid element,
+        ///                           may be empty
+        /// \input[in] cacheDir       existing directory holding the cache files
+        GridManager(Opm::EclipseGridConstPtr eclipseGrid,
+                    const std::vector<double>& poreVolumes,
+                    const std::string& cacheDir);
+
         /// Construct a 2d cartesian grid with cells of unit size.
         GridManager(int nx, int ny);
 
@@ -69,7 +84,8 @@ namespace Opm
                     double dx, double dy, double dz);
 
         /// Construct a grid from an input file.
-        /// The file format used is currently undocumented,
+        /// The file is either in the binary format of grid_binary.h,
+        /// or in a text format which is currently undocumented,
         /// and is therefore only suited for internal use.
         explicit GridManager(const std::string& input_filename);
 
@@ -89,11 +105,17 @@ namespace Opm
         GridManager& operator=(const GridManager& other);
 
         // Construct corner-point grid from EclipseGrid.
+        // If cacheDir is non-empty, first look for the grid there and
+        // store it there when it had to be constructed.
         void initFromEclipseGrid(Opm::EclipseGridConstPtr eclipseGrid,
-                                 const std::vector<double>& poreVolumes);
+                                 const std::vector<double>& poreVolumes,
+                                 const std::string& cacheDir = std::string());
 
         // The managed UnstructuredGrid.
         UnstructuredGrid* ug_;
+
+        // Whether ug_ is mapped from a binary grid file.
+        bool mapped_;
     };
 
 } // namespace Opm
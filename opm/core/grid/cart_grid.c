@@ -360,107 +360,126 @@ fill_cart_geometry_3d(struct UnstructuredGrid *G,
                       const double            *y,
                       const double            *z)
 {
-    int nx, ny, nz;
-    int i,j,k;
-
-    double dx, dy, dz;
-
-    double *coord, *ccentroids, *cvolumes;
-    double *fnormals, *fcentroids, *fareas;
+    int    nx, ny, nz;
+    int    r;
+    size_t nxf, nyf;
 
     nx  = G->cartdims[0];
     ny  = G->cartdims[1];
     nz  = G->cartdims[2];
 
-    ccentroids = G->cell_centroids;
-    cvolumes   = G->cell_volumes;
-    for (k=0; k<nz; ++k)  {
-        for (j=0; j<ny; ++j) {
-            for (i=0; i<nx; ++i) {
-                *ccentroids++ = (x[i] + x[i + 1]) / 2.0;
-                *ccentroids++ = (y[j] + y[j + 1]) / 2.0;
-                *ccentroids++ = (z[k] + z[k + 1]) / 2.0;
+    nxf = ((size_t) (nx + 1)) * ny * nz;
+    nyf = ((size_t) nx) * (ny + 1) * nz;
 
-                dx = x[i + 1] - x[i];
-                dy = y[j + 1] - y[j];
-                dz = z[k + 1] - z[k];
+    /* Every row of cells, faces and nodes is filled independently.
+     * The rows are indexed by r = j + n*k, with n the number of rows
+     * in the j direction. */
 
-                *cvolumes++ = dx * dy * dz;
-            }
-        }
-    }
+#pragma omp parallel for schedule(static)
+    for (r = 0; r < ny*nz; ++r) {
+        int     i, j = r % ny, k = r / ny;
+        double  dx, dy, dz;
+        double *ccentroids = G->cell_centroids + 3*((size_t) nx)*r;
+        double *cvolumes   = G->cell_volumes   + 1*((size_t) nx)*r;
 
+        for (i=0; i<nx; ++i) {
+            *ccentroids++ = (x[i] + x[i + 1]) / 2.0;
+            *ccentroids++ = (y[j] + y[j + 1]) / 2.0;
+            *ccentroids++ = (z[k] + z[k + 1]) / 2.0;
 
-    fnormals   = G->face_normals;
-    fcentroids = G->face_centroids;
-    fareas     = G->face_areas;
+            dx = x[i + 1] - x[i];
+            dy = y[j + 1] - y[j];
+            dz = z[k + 1] - z[k];
+
+            *cvolumes++ = dx * dy * dz;
+        }
+    }
 
     /* Faces with x-normal */
-    for (k=0; k<nz; ++k) {
-        for (j=0; j<ny; ++j) {
-            for (i=0; i<nx+1; ++i) {
-                dy = y[j + 1] - y[j];
-                dz = z[k + 1] - z[k];
+#pragma omp parallel for schedule(static)
+    for (r = 0; r < ny*nz; ++r) {
+        int     i, j = r % ny, k = r / ny;
+        double  dy, dz;
+        size_t  f0         = ((size_t) (nx + 1))*r;
+        double *fnormals   = G->face_normals   + 3*f0;
+        double *fcentroids = G->face_centroids + 3*f0;
+        double *fareas     = G->face_areas     + 1*f0;
 
-                *fnormals++ = dy * dz;
-                *fnormals++ = 0;
-                *fnormals++ = 0;
+        for (i=0; i<nx+1; ++i) {
+            dy = y[j + 1] - y[j];
+            dz = z[k + 1] - z[k];
 
-                *fcentroids++ = x[i];
-                *fcentroids++ = (y[j] + y[j + 1]) / 2.0;
-                *fcentroids++ = (z[k] + z[k + 1]) / 2.0;
+            *fnormals++ = dy * dz;
+            *fnormals++ = 0;
+            *fnormals++ = 0;
 
-                *fareas++ = dy * dz;
-            }
+            *fcentroids++ = x[i];
+            *fcentroids++ = (y[j] + y[j + 1]) / 2.0;
+            *fcentroids++ = (z[k] + z[k + 1]) / 2.0;
+
+            *fareas++ = dy * dz;
         }
     }
     /* Faces with y-normal */
-    for (k=0; k<nz; ++k) {
-        for (j=0; j<ny+1; ++j) {
-            for (i=0; i<nx; ++i) {
-                dx = x[i + 1] - x[i];
-                dz = z[k + 1] - z[k];
+#pragma omp parallel for schedule(static)
+    for (r = 0; r < (ny+1)*nz; ++r) {
+        int     i, j = r % (ny+1), k = r / (ny+1);
+        double  dx, dz;
+        size_t  f0         = nxf + ((size_t) nx)*r;
+        double *fnormals   = G->face_normals   + 3*f0;
+        double *fcentroids = G->face_centroids + 3*f0;
+        double *fareas     = G->face_areas     + 1*f0;
 
-                *fnormals++ = 0;
-                *fnormals++ = dx * dz;
-                *fnormals++ = 0;
+        for (i=0; i<nx; ++i) {
+            dx = x[i + 1] - x[i];
+            dz = z[k + 1] - z[k];
 
-                *fcentroids++ = (x[i] + x[i + 1]) / 2.0;
-                *fcentroids++ = y[j];
-                *fcentroids++ = (z[k] + z[k + 1]) / 2.0;
+            *fnormals++ = 0;
+            *fnormals++ = dx * dz;
+            *fnormals++ = 0;
 
-                *fareas++ = dx * dz;
-            }
+            *fcentroids++ = (x[i] + x[i + 1]) / 2.0;
+            *fcentroids++ = y[j];
+            *fcentroids++ = (z[k] + z[k + 1]) / 2.0;
+
+            *fareas++ = dx * dz;
         }
     }
     /* Faces with z-normal */
-    for (k=0; k<nz+1; ++k) {
-        for (j=0; j<ny; ++j) {
-            for (i=0; i<nx; ++i) {
-                dx = x[i + 1] - x[i];
-                dy = y[j + 1] - y[j];
+#pragma omp parallel for schedule(static)
+    for (r = 0; r < ny*(nz+1); ++r) {
+        int     i, j = r % ny, k = r / ny;
+        double  dx, dy;
+        size_t  f0         = nxf + nyf + ((size_t) nx)*r;
+        double *fnormals   = G->face_normals   + 3*f0;
+        double *fcentroids = G->face_centroids + 3*f0;
+        double *fareas     = G->face_areas     + 1*f0;
 
-                *fnormals++ = 0;
-                *fnormals++ = 0;
-                *fnormals++ = dx * dy;
+        for (i=0; i<nx; ++i) {
+            dx = x[i + 1] - x[i];
+            dy = y[j + 1] - y[j];
 
-                *fcentroids++ = (x[i] + x[i + 1]) / 2.0;
-                *fcentroids++ = (y[j] + y[j + 1]) / 2.0;
-                *fcentroids++ = z[k];
+            *fnormals++ = 0;
+            *fnormals++ = 0;
+            *fnormals++ = dx * dy;
 
-                *fareas++ = dx * dy;
-            }
+            *fcentroids++ = (x[i] + x[i + 1]) / 2.0;
+            *fcentroids++ = (y[j] + y[j + 1]) / 2.0;
+            *fcentroids++ = z[k];
+
+            *fareas++ = dx * dy;
         }
     }
 
-    coord = G->node_coordinates;
-    for (k=0; k<nz+1; ++k) {
-        for (j=0; j<ny+1; ++j) {
-            for (i=0; i<nx+1; ++i) {
-                *coord++ = x[i];
-                *coord++ = y[j];
-                *coord++ = z[k];
-            }
+#pragma omp parallel for schedule(static)
+    for (r = 0; r < (ny+1)*(nz+1); ++r) {
+        int     i, j = r % (ny+1), k = r / (ny+1);
+        double *coord = G->node_coordinates + 3*((size_t) (nx + 1))*r;
+
+        for (i=0; i<nx+1; ++i) {
+            *coord++ = x[i];
+            *coord++ = y[j];
+            *coord++ = z[k];
         }
     }
 }
@@ -29,93 +29,167 @@ norm(const double w[3])
 
 /* ------------------------------------------------------------------ */
 static void
-compute_face_geometry_3d(double *coords, int nfaces,
-                         int *nodepos, int *facenodes, double *fnormals,
-                         double *fcentroids, double *fareas)
+face_node_average(const double *coords, const int *nodes, int nnodes,
+                  double x[3])
 /* ------------------------------------------------------------------ */
 {
+   int i, k;
 
-   /* Assume 3D for now */
-   const int ndims = 3;
-   int f;
-   double x[3];
-   double u[3];
-   double v[3];
-   double w[3];
-
-   int i,k;
-   int node;
-
-   double cface[3]  = {0};
-   double n[3]  = {0};
-   double twothirds = 0.666666666666666666666666666667;
-   double a;
-   int    num_face_nodes;
-   double area;
-   /*#pragma omp parallel for  */
+   for (i=0; i<3; ++i) x[i] = 0.0;
 
-   /*#pragma omp parallel for shared(fnormals,fcentroids,fareas)*/
-#pragma omp parallel for default(none) 			   \
-    private(f,x,u,v,w,i,k,node,cface,n,a,num_face_nodes,area)		\
-    shared(fnormals,fcentroids,fareas  \
-	   ,coords, nfaces, nodepos, facenodes, twothirds)
-   for (f=0; f<nfaces; ++f)
+   for (k=0; k<nnodes; ++k)
    {
-      for(i=0; i<ndims; ++i) x[i] = 0.0;
-      for(i=0; i<ndims; ++i) n[i] = 0.0;
-      for(i=0; i<ndims; ++i) cface[i] = 0.0;
+      const double *pt = coords + 3*((size_t) nodes[k]);
+      for (i=0; i<3; ++i) x[i] += pt[i];
+   }
+   for (i=0; i<3; ++i) x[i] /= nnodes;
+}
 
-      /* average node */
-      for(k=nodepos[f]; k<nodepos[f+1]; ++k)
-      {
-         node = facenodes[k];
-         for (i=0; i<ndims; ++i) x[i] += coords[3*node+i];
-      }
-      num_face_nodes = nodepos[f+1] - nodepos[f];
-      for(i=0; i<ndims; ++i) x[i] /= num_face_nodes;
+/* ------------------------------------------------------------------ */
+static void
+single_face_geometry_3d(const double *coords, const int *nodes,
+                        int nnodes, double *fnormal, double *fcentroid,
+                        double *farea)
+/* ------------------------------------------------------------------ */
+{
+   const double twothirds = 0.666666666666666666666666666667;
 
+   int    i, k;
+   double x[3], u[3], v[3], w[3];
+   double cface[3] = {0.0, 0.0, 0.0};
+   double n[3]     = {0.0, 0.0, 0.0};
+   double a, area;
+   const double *pt;
 
+   /* average node */
+   face_node_average(coords, nodes, nnodes, x);
 
-      /* compute first vector u (to the last node in the face) */
-      node = facenodes[nodepos[f+1]-1];
-      for(i=0; i<ndims; ++i) u[i] = coords[3*node+i] - x[i];
+   /* compute first vector u (to the last node in the face) */
+   pt = coords + 3*((size_t) nodes[nnodes - 1]);
+   for (i=0; i<3; ++i) u[i] = pt[i] - x[i];
 
-      area=0.0;
-      /* Compute triangular contrib. to face normal and face centroid*/
-      for(k=nodepos[f]; k<nodepos[f+1]; ++k)
-      {
+   area=0.0;
+   /* Compute triangular contrib. to face normal and face centroid*/
+   for (k=0; k<nnodes; ++k)
+   {
+      pt = coords + 3*((size_t) nodes[k]);
+      for (i=0; i<3; ++i) v[i] = pt[i] - x[i];
 
+      cross(u,v,w);
+      a = 0.5*norm(w);
+      area += a;
 
-         node = facenodes[k];
-         for (i=0; i<ndims; ++i) v[i] = coords[3*node+i] - x[i];
+      /* face normal */
+      for (i=0; i<3; ++i) n[i] += w[i];
 
-         cross(u,v,w);
-         a = 0.5*norm(w);
-         area += a;
-	 /*         if(!(a>0))
-         {
-            fprintf(stderr, "Internal error in compute_face_geometry.");
-         }
-	 */
-         /* face normal */
-         for (i=0; i<ndims; ++i) n[i] += w[i];
+      /* face centroid */
+      for (i=0; i<3; ++i)
+         cface[i] += a*(x[i]+twothirds*0.5*(u[i]+v[i]));
 
-         /* face centroid */
-         for (i=0; i<ndims; ++i)
-            cface[i] += a*(x[i]+twothirds*0.5*(u[i]+v[i]));
+      /* Store v in u for next iteration */
+      for (i=0; i<3; ++i) u[i] = v[i];
+   }
 
-         /* Store v in u for next iteration */
-         for (i=0; i<ndims; ++i) u[i] = v[i];
-      }
+   /* Store face normal and face centroid */
+   for (i=0; i<3; ++i)
+   {
+      /* normal is scaled with face area */
+      fnormal  [i] = 0.5*n[i];
+      fcentroid[i] = cface[i]/area;
+   }
+   *farea = area;
+}
+
+/* ------------------------------------------------------------------ */
+/* Vectors from the node average to each node of a quadrilateral face.
+ * The node average is summed in node order, as face_node_average(). */
+/* ------------------------------------------------------------------ */
+static void
+quad_face_vectors(const double *coords, const int nodes[4],
+                  double x[3], double d[4][3])
+/* ------------------------------------------------------------------ */
+{
+   int i, k;
+   const double *p[4];
+
+   for (k=0; k<4; ++k) p[k] = coords + 3*((size_t) nodes[k]);
+
+   for (i=0; i<3; ++i)
+   {
+      x[i] = (0.0 + p[0][i] + p[1][i] + p[2][i] + p[3][i]) / 4;
+   }
+   for (k=0; k<4; ++k)
+   {
+      for (i=0; i<3; ++i) d[k][i] = p[k][i] - x[i];
+   }
+}
+
+/* ------------------------------------------------------------------ */
+/* As single_face_geometry_3d(), for quadrilateral faces.  Same
+ * arithmetic, in the same order, on fixed-size arrays. */
+/* ------------------------------------------------------------------ */
+static void
+quad_face_geometry_3d(const double *coords, const int nodes[4],
+                      double *fnormal, double *fcentroid, double *farea)
+/* ------------------------------------------------------------------ */
+{
+   const double twothirds = 0.666666666666666666666666666667;
 
-      /* Store face normal and face centroid */
-      for (i=0; i<ndims; ++i)
+   int    i, k;
+   double x[3], d[4][3], w[4][3], a[4];
+   double cface[3] = {0.0, 0.0, 0.0};
+   double n[3]     = {0.0, 0.0, 0.0};
+   double area;
+
+   quad_face_vectors(coords, nodes, x, d);
+
+   /* Triangles (x, node k-1, node k), node -1 being node 3. */
+   cross(d[3], d[0], w[0]);
+   cross(d[0], d[1], w[1]);
+   cross(d[1], d[2], w[2]);
+   cross(d[2], d[3], w[3]);
+   for (k=0; k<4; ++k) a[k] = 0.5*norm(w[k]);
+
+   area = 0.0 + a[0] + a[1] + a[2] + a[3];
+   for (i=0; i<3; ++i)
+   {
+      n[i] += w[0][i];  n[i] += w[1][i];  n[i] += w[2][i];  n[i] += w[3][i];
+
+      cface[i] += a[0]*(x[i]+twothirds*0.5*(d[3][i]+d[0][i]));
+      cface[i] += a[1]*(x[i]+twothirds*0.5*(d[0][i]+d[1][i]));
+      cface[i] += a[2]*(x[i]+twothirds*0.5*(d[1][i]+d[2][i]));
+      cface[i] += a[3]*(x[i]+twothirds*0.5*(d[2][i]+d[3][i]));
+
+      fnormal  [i] = 0.5*n[i];
+      fcentroid[i] = cface[i]/area;
+   }
+   *farea = area;
+}
+
+/* ------------------------------------------------------------------ */
+static void
+compute_face_geometry_3d(double *coords, int nfaces,
+                         int *nodepos, int *facenodes, double *fnormals,
+                         double *fcentroids, double *fareas)
+/* ------------------------------------------------------------------ */
+{
+   int f;
+
+   /* Faces are independent. */
+#pragma omp parallel for schedule(static)
+   for (f=0; f<nfaces; ++f)
+   {
+      if (nodepos[f+1] - nodepos[f] == 4)
+      {
+         quad_face_geometry_3d(coords, facenodes + nodepos[f],
+                               fnormals + 3*f, fcentroids + 3*f, fareas + f);
+      }
+      else
       {
-         /* normal is scaled with face area */
-         fnormals  [3*f+i] = 0.5*n[i];
-         fcentroids[3*f+i] = cface[i]/area;
+         single_face_geometry_3d(coords, facenodes + nodepos[f],
+                                 nodepos[f+1] - nodepos[f],
+                                 fnormals + 3*f, fcentroids + 3*f, fareas + f);
       }
-      fareas[f] = area;
    }
 }
 
@@ -210,6 +284,110 @@ compute_face_geometry(int ndims, double *coords, int nfaces,
 }
 
 
+/* ------------------------------------------------------------------ */
+static void
+cell_face_contrib_3d(const double *coords, const int *nodes, int nnodes,
+                     const double *fnormal, int outward,
+                     const double xcell[3], double *volume,
+                     double ccell[3])
+/* ------------------------------------------------------------------ */
+{
+   const double twothirds = 0.666666666666666666666666666667;
+
+   int    i, k;
+   double x[3], u[3], v[3], w[3];
+   double cface[3];
+   double tet_volume, subnormal_sign;
+   const double *pt;
+
+   /* average face node x */
+   face_node_average(coords, nodes, nnodes, x);
+
+   /* compute first vector u (to the last node in the face) */
+   pt = coords + 3*((size_t) nodes[nnodes - 1]);
+   for (i=0; i<3; ++i) u[i] = pt[i] - x[i];
+
+   /* Compute triangular contributions to face normal and face centroid */
+   for (k=0; k<nnodes; ++k)
+   {
+      pt = coords + 3*((size_t) nodes[k]);
+      for (i=0; i<3; ++i) v[i] = pt[i] - x[i];
+
+      cross(u,v,w);
+
+      tet_volume = 0.0;
+      for (i=0; i<3; ++i) tet_volume += w[i]*(x[i]-xcell[i]);
+      tet_volume *= 0.5 / 3;
+
+      subnormal_sign = 0.0;
+      for (i=0; i<3; ++i) subnormal_sign += w[i]*fnormal[i];
+
+      if (subnormal_sign < 0.0) tet_volume = -tet_volume;
+      if (!outward)             tet_volume = -tet_volume;
+
+      *volume += tet_volume;
+
+      /* face centroid of triangle  */
+      for (i=0; i<3; ++i) cface[i] = (x[i]+(twothirds)*0.5*(u[i]+v[i]));
+
+      /* Cell centroid */
+      for (i=0; i<3; ++i) ccell[i] += tet_volume * 3/4.0*(cface[i] - xcell[i]);
+
+      /* Store v in u for next iteration */
+      for (i=0; i<3; ++i) u[i] = v[i];
+   }
+}
+
+/* ------------------------------------------------------------------ */
+/* As cell_face_contrib_3d(), for quadrilateral faces. */
+/* ------------------------------------------------------------------ */
+static void
+quad_cell_face_contrib_3d(const double *coords, const int nodes[4],
+                          const double *fnormal, int outward,
+                          const double xcell[3], double *volume,
+                          double ccell[3])
+/* ------------------------------------------------------------------ */
+{
+   const double twothirds = 0.666666666666666666666666666667;
+
+   int    i, k;
+   double x[3], d[4][3], w[4][3];
+   double tet_volume[4], subnormal_sign[4];
+
+   quad_face_vectors(coords, nodes, x, d);
+
+   cross(d[3], d[0], w[0]);
+   cross(d[0], d[1], w[1]);
+   cross(d[1], d[2], w[2]);
+   cross(d[2], d[3], w[3]);
+
+   for (k=0; k<4; ++k)
+   {
+      tet_volume[k] = 0.0;
+      for (i=0; i<3; ++i) tet_volume[k] += w[k][i]*(x[i]-xcell[i]);
+      tet_volume[k] *= 0.5 / 3;
+
+      subnormal_sign[k] = 0.0;
+      for (i=0; i<3; ++i) subnormal_sign[k] += w[k][i]*fnormal[i];
+
+      if (subnormal_sign[k] < 0.0) tet_volume[k] = -tet_volume[k];
+      if (!outward)                tet_volume[k] = -tet_volume[k];
+   }
+
+   *volume += tet_volume[0];
+   *volume += tet_volume[1];
+   *volume += tet_volume[2];
+   *volume += tet_volume[3];
+
+   for (i=0; i<3; ++i)
+   {
+      ccell[i] += tet_volume[0] * 3/4.0*((x[i]+(twothirds)*0.5*(d[3][i]+d[0][i])) - xcell[i]);
+      ccell[i] += tet_volume[1] * 3/4.0*((x[i]+(twothirds)*0.5*(d[0][i]+d[1][i])) - xcell[i]);
+      ccell[i] += tet_volume[2] * 3/4.0*((x[i]+(twothirds)*0.5*(d[1][i]+d[2][i])) - xcell[i]);
+      ccell[i] += tet_volume[3] * 3/4.0*((x[i]+(twothirds)*0.5*(d[2][i]+d[3][i])) - xcell[i]);
+   }
+}
+
 /* ------------------------------------------------------------------ */
 static void
 compute_cell_geometry_3d(double *coords,
@@ -220,119 +398,52 @@ compute_cell_geometry_3d(double *coords,
                          double *ccentroids, double *cvolumes)
 /* ------------------------------------------------------------------ */
 {
-   const int ndims = 3;
-   int i,k, f,c;
-   int face,node;
-   double x[3];
-   double u[3];
-   double v[3];
-   double w[3];
-   double xcell[3];
-   double ccell[3];
-   double cface[3]  = {0};
-   int num_faces;
-   double volume;
-   double tet_volume, subnormal_sign;
-   double twothirds = 0.666666666666666666666666666667;
-#pragma omp parallel for default(none)     \
-    private(i,k,f,c,face,node,x,u,v,w,xcell				\
-	    ,ccell ,cface,num_faces,volume, tet_volume, subnormal_sign) \
-   shared(coords,nodepos,facenodes,neighbors,twothirds,		\
-	  fnormals,fcentroids,facepos,cellfaces,ccentroids,cvolumes) \
-    firstprivate(ncells)
+   int c;
+
+   /* Cells are independent. */
+#pragma omp parallel for schedule(static)
    for (c=0; c<ncells; ++c)
    {
-
-
-      for(i=0; i<ndims; ++i) xcell[i] = 0.0;
-      for(i=0; i<ndims; ++i) ccell[i] = 0.0;
-
+      int    i, f, face;
+      double xcell[3] = {0.0, 0.0, 0.0};
+      double ccell[3] = {0.0, 0.0, 0.0};
+      double volume;
 
       /*
        * Approximate cell center as average of face centroids
        */
-      for(f=facepos[c]; f<facepos[c+1]; ++f)
+      for (f=facepos[c]; f<facepos[c+1]; ++f)
       {
          face = cellfaces[f];
-         for (i=0; i<ndims; ++i) xcell[i] += fcentroids[3*face+i];
+         for (i=0; i<3; ++i) xcell[i] += fcentroids[3*face+i];
       }
-      num_faces = facepos[c+1] - facepos[c];
-
-      for(i=0; i<ndims; ++i) xcell[i] /= num_faces;
-
-
+      for (i=0; i<3; ++i) xcell[i] /= facepos[c+1] - facepos[c];
 
       /*
        * For all faces, add tetrahedron's volume and centroid to
        * 'cvolume' and 'ccentroid'.
        */
       volume=0.0;
-      for(f=facepos[c]; f<facepos[c+1]; ++f)
+      for (f=facepos[c]; f<facepos[c+1]; ++f)
       {
-         int num_face_nodes;
-
-         for(i=0; i<ndims; ++i) x[i] = 0.0;
-         for(i=0; i<ndims; ++i) cface[i] = 0.0;
-
          face = cellfaces[f];
-
-         /* average face node x */
-         for(k=nodepos[face]; k<nodepos[face+1]; ++k)
+         if (nodepos[face+1] - nodepos[face] == 4)
          {
-            node = facenodes[k];
-            for (i=0; i<ndims; ++i) x[i] += coords[3*node+i];
+            quad_cell_face_contrib_3d(coords, facenodes + nodepos[face],
+                                      fnormals + 3*face,
+                                      neighbors[2*face+0] == c,
+                                      xcell, &volume, ccell);
          }
-         num_face_nodes = nodepos[face+1] - nodepos[face];
-         for(i=0; i<ndims; ++i) x[i] /= num_face_nodes;
-
-
-
-         /* compute first vector u (to the last node in the face) */
-         node = facenodes[nodepos[face+1]-1];
-         for(i=0; i<ndims; ++i) u[i] = coords[3*node+i] - x[i];
-
-
-         /* Compute triangular contributions to face normal and face centroid */
-         for(k=nodepos[face]; k<nodepos[face+1]; ++k)
+         else
          {
-
-            node = facenodes[k];
-            for (i=0; i<ndims; ++i) v[i] = coords[3*node+i] - x[i];
-
-            cross(u,v,w);
-
-
-
-            tet_volume = 0.0;
-            for(i=0; i<ndims; ++i){
-		tet_volume += w[i]*(x[i]-xcell[i]);
-	    }
-            tet_volume *= 0.5 / 3;
-
-	    subnormal_sign=0.0;
-	    for(i=0; i<ndims; ++i){
-		subnormal_sign += w[i]*fnormals[3*face+i];
-	    }
-
-	    if(subnormal_sign < 0.0){
-		tet_volume = -tet_volume;
-	    }
-	    if(!(neighbors[2*face+0]==c)){
-		tet_volume = -tet_volume;
-	    }
-	    volume += tet_volume;
-            /* face centroid of triangle  */
-            for (i=0; i<ndims; ++i) cface[i] = (x[i]+(twothirds)*0.5*(u[i]+v[i]));
-
-            /* Cell centroid */
-            for (i=0; i<ndims; ++i) ccell[i] += tet_volume * 3/4.0*(cface[i] - xcell[i]);
-
-
-            /* Store v in u for next iteration */
-            for (i=0; i<ndims; ++i) u[i] = v[i];
+            cell_face_contrib_3d(coords, facenodes + nodepos[face],
+                                 nodepos[face+1] - nodepos[face],
+                                 fnormals + 3*face,
+                                 neighbors[2*face+0] == c,
+                                 xcell, &volume, ccell);
          }
       }
-      for (i=0; i<ndims; ++i) ccentroids[3*c+i] = xcell[i] + ccell[i]/volume;
+      for (i=0; i<3; ++i) ccentroids[3*c+i] = xcell[i] + ccell[i]/volume;
       cvolumes[c] = volume;
    }
 }
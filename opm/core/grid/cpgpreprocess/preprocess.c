@@ -35,11 +35,16 @@
 #include "config.h"
 #include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "preprocess.h"
 #include "uniquepoints.h"
 #include "facetopology.h"
@@ -54,16 +59,25 @@ compute_cell_index(const int dims[3], int i, int j, int *neighbors, int len);
 static int
 checkmemory(int nz, struct processed_grid *out, int **intersections);
 
-static void
-process_vertical_faces(int direction,
-                       int **intersections,
-                       int *plist, int *work,
-                       struct processed_grid *out);
+static int
+max_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
 
-static void
-process_horizontal_faces(int **intersections,
-                         int *plist,
-                         struct processed_grid *out);
+static int
+thread_num(void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
 
 static int
 linearindex(const int dims[3], int i, int j, int k)
@@ -76,7 +90,7 @@ linearindex(const int dims[3], int i, int j, int k)
     assert (j < dims[1]);
     assert (k < dims[2]);
 
-    return i + dims[0]*(j + dims[1]*k);
+    return (int) (i + ((size_t) dims[0])*(j + ((size_t) dims[1])*k));
 }
 
 
@@ -88,10 +102,10 @@ linearindex(const int dims[3], int i, int j, int k)
 static void
 igetvectors(int dims[3], int i, int j, int *field, int *v[])
 {
-    int im = MAX(1,       i  ) - 1;
-    int ip = MIN(dims[0], i+1) - 1;
-    int jm = MAX(1,       j  ) - 1;
-    int jp = MIN(dims[1], j+1) - 1;
+    size_t im = MAX(1,       i  ) - 1;
+    size_t ip = MIN(dims[0], i+1) - 1;
+    size_t jm = MAX(1,       j  ) - 1;
+    size_t jp = MIN(dims[1], j+1) - 1;
 
     v[0] = field + dims[2]*(im + dims[0]* jm);
     v[1] = field + dims[2]*(im + dims[0]* jp);
@@ -192,7 +206,58 @@ checkmemory(int nz, struct processed_grid *out, int **intersections)
 }
 
 /*-----------------------------------------------------------------
-  For each vertical face (i.e. i or j constant),
+  Faces generated by a single row of pillar pairs or cell columns.
+  Rows are independent, so each one is processed--possibly
+  concurrently--into its own chunk.  The chunks are concatenated in
+  row order afterwards, which reproduces the serial face ordering.
+  Fault intersections are numbered locally, starting at
+  number_of_nodes_on_pillars, and renumbered when concatenating. */
+struct face_chunk {
+    struct processed_grid g;
+    int                  *intersections;
+};
+
+static int
+init_face_chunk(const struct processed_grid *out, struct face_chunk *chunk)
+{
+    struct processed_grid *g = &chunk->g;
+
+    g->m = g->n = 0;
+
+    g->dimensions[0] = out->dimensions[0];
+    g->dimensions[1] = out->dimensions[1];
+    g->dimensions[2] = out->dimensions[2];
+
+    g->number_of_faces = 0;
+    g->face_nodes      = NULL;
+    g->face_neighbors  = NULL;
+    g->face_tag        = NULL;
+    g->face_ptr        = malloc(1 * sizeof *g->face_ptr);
+
+    g->number_of_nodes            = out->number_of_nodes_on_pillars;
+    g->number_of_nodes_on_pillars = out->number_of_nodes_on_pillars;
+    g->node_coordinates           = NULL;
+
+    g->number_of_cells  = 0;
+    g->local_cell_index = NULL;
+
+    chunk->intersections = NULL;
+
+    if (g->face_ptr != NULL) { g->face_ptr[0] = 0; }
+
+    return g->face_ptr != NULL;
+}
+
+static void
+free_face_chunk(struct face_chunk *chunk)
+{
+    free_processed_grid(&chunk->g);
+    free(chunk->intersections);
+}
+
+/*-----------------------------------------------------------------
+  For each vertical face (i.e. i or j constant) along row j of
+  pillar pairs,
   -find point numbers for the corners and
   -cell neighbors.
   -new points on faults defined by two intgersecting lines.
@@ -201,19 +266,18 @@ checkmemory(int nz, struct processed_grid *out, int **intersections)
   direction == 1 : constant-j faces.
 */
 static void
-process_vertical_faces(int direction,
-                       int **intersections,
+process_vertical_faces(int direction, int j,
                        int *plist, int *work,
-                       struct processed_grid *out)
+                       struct face_chunk *chunk)
 {
-    int i,j;
+    int i, k;
     int *cornerpts[4];
     int d[3];
     int f;
     enum face_tag tag[] = { LEFT, BACK };
     int *tmp;
+    struct processed_grid *out = &chunk->g;
     int nx = out->dimensions[0];
-    int ny = out->dimensions[1];
     int nz = out->dimensions[2];
     int startface;
     int num_intersections;
@@ -223,93 +287,96 @@ process_vertical_faces(int direction,
     assert ((direction == 0) || (direction == 1));
 
     d[0] = 2 * (nx + 0);
-    d[1] = 2 * (ny + 0);
+    d[1] = 2 * (out->dimensions[1] + 0);
     d[2] = 2 * (nz + 1);
 
-    for (j = 0; j < ny + direction; ++j) {
-        for (i = 0; i < nx + (1 - direction); ++i) {
+    for (i = 0; i < nx + (1 - direction); ++i) {
 
-            if (! checkmemory(nz, out, intersections)) {
-                fprintf(stderr,
-                        "Could not allocate enough space in "
-                        "process_vertical_faces()\n");
-                exit(1);
-            }
+        if (! checkmemory(nz, out, &chunk->intersections)) {
+            fprintf(stderr,
+                    "Could not allocate enough space in "
+                    "process_vertical_faces()\n");
+            exit(1);
+        }
 
-            /* Vectors of point numbers */
-            igetvectors(d, 2*i + direction, 2*j + (1 - direction),
-                        plist, cornerpts);
-
-            if (direction == 1) {
-                /* 1   3       0   1    */
-                /*       --->           */
-                /* 0   2       2   3    */
-                /* rotate clockwise     */
-                tmp          = cornerpts[1];
-                cornerpts[1] = cornerpts[0];
-                cornerpts[0] = cornerpts[2];
-                cornerpts[2] = cornerpts[3];
-                cornerpts[3] = tmp;
-            }
+        /* Vectors of point numbers */
+        igetvectors(d, 2*i + direction, 2*j + (1 - direction),
+                    plist, cornerpts);
+
+        if (direction == 1) {
+            /* 1   3       0   1    */
+            /*       --->           */
+            /* 0   2       2   3    */
+            /* rotate clockwise     */
+            tmp          = cornerpts[1];
+            cornerpts[1] = cornerpts[0];
+            cornerpts[0] = cornerpts[2];
+            cornerpts[2] = cornerpts[3];
+            cornerpts[3] = tmp;
+        }
 
-            /* int startface = ftab->position; */
-            startface = out->number_of_faces;
-            /* int num_intersections = *npoints - npillarpoints; */
-            num_intersections = out->number_of_nodes -
-                out->number_of_nodes_on_pillars;
-
-            /* Establish new connections (faces) along pillar pair. */
-            findconnections(2*nz + 2, cornerpts,
-                            *intersections + 4*num_intersections,
-                            work, out);
-
-            /* Start of ->face_neighbors[] for this set of connections. */
-            ptr = out->face_neighbors + 2*startface;
-
-            /* Total number of cells (both sides) connected by this
-             * set of connections (faces). */
-            len = 2*out->number_of_faces - 2*startface;
-
-            /* Derive inter-cell connectivity (i.e. ->face_neighbors)
-             * of global (uncompressed) cells for this set of
-             * connections (faces). */
-            compute_cell_index(out->dimensions, i-1+direction, j-direction, ptr    , len);
-            compute_cell_index(out->dimensions, i            , j          , ptr + 1, len);
-
-            /* Tag the new faces */
-            f = startface;
-            for (; f < out->number_of_faces; ++f) {
-                out->face_tag[f] = tag[direction];
-            }
+        /* int startface = ftab->position; */
+        startface = out->number_of_faces;
+        /* int num_intersections = *npoints - npillarpoints; */
+        num_intersections = out->number_of_nodes -
+            out->number_of_nodes_on_pillars;
+
+        /* Fresh intersection records for each pillar pair */
+        for (k = 0; k < 2 * (2*nz + 2); ++k) { work[k] = -1; }
+
+        /* Establish new connections (faces) along pillar pair. */
+        findconnections(2*nz + 2, cornerpts,
+                        chunk->intersections + 4*num_intersections,
+                        work, out);
+
+        /* Start of ->face_neighbors[] for this set of connections. */
+        ptr = out->face_neighbors + 2*startface;
+
+        /* Total number of cells (both sides) connected by this
+         * set of connections (faces). */
+        len = 2*out->number_of_faces - 2*startface;
+
+        /* Derive inter-cell connectivity (i.e. ->face_neighbors)
+         * of global (uncompressed) cells for this set of
+         * connections (faces). */
+        compute_cell_index(out->dimensions, i-1+direction, j-direction, ptr    , len);
+        compute_cell_index(out->dimensions, i            , j          , ptr + 1, len);
+
+        /* Tag the new faces */
+        f = startface;
+        for (; f < out->number_of_faces; ++f) {
+            out->face_tag[f] = tag[direction];
         }
     }
 }
 
 
 /*-----------------------------------------------------------------
-  For each horizontal face (i.e. k constant),
+  For each horizontal face (i.e. k constant) along row j of cell
+  columns,
   -find point numbers for the corners and
   -cell neighbors.
 
-  Also define map from logically Cartesian
-  cell index to local cell index 0, ..., #<active cells>.   Exclude
-  cells that are have collapsed coordinates. (This includes cells with
-  ACTNUM==0)
+  Also flag cells that are have collapsed coordinates in <cell> by
+  -1. (This includes cells with ACTNUM==0).  Remaining cells are
+  flagged by their sequence number within the chunk and are counted
+  in chunk->g.number_of_cells.
 
 */
 static void
-process_horizontal_faces(int **intersections,
+process_horizontal_faces(int j,
                          int *plist,
-                         struct processed_grid *out)
+                         int *cell,
+                         struct face_chunk *chunk)
 {
-    int i,j,k;
+    int i,k;
+
+    struct processed_grid *out = &chunk->g;
 
     int nx = out->dimensions[0];
     int ny = out->dimensions[1];
     int nz = out->dimensions[2];
 
-    int *cell  = out->local_cell_index;
-    int cellno = 0;
     int *f, *n, *c[4];
     int prevcell, thiscell;
     int idx;
@@ -321,45 +388,62 @@ process_horizontal_faces(int **intersections,
     d[2] = 2+2*nz;
 
 
-    for(j=0; j<ny; ++j) {
-        for (i=0; i<nx; ++i) {
+    for (i=0; i<nx; ++i) {
 
 
-            if (! checkmemory(nz, out, intersections)) {
-                fprintf(stderr,
-                        "Could not allocate enough space in "
-                        "process_horizontal_faces()\n");
-                exit(1);
-            }
+        if (! checkmemory(nz, out, &chunk->intersections)) {
+            fprintf(stderr,
+                    "Could not allocate enough space in "
+                    "process_horizontal_faces()\n");
+            exit(1);
+        }
 
 
-            f = out->face_nodes     + out->face_ptr[out->number_of_faces];
-            n = out->face_neighbors + 2*out->number_of_faces;
+        f = out->face_nodes     + out->face_ptr[out->number_of_faces];
+        n = out->face_neighbors + 2*out->number_of_faces;
 
 
-            /* Vectors of point numbers */
-            igetvectors(d, 2*i+1, 2*j+1, plist, c);
+        /* Vectors of point numbers */
+        igetvectors(d, 2*i+1, 2*j+1, plist, c);
 
-            prevcell = -1;
+        prevcell = -1;
 
 
-            for (k = 1; k<nz*2+1; ++k){
+        for (k = 1; k<nz*2+1; ++k){
 
-                /* Skip if space between face k and face k+1 is collapsed. */
-                /* Note that inactive cells (with ACTNUM==0) have all been  */
-                /* collapsed in finduniquepoints.                           */
-                if (c[0][k] == c[0][k+1] && c[1][k] == c[1][k+1] &&
-                    c[2][k] == c[2][k+1] && c[3][k] == c[3][k+1]){
+            /* Skip if space between face k and face k+1 is collapsed. */
+            /* Note that inactive cells (with ACTNUM==0) have all been  */
+            /* collapsed in finduniquepoints.                           */
+            if (c[0][k] == c[0][k+1] && c[1][k] == c[1][k+1] &&
+                c[2][k] == c[2][k+1] && c[3][k] == c[3][k+1]){
 
-                    /* If the pinch is a cell: */
-                    if (k%2){
-                        idx = linearindex(out->dimensions, i,j,(k-1)/2);
-                        cell[idx] = -1;
-                    }
+                /* If the pinch is a cell: */
+                if (k%2){
+                    idx = linearindex(out->dimensions, i,j,(k-1)/2);
+                    cell[idx] = -1;
                 }
-                else{
+            }
+            else{
 
-                    if (k%2){
+                if (k%2){
+                    /* Add face */
+                    *f++ = c[0][k];
+                    *f++ = c[2][k];
+                    *f++ = c[3][k];
+                    *f++ = c[1][k];
+
+                    out->face_tag[  out->number_of_faces] = TOP;
+                    out->face_ptr[++out->number_of_faces] = f - out->face_nodes;
+
+                    thiscell = linearindex(out->dimensions, i,j,(k-1)/2);
+                    *n++ = prevcell;
+                    *n++ = prevcell = thiscell;
+
+                    cell[thiscell] = out->number_of_cells++;
+
+                }
+                else{
+                    if (prevcell != -1){
                         /* Add face */
                         *f++ = c[0][k];
                         *f++ = c[2][k];
@@ -369,33 +453,278 @@ process_horizontal_faces(int **intersections,
                         out->face_tag[  out->number_of_faces] = TOP;
                         out->face_ptr[++out->number_of_faces] = f - out->face_nodes;
 
-                        thiscell = linearindex(out->dimensions, i,j,(k-1)/2);
                         *n++ = prevcell;
-                        *n++ = prevcell = thiscell;
-
-                        cell[thiscell] = cellno++;
-
-                    }
-                    else{
-                        if (prevcell != -1){
-                            /* Add face */
-                            *f++ = c[0][k];
-                            *f++ = c[2][k];
-                            *f++ = c[3][k];
-                            *f++ = c[1][k];
-
-                            out->face_tag[  out->number_of_faces] = TOP;
-                            out->face_ptr[++out->number_of_faces] = f - out->face_nodes;
-
-                            *n++ = prevcell;
-                            *n++ = prevcell = -1;
-                        }
+                        *n++ = prevcell = -1;
                     }
                 }
             }
         }
     }
-    out->number_of_cells = cellno;
+}
+
+
+/*-----------------------------------------------------------------
+  Rewind a face chunk for reuse, keeping its allocated storage. */
+static void
+reset_face_chunk(struct face_chunk *chunk)
+{
+    struct processed_grid *g = &chunk->g;
+
+    g->number_of_faces = 0;
+    g->face_ptr[0]     = 0;
+    g->number_of_nodes = g->number_of_nodes_on_pillars;
+    g->number_of_cells = 0;
+}
+
+
+/*-----------------------------------------------------------------
+  Grow the face arrays of <out> and the <intersections> array (of
+  capacity *icap) to hold at least <nf> faces, <nn> face nodes and
+  <ni> intersections.  Capacity grows geometrically. */
+static int
+reserve_face_storage(size_t nf, size_t nn, size_t ni,
+                     size_t *icap, int **intersections,
+                     struct processed_grid *out)
+{
+    int   ok;
+    void *p;
+
+    ok = 1;
+
+    if (nf > (size_t) out->m) {
+        size_t m = MAX(nf, (size_t) out->m + (size_t) out->m / 2);
+
+        p = realloc(out->face_neighbors, 2*m   * sizeof *out->face_neighbors);
+        if (p != NULL) { out->face_neighbors = p; } else { ok = 0; }
+
+        p = realloc(out->face_ptr      , (m+1) * sizeof *out->face_ptr);
+        if (p != NULL) { out->face_ptr       = p; } else { ok = 0; }
+
+        p = realloc(out->face_tag      , 1*m   * sizeof *out->face_tag);
+        if (p != NULL) { out->face_tag       = p; } else { ok = 0; }
+
+        if (ok) { out->m = (int) m; }
+    }
+
+    if (ok && (nn > (size_t) out->n)) {
+        size_t n = MAX(nn, (size_t) out->n + (size_t) out->n / 2);
+
+        p = realloc(out->face_nodes, n * sizeof *out->face_nodes);
+        if (p != NULL) { out->face_nodes = p; out->n = (int) n; }
+        else           { ok = 0; }
+    }
+
+    if (ok && (ni > *icap)) {
+        size_t n = MAX(ni, *icap + *icap / 2);
+
+        p = realloc(*intersections, 4 * n * sizeof **intersections);
+        if (p != NULL) { *intersections = p; *icap = n; }
+        else           { ok = 0; }
+    }
+
+    return ok;
+}
+
+
+/*-----------------------------------------------------------------
+  Append the faces and fault intersections of <chunk> to <out>.
+  The chunk's intersections are renumbered to follow those already
+  present in <out>. */
+static void
+append_face_chunk(const struct face_chunk *chunk,
+                  size_t *icap, int **intersections,
+                  struct processed_grid *out)
+{
+    const struct processed_grid *g = &chunk->g;
+
+    size_t f, k, nf, nn, ni, np;
+    int   *fn;
+    int    ishift;
+
+    np = out->number_of_nodes_on_pillars;
+
+    nf = (size_t) out->number_of_faces + g->number_of_faces;
+    nn = (size_t) out->face_ptr[out->number_of_faces]
+        + g->face_ptr[g->number_of_faces];
+    ni = ((size_t) out->number_of_nodes - np) + (g->number_of_nodes - np);
+
+    if ((2*nf > INT_MAX) || (nn > INT_MAX) || (np + ni > INT_MAX)) {
+        fprintf(stderr, "Grid too large: %lu faces, %lu face nodes and "
+                "%lu nodes exceed range of processed_grid\n",
+                (unsigned long) nf, (unsigned long) nn,
+                (unsigned long) (np + ni));
+        exit(1);
+    }
+
+    if (! reserve_face_storage(nf, nn, ni, icap, intersections, out)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "append_face_chunk()\n");
+        exit(1);
+    }
+
+    ishift = out->number_of_nodes - (int) np;
+    fn     = out->face_nodes + out->face_ptr[out->number_of_faces];
+
+    for (k = 0; k < (size_t) g->face_ptr[g->number_of_faces]; ++k) {
+        fn[k] = g->face_nodes[k];
+        if (fn[k] >= (int) np) { fn[k] += ishift; }
+    }
+
+    for (f = 0; f < (size_t) g->number_of_faces; ++f) {
+        out->face_ptr[out->number_of_faces + f + 1] =
+            out->face_ptr[out->number_of_faces] + g->face_ptr[f + 1];
+    }
+
+    memcpy(out->face_neighbors + 2*((size_t) out->number_of_faces),
+           g->face_neighbors,
+           2 * g->number_of_faces * sizeof *out->face_neighbors);
+    memcpy(out->face_tag       + 1*((size_t) out->number_of_faces),
+           g->face_tag,
+           1 * g->number_of_faces * sizeof *out->face_tag);
+    memcpy(*intersections      + 4*((size_t) ishift),
+           chunk->intersections,
+           4 * (g->number_of_nodes - np) * sizeof **intersections);
+
+    out->number_of_faces  = (int) nf;
+    out->number_of_nodes  = (int) (np + ni);
+    out->number_of_cells += g->number_of_cells;
+}
+
+
+/*-----------------------------------------------------------------
+  Trim the face arrays of <out> and the <intersections> array to
+  their exact sizes.  Failure to shrink is harmless. */
+static void
+shrink_face_storage(size_t *icap, int **intersections,
+                    struct processed_grid *out)
+{
+    size_t nf, nn, ni;
+    void  *p;
+
+    nf = out->number_of_faces;
+    nn = out->face_ptr[nf];
+    ni = out->number_of_nodes - out->number_of_nodes_on_pillars;
+
+    p = realloc(out->face_neighbors, MAX(2*nf, 1) * sizeof *out->face_neighbors);
+    if (p != NULL) { out->face_neighbors = p; }
+
+    p = realloc(out->face_ptr      , (nf + 1)     * sizeof *out->face_ptr);
+    if (p != NULL) { out->face_ptr       = p; }
+
+    p = realloc(out->face_tag      , MAX(nf, 1)   * sizeof *out->face_tag);
+    if (p != NULL) { out->face_tag       = p; }
+
+    p = realloc(out->face_nodes    , MAX(nn, 1)   * sizeof *out->face_nodes);
+    if (p != NULL) { out->face_nodes     = p; }
+
+    p = realloc(*intersections     , MAX(4*ni, 1) * sizeof **intersections);
+    if (p != NULL) { *intersections      = p; *icap = ni; }
+
+    out->m = (int) nf;
+    out->n = (int) nn;
+}
+
+
+/*-----------------------------------------------------------------
+  Derive all faces of the grid: constant-i faces, constant-j faces
+  and horizontal faces, each processed one row at a time.  Rows are
+  handled in batches: the rows of a batch are distributed across
+  threads, each into its own chunk, and the chunks are then appended
+  to <out> in row order.  The output therefore does not depend on
+  the number of threads, and the chunk storage--which reserves room
+  for the pathological all-to-all fault connection--is bounded by
+  the batch size rather than by the number of rows.
+
+  Also define map from logically Cartesian cell index to local cell
+  index 0, ..., #<active cells>.  Exclude cells that are have
+  collapsed coordinates. (This includes cells with ACTNUM==0)
+*/
+static void
+process_faces(int *plist, int **intersections,
+              struct processed_grid *out)
+{
+    int     c, ok, nthreads, nslot, r0;
+    size_t  icap, lwork;
+    int    *work;
+    int ny = out->dimensions[1];
+    int nz = out->dimensions[2];
+
+    /* Rows of constant-i faces, of constant-j faces, of
+     * horizontal faces. */
+    const int nrow = ny + (ny + 1) + ny;
+
+    struct face_chunk *chunk;
+
+    nthreads = max_threads();
+    nslot    = MIN(nrow, 4 * nthreads);
+    lwork    = 2 * ((size_t) (2*nz + 2));
+
+    chunk = malloc(nslot * sizeof *chunk);
+    work  = malloc(nthreads * lwork * sizeof *work);
+
+    ok = (chunk != NULL) && (work != NULL);
+    for (c = 0; ok && (c < nslot); ++c) {
+        ok = init_face_chunk(out, &chunk[c]);
+        if (! ok) {
+            while (c-- > 0) { free_face_chunk(&chunk[c]); }
+        }
+    }
+
+    if (! ok) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces()\n");
+        exit(1);
+    }
+
+    icap                 = 0;
+    out->number_of_faces = 0;
+    out->number_of_nodes = out->number_of_nodes_on_pillars;
+    out->number_of_cells = 0;
+
+    assert (out->face_ptr == NULL);
+    out->face_ptr = malloc(1 * sizeof *out->face_ptr);
+    if (out->face_ptr == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces()\n");
+        exit(1);
+    }
+    out->face_ptr[0] = 0;
+
+    for (r0 = 0; r0 < nrow; r0 += nslot) {
+        const int nbatch = MIN(nslot, nrow - r0);
+
+#pragma omp parallel for schedule(dynamic, 1)
+        for (c = 0; c < nbatch; ++c) {
+            int  r = r0 + c;
+            int *w = work + thread_num()*lwork;
+
+            reset_face_chunk(&chunk[c]);
+
+            if (r < ny) {
+                process_vertical_faces(0, r, plist, w, &chunk[c]);
+            }
+            else if (r < 2*ny + 1) {
+                process_vertical_faces(1, r - ny, plist, w, &chunk[c]);
+            }
+            else {
+                process_horizontal_faces(r - (2*ny + 1), plist,
+                                         out->local_cell_index, &chunk[c]);
+            }
+        }
+
+        for (c = 0; c < nbatch; ++c) {
+            append_face_chunk(&chunk[c], &icap, intersections, out);
+        }
+    }
+
+    for (c = 0; c < nslot; ++c) {
+        free_face_chunk(&chunk[c]);
+    }
+    free(chunk);
+    free(work);
+
+    /* Release the growth headroom. */
+    shrink_face_storage(&icap, intersections, out);
 }
 
 
@@ -422,10 +751,10 @@ static void approximate_intersection_pt(int *L, double *c, double *pt)
     assert (L[0] != L[2]);
     assert (L[1] != L[3]);
 
-    z0 = c[3*L[0] + 2];
-    z1 = c[3*L[1] + 2];
-    z2 = c[3*L[2] + 2];
-    z3 = c[3*L[3] + 2];
+    z0 = c[3*((size_t) L[0]) + 2];
+    z1 = c[3*((size_t) L[1]) + 2];
+    z2 = c[3*((size_t) L[2]) + 2];
+    z3 = c[3*((size_t) L[3]) + 2];
 
     /* find parameter a where lines L0L1 and L2L3 have same
      * z-coordinate */
@@ -446,14 +775,14 @@ static void approximate_intersection_pt(int *L, double *c, double *pt)
     /* find point (x1, y1, z) on pillar 1 */
     b1 = (z2 - z) / (z2 - z0);
     b2 = (z - z0) / (z2 - z0);
-    x1 = c[3*L[0] + 0]*b1 + c[3*L[2] + 0]*b2;
-    y1 = c[3*L[0] + 1]*b1 + c[3*L[2] + 1]*b2;
+    x1 = c[3*((size_t) L[0]) + 0]*b1 + c[3*((size_t) L[2]) + 0]*b2;
+    y1 = c[3*((size_t) L[0]) + 1]*b1 + c[3*((size_t) L[2]) + 1]*b2;
 
     /* find point (x2, y2, z) on pillar 2 */
     b1 = (z - z3) / (z1 - z3);
     b2 = (z1 - z) / (z1 - z3);
-    x2 = c[3*L[1] + 0]*b1 + c[3*L[3] + 0]*b2;
-    y2 = c[3*L[1] + 1]*b1 + c[3*L[3] + 1]*b2;
+    x2 = c[3*((size_t) L[1]) + 0]*b1 + c[3*((size_t) L[3]) + 0]*b2;
+    y2 = c[3*((size_t) L[1]) + 1]*b1 + c[3*((size_t) L[3]) + 1]*b2;
 
     /* horizontal lines are by definition ON the bilinear surface
        spanned by L0, L1, L2 and L3.  find point (x, y, z) on
@@ -473,27 +802,24 @@ compute_intersection_coordinates(int                   *intersections,
     int n  = out->number_of_nodes;
     int np = out->number_of_nodes_on_pillars;
     int    k;
-    double *pt;
-    int    *itsct = intersections;
     /* Make sure the space allocated for nodes match the number of
      * node. */
-    void *p = realloc (out->node_coordinates, 3*n*sizeof(double));
+    void *p = realloc (out->node_coordinates, 3*((size_t) n)*sizeof(double));
     if (p) {
         out->node_coordinates = p;
     }
     else {
         fprintf(stderr, "Could not allocate extra space for intersections\n");
+        return;
     }
 
 
-    /* Append intersections */
-    pt    = out->node_coordinates + 3*np;
-
+    /* Append intersections.  These are mutually independent. */
+#pragma omp parallel for schedule(static)
     for (k=np; k<n; ++k){
-        approximate_intersection_pt(itsct, out->node_coordinates, pt);
-        pt    += 3;
-        itsct += 4;
-
+        approximate_intersection_pt(intersections + 4*((size_t) (k - np)),
+                                    out->node_coordinates,
+                                    out->node_coordinates + 3*((size_t) k));
     }
 }
 
@@ -503,7 +829,7 @@ static int*
 copy_and_permute_actnum(int nx, int ny, int nz, const int *in, int *out)
 /* ------------------------------------------------------------------ */
 {
-    int i,j,k;
+    size_t i,j,k;
     int *ptr = out;
 
     /* Permute actnum such that values of each vertical stack of cells
@@ -514,9 +840,9 @@ copy_and_permute_actnum(int nx, int ny, int nz, const int *in, int *out)
      * in MATLAB pseudo-code.
      */
     if (in != NULL) {
-        for (j = 0; j < ny; ++j) {
-            for (i = 0; i < nx; ++i) {
-                for (k = 0; k < nz; ++k) {
+        for (j = 0; j < (size_t) ny; ++j) {
+            for (i = 0; i < (size_t) nx; ++i) {
+                for (k = 0; k < (size_t) nz; ++k) {
                     *ptr++ = in[i + nx*(j + ny*k)];
                 }
             }
@@ -524,7 +850,7 @@ copy_and_permute_actnum(int nx, int ny, int nz, const int *in, int *out)
     }
     else {
         /* No explicit ACTNUM.  Assume all cells active. */
-        for (i = 0; i < nx * ny * nz; i++) {
+        for (i = 0; i < ((size_t) nx) * ny * nz; i++) {
             out[ i ] = 1;
         }
     }
@@ -538,7 +864,7 @@ copy_and_permute_zcorn(int nx, int ny, int nz, const double *in,
                        double sign, double *out)
 /* ------------------------------------------------------------------ */
 {
-    int i,j,k;
+    size_t i,j,k;
     double *ptr = out;
     /* Permute zcorn such that values of each vertical stack of cells
      * are adjacent in memory, i.e.,
@@ -547,9 +873,9 @@ copy_and_permute_zcorn(int nx, int ny, int nz, const double *in,
 
      in Matlab pseudo-code.
     */
-    for (j=0; j<2*ny; ++j){
-        for (i=0; i<2*nx; ++i){
-            for (k=0; k<2*nz; ++k){
+    for (j=0; j<2*((size_t) ny); ++j){
+        for (i=0; i<2*((size_t) nx); ++i){
+            for (k=0; k<2*((size_t) nz); ++k){
                 *ptr++ = sign * in[i+2*nx*(j+2*ny*k)];
             }
         }
@@ -574,25 +900,25 @@ get_zcorn_sign(int nx, int ny, int nz, const int *actnum,
 
     */
     int    sign;
-    int    i, j, k;
-    int    c1, c2;
+    size_t i, j, k;
+    size_t c1, c2;
     double z1, z2;
 
     for (sign = 1; sign>-2; sign = sign - 2)
     {
         *error = 0;
 
-        for (j=0; j<2*ny; ++j){
-            for (i=0; i<2*nx; ++i){
-                for (k=0; k<2*nz-1; ++k){
+        for (j=0; j<2*((size_t) ny); ++j){
+            for (i=0; i<2*((size_t) nx); ++i){
+                for (k=0; k+1<2*((size_t) nz); ++k){
                     z1 = sign*zcorn[i+2*nx*(j+2*ny*(k))];
                     z2 = sign*zcorn[i+2*nx*(j+2*ny*(k+1))];
 
                     c1 = i/2 + nx*(j/2 + ny*(k/2));
                     c2 = i/2 + nx*(j/2 + ny*((k+1)/2));
 
-                    assert (c1 < (nx * ny * nz));
-                    assert (c2 < (nx * ny * nz));
+                    assert (c1 < (((size_t) nx) * ny * nz));
+                    assert (c2 < (((size_t) nx) * ny * nz));
 
                     if (((actnum == NULL) ||
                          (actnum[c1] && actnum[c2]))
@@ -773,14 +1099,12 @@ void process_grdecl(const struct grdecl   *in,
 
     double *zcorn;
 
-    const size_t BIGNUM = 64;
     const int    nx = in->dims[0];
     const int    ny = in->dims[1];
     const int    nz = in->dims[2];
     const size_t nc = ((size_t) nx) * ((size_t) ny) * ((size_t) nz);
 
     /* internal work arrays */
-    int    *work;
     int    *plist;
     int    *intersections;
 
@@ -789,18 +1113,17 @@ void process_grdecl(const struct grdecl   *in,
 
     /* -----------------------------------------------------------------*/
     /* Initialize output structure:
-       1) allocate space for grid topology (which may need to be
-          increased)
-       2) set Cartesian imensions
+       1) set Cartesian imensions
+       2) grid topology is allocated, to its exact size, once all
+          faces are known
     */
-    out->m                = (int) (BIGNUM / 3);
-    out->n                = (int) BIGNUM;
+    out->m                = 0;
+    out->n                = 0;
 
-    out->face_neighbors   = malloc( BIGNUM      * sizeof *out->face_neighbors);
-    out->face_nodes       = malloc( out->n      * sizeof *out->face_nodes);
-    out->face_ptr         = malloc((out->m + 1) * sizeof *out->face_ptr);
-    out->face_tag         = malloc( out->m      * sizeof *out->face_tag);
-    out->face_ptr[0]      = 0;
+    out->face_neighbors   = NULL;
+    out->face_nodes       = NULL;
+    out->face_ptr         = NULL;
+    out->face_tag         = NULL;
 
     out->dimensions[0]    = in->dims[0];
     out->dimensions[1]    = in->dims[1];
@@ -861,21 +1184,13 @@ void process_grdecl(const struct grdecl   *in,
     /* -----------------------------------------------------------------*/
     /* Find face topology and face-to-cell connections */
 
-    /* internal */
-    work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
-    for(i = 0; i < ((size_t)4) * (nz + 1); ++i) { work[i] = -1; }
-
-    /* internal array to store intersections */
-    intersections = malloc(BIGNUM* sizeof(*intersections));
-
-
+    /* internal array to store intersections is allocated by
+     * process_faces() */
+    intersections = NULL;
 
-    process_vertical_faces   (0, &intersections, plist, work, out);
-    process_vertical_faces   (1, &intersections, plist, work, out);
-    process_horizontal_faces (   &intersections, plist,       out);
+    process_faces(plist, &intersections, out);
 
     free (plist);
-    free (work);
 
     /* -----------------------------------------------------------------*/
     /* (re)allocate space for and compute coordinates of nodes that
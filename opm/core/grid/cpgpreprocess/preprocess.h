@@ -76,9 +76,9 @@ extern "C" {
      * a geological model in corner-point format.
      */
     struct processed_grid {
-        int m; /**< Upper bound on "number_of_faces".  For internal use in
+        int m; /**< Allocated number of faces.  For internal use in
                     function process_grid()'s memory management. */
-        int n; /**< Upper bound on "number_of_nodes".  For internal use in
+        int n; /**< Allocated number of face nodes.  For internal use in
                     function process_grid()'s memory management. */
 
         int    dimensions[3];     /**< Cartesian box dimensions. */
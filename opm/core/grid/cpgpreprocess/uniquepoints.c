@@ -42,12 +42,36 @@
 #include <string.h>
 
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "preprocess.h"
 #include "uniquepoints.h"
 
 #define MIN(i,j) (((i) < (j)) ? (i) : (j))
 #define MAX(i,j) (((i) > (j)) ? (i) : (j))
 
+static int
+max_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static int
+thread_num(void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
 /*-----------------------------------------------------------------
   Compare function passed to qsortx  */
 static int compare(const void *a, const void *b)
@@ -261,10 +285,38 @@ static void interpolate_pillar(const double *coord, double *pt)
 #endif
 }
 
+/*-----------------------------------------------------------------
+  Unique, sorted z-values on pillar (i,j).  Stores up to 8*nz values
+  in <list> and returns the number of unique values. */
+static int
+pillar_zlist(const struct grdecl *g, const int d1[3],
+             int i, int j, double tolerance, double *list)
+{
+    int           len;
+    const double *z[4];
+    const int    *a[4];
+
+    /* Get positioned pointers for actnum and zcorn data */
+    igetvectors(g->dims,   i,   j, g->actnum, a);
+    dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
+
+    len = createSortedList(     list, d1[2], 4, z, a);
+    len = uniquify        (len, list, tolerance);
+
+    return len;
+}
+
 /*-----------------------------------------------------------------
   Assign point numbers p such that "zlist(p)==zcorn".  Assume that
   coordinate number is arranged in a sequence such that the natural
-  index is (k,i,j) */
+  index is (k,i,j).
+
+  The pillars are processed in two passes.  The first counts the
+  unique points on each pillar, which sizes the sparse table of z
+  values and the node coordinates exactly, and the second fills them
+  in.  Both passes, as well as the point number assignment, treat
+  each pillar (respectively each vertical set of zcorn values)
+  independently and are therefore run in parallel. */
 int finduniquepoints(const struct grdecl *g,
                      /* return values: */
                      int           *plist, /* list of point numbers on
@@ -273,109 +325,143 @@ int finduniquepoints(const struct grdecl *g,
                      struct processed_grid *out)
 
 {
+    const size_t nx       = g->dims[0];
+    const size_t ny       = g->dims[1];
+    const size_t nz       = g->dims[2];
+    const size_t npillars = (nx + 1) * (ny + 1);
+
+    size_t *zptr;
+    double *zlist, *work;
+    size_t  pix;
+    int     i, j, ok, nthreads;
+    int     d1[3];
 
-    const int nx = out->dimensions[0];
-    const int ny = out->dimensions[1];
-    const int nz = out->dimensions[2];
-    const int nc = g->dims[0]*g->dims[1]*g->dims[2];
-
-
-    /* zlist may need extra space temporarily due to simple boundary
-     * treatement  */
-    int            npillarpoints = 8*(nx+1)*(ny+1)*nz;
-    int            npillars      = (nx+1)*(ny+1);
-
-    double *zlist = malloc(npillarpoints*sizeof *zlist);
-    int     *zptr = malloc((npillars+1)*sizeof *zptr);
-
-
+    d1[0] = 2*g->dims[0];
+    d1[1] = 2*g->dims[1];
+    d1[2] = 2*g->dims[2];
 
+    zptr = malloc((npillars + 1) * sizeof *zptr);
+    if (zptr == NULL) {
+        fprintf(stderr, "Could not allocate pillar table "
+                "in finduniquepoints()\n");
+        return 0;
+    }
 
-    int     i,j,k;
+    /* Per-thread scratch space for pillar_zlist(), allocated up
+     * front so that every thread enters the worksharing loops. */
+    nthreads = max_threads();
+    work     = malloc(nthreads * 8 * nz * sizeof *work);
+    if (work == NULL) {
+        fprintf(stderr, "Could not allocate work space "
+                "in finduniquepoints()\n");
+        free(zptr);
+        return 0;
+    }
 
-    int     d1[3];
-    int     len    = 0;
-    double  *zout  = zlist;
-    int     pos    = 0;
-    double *pt;
-    const double *z[4];
-    const int *a[4];
-    int *p;
-    int pix, cix;
-    int zix;
+    /* Pass 1: count unique points on each pillar. */
+#pragma omp parallel for private(i) schedule(static)
+    for (j = 0; j < g->dims[1] + 1; ++j) {
+        double *w = work + thread_num()*8*nz;
 
-    const double *coord = g->coord;
+        for (i = 0; i < g->dims[0] + 1; ++i) {
+            zptr[i + (nx + 1)*j + 1] =
+                pillar_zlist(g, d1, i, j, tolerance, w);
+        }
+    }
 
-    d1[0] = 2*g->dims[0];
-    d1[1] = 2*g->dims[1];
-    d1[2] = 2*g->dims[2];
+    zptr[0] = 0;
+    for (pix = 0; pix < npillars; ++pix) {
+        zptr[pix + 1] += zptr[pix];
+    }
 
-    out->node_coordinates = malloc (3*8*nc*sizeof(*out->node_coordinates));
+    if (zptr[npillars] > INT_MAX) {
+        fprintf(stderr, "Number of pillar points (%lu) exceeds "
+                "range of node numbers\n",
+                (unsigned long) zptr[npillars]);
+        free(work);
+        free(zptr);
+        return 0;
+    }
 
-    zptr[pos++] = zout - zlist;
+    zlist                 = malloc(    zptr[npillars] * sizeof *zlist);
+    out->node_coordinates = malloc(3 * zptr[npillars] *
+                                   sizeof *out->node_coordinates);
+
+    if ((zlist == NULL) || (out->node_coordinates == NULL)) {
+        fprintf(stderr, "Could not allocate pillar points "
+                "in finduniquepoints()\n");
+        free(zlist);
+        free(work);
+        free(zptr);
+        return 0;
+    }
 
-    pt    = out->node_coordinates;
+    /* Pass 2: store unique points on each pillar. */
+#pragma omp parallel for private(i) schedule(static)
+    for (j = 0; j < g->dims[1] + 1; ++j) {
+        size_t  p, k;
+        int     len;
+        double *pt;
+        double *w = work + thread_num()*8*nz;
 
-    /* Loop over pillars, find unique points on each pillar */
-    for (j=0; j < g->dims[1]+1; ++j){
-        for (i=0; i < g->dims[0]+1; ++i){
+        for (i = 0; i < g->dims[0] + 1; ++i) {
+            p   = i + (nx + 1)*j;
+            len = pillar_zlist(g, d1, i, j, tolerance, w);
 
-            /* Get positioned pointers for actnum and zcorn data */
-            igetvectors(g->dims,   i,   j, g->actnum, a);
-            dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
+            assert ((size_t) len == zptr[p + 1] - zptr[p]);
 
-            len = createSortedList(     zout, d1[2], 4, z, a);
-            len = uniquify        (len, zout, tolerance);
+            memcpy(zlist + zptr[p], w, len * sizeof *zlist);
 
             /* Assign unique points */
-            for (k=0; k<len; ++k){
-                pt[2] = zout[k];
-                interpolate_pillar(coord, pt);
-                pt += 3;
+            pt = out->node_coordinates + 3*zptr[p];
+            for (k = 0; k < (size_t) len; ++k, pt += 3) {
+                pt[2] = w[k];
+                interpolate_pillar(g->coord + 6*p, pt);
             }
-
-            /* Increment pointer to sparse table of unique zcorn
-             * values */
-            zout        = zout + len;
-            zptr[pos++] = zout - zlist;
-
-            coord += 6;
         }
     }
-    out->number_of_nodes_on_pillars = zptr[pos-1];
-    out->number_of_nodes            = zptr[pos-1];
+
+    free(work);
+
+    out->number_of_nodes_on_pillars = (int) zptr[npillars];
+    out->number_of_nodes            = (int) zptr[npillars];
 
     /* Loop over all vertical sets of zcorn values, assign point
      * numbers */
-    p = plist;
-    for (j=0; j < 2*g->dims[1]; ++j){
-        for (i=0; i < 2*g->dims[0]; ++i){
+    ok = 1;
+#pragma omp parallel for schedule(static) private(i) reduction(&&:ok)
+    for (j = 0; j < 2*g->dims[1]; ++j) {
+        size_t p, cix, zix;
+
+        for (i = 0; i < 2*g->dims[0]; ++i) {
 
             /* pillar index */
-            pix = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
+            p = (i+1)/2 + (nx+1)*((j+1)/2);
 
             /* cell column position */
-            cix = g->dims[2]*((i/2) + (j/2)*g->dims[0]);
+            cix = nz*((i/2) + (j/2)*nx);
 
             /* zcorn column position */
-            zix = 2*g->dims[2]*(i+2*g->dims[0]*j);
+            zix = 2*nz*(i + 2*nx*j);
 
-            if (!assignPointNumbers(zptr[pix], zptr[pix+1], zlist,
-                                    2*g->dims[2],
+            if (!assignPointNumbers((int) zptr[p], (int) zptr[p+1],
+                                    zlist, 2*g->dims[2],
                                     g->zcorn  + zix, g->actnum + cix,
-                                    p, tolerance)){
-                fprintf(stderr, "Something went wrong in assignPointNumbers");
-                return 0;
+                                    plist + (2 + 2*nz)*(i + 2*nx*j),
+                                    tolerance)){
+                ok = 0;
             }
-
-            p += 2 + 2*g->dims[2];
         }
     }
 
+    if (! ok) {
+        fprintf(stderr, "Something went wrong in assignPointNumbers");
+    }
+
     free(zptr);
     free(zlist);
 
-    return 1;
+    return ok;
 }
 
 /* Local Variables:    */
@@ -0,0 +1,396 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/grid.h>
+#include <opm/core/grid/grid_binary.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#define GRID_BINARY_MAGIC      "OPMUGRID"
+#define GRID_BINARY_BYTE_ORDER 0x01020304u
+#define GRID_BINARY_ALIGN      8
+
+/* Arrays in the order they are stored --------------------------------- */
+enum grid_binary_array {
+    GB_FACE_NODES = 0,
+    GB_FACE_NODEPOS,
+    GB_FACE_CELLS,
+    GB_CELL_FACES,
+    GB_CELL_FACEPOS,
+    GB_NODE_COORDINATES,
+    GB_FACE_CENTROIDS,
+    GB_FACE_AREAS,
+    GB_FACE_NORMALS,
+    GB_CELL_CENTROIDS,
+    GB_CELL_VOLUMES,
+    GB_GLOBAL_CELL,
+    GB_CELL_FACETAG,
+    GB_NARRAYS
+};
+
+struct grid_binary_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t sizeof_int;
+    uint32_t sizeof_double;
+
+    int32_t  dimensions;
+    int32_t  number_of_cells;
+    int32_t  number_of_faces;
+    int32_t  number_of_nodes;
+    int32_t  cartdims[3];
+    int32_t  padding;
+
+    uint64_t key;
+
+    /* Byte offset from start of file and number of elements of each
+     * array.  Absent (optional) arrays have zero offset. */
+    uint64_t offset[GB_NARRAYS];
+    uint64_t count [GB_NARRAYS];
+};
+
+/* Grid and the mapping backing its arrays.  The grid is the first
+ * member, so a pointer to it is a pointer to the whole. */
+struct mapped_grid {
+    struct UnstructuredGrid grid;
+    void                   *base;
+    size_t                  length;
+};
+
+
+/* ---------------------------------------------------------------------- */
+static size_t
+element_size(int a)
+/* ---------------------------------------------------------------------- */
+{
+    return ((GB_NODE_COORDINATES <= a) && (a <= GB_CELL_VOLUMES))
+        ? sizeof(double) : sizeof(int);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+array_pointers(struct UnstructuredGrid *G, void **p[GB_NARRAYS])
+/* ---------------------------------------------------------------------- */
+{
+    p[GB_FACE_NODES]       = (void **) &G->face_nodes;
+    p[GB_FACE_NODEPOS]     = (void **) &G->face_nodepos;
+    p[GB_FACE_CELLS]       = (void **) &G->face_cells;
+    p[GB_CELL_FACES]       = (void **) &G->cell_faces;
+    p[GB_CELL_FACEPOS]     = (void **) &G->cell_facepos;
+    p[GB_NODE_COORDINATES] = (void **) &G->node_coordinates;
+    p[GB_FACE_CENTROIDS]   = (void **) &G->face_centroids;
+    p[GB_FACE_AREAS]       = (void **) &G->face_areas;
+    p[GB_FACE_NORMALS]     = (void **) &G->face_normals;
+    p[GB_CELL_CENTROIDS]   = (void **) &G->cell_centroids;
+    p[GB_CELL_VOLUMES]     = (void **) &G->cell_volumes;
+    p[GB_GLOBAL_CELL]      = (void **) &G->global_cell;
+    p[GB_CELL_FACETAG]     = (void **) &G->cell_facetag;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+array_counts(int nd, int nc, int nf, int nn,
+             uint64_t nfacenodes, uint64_t ncellfaces,
+             uint64_t count[GB_NARRAYS])
+/* ---------------------------------------------------------------------- */
+{
+    count[GB_FACE_NODES]       = nfacenodes;
+    count[GB_FACE_NODEPOS]     = (uint64_t) nf + 1;
+    count[GB_FACE_CELLS]       = 2 * (uint64_t) nf;
+    count[GB_CELL_FACES]       = ncellfaces;
+    count[GB_CELL_FACEPOS]     = (uint64_t) nc + 1;
+    count[GB_NODE_COORDINATES] = (uint64_t) nd * nn;
+    count[GB_FACE_CENTROIDS]   = (uint64_t) nd * nf;
+    count[GB_FACE_AREAS]       = nf;
+    count[GB_FACE_NORMALS]     = (uint64_t) nd * nf;
+    count[GB_CELL_CENTROIDS]   = (uint64_t) nd * nc;
+    count[GB_CELL_VOLUMES]     = nc;
+    count[GB_GLOBAL_CELL]      = nc;
+    count[GB_CELL_FACETAG]     = ncellfaces;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static uint64_t
+align(uint64_t pos)
+/* ---------------------------------------------------------------------- */
+{
+    return pos + (GRID_BINARY_ALIGN - (pos % GRID_BINARY_ALIGN)) % GRID_BINARY_ALIGN;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+write_grid_binary(const struct UnstructuredGrid *G,
+                  uint64_t                       key,
+                  const char                    *fname)
+/* ---------------------------------------------------------------------- */
+{
+    static const char zeros[GRID_BINARY_ALIGN] = { 0 };
+
+    struct grid_binary_header h;
+    struct UnstructuredGrid   g;
+    void                    **arrays[GB_NARRAYS];
+    uint64_t                  pos, next;
+    char                     *tmpname;
+    FILE                     *fp;
+    int                       a, ok, save_errno;
+
+    save_errno = errno;
+
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, GRID_BINARY_MAGIC, sizeof h.magic);
+    h.version         = GRID_BINARY_VERSION;
+    h.byte_order      = GRID_BINARY_BYTE_ORDER;
+    h.sizeof_int      = sizeof(int);
+    h.sizeof_double   = sizeof(double);
+    h.dimensions      = G->dimensions;
+    h.number_of_cells = G->number_of_cells;
+    h.number_of_faces = G->number_of_faces;
+    h.number_of_nodes = G->number_of_nodes;
+    h.cartdims[0]     = G->cartdims[0];
+    h.cartdims[1]     = G->cartdims[1];
+    h.cartdims[2]     = G->cartdims[2];
+    h.key             = key;
+
+    array_counts(G->dimensions, G->number_of_cells,
+                 G->number_of_faces, G->number_of_nodes,
+                 G->face_nodepos[ G->number_of_faces ],
+                 G->cell_facepos[ G->number_of_cells ], h.count);
+
+    /* Shallow copy to get at the array pointers uniformly. */
+    g = *G;
+    array_pointers(&g, arrays);
+
+    pos = sizeof h;
+    for (a = 0; a < GB_NARRAYS; a++) {
+        if (*arrays[a] == NULL) {
+            /* Only global_cell and cell_facetag are optional. */
+            h.count[a] = 0;
+        }
+        else {
+            pos         = align(pos);
+            h.offset[a] = pos;
+            pos        += h.count[a] * element_size(a);
+        }
+    }
+
+    /* Write to temporary file, rename when complete ------------------- */
+    tmpname = malloc(strlen(fname) + sizeof ".tmp.XXXXXXXXXX");
+    if (tmpname == NULL) {
+        return 0;
+    }
+    sprintf(tmpname, "%s.tmp.%d", fname, (int) getpid());
+
+    fp = fopen(tmpname, "wb");
+    ok = fp != NULL;
+
+    if (ok) {
+        ok  = fwrite(&h, sizeof h, 1, fp) == 1;
+        pos = sizeof h;
+
+        for (a = 0; ok && (a < GB_NARRAYS); a++) {
+            if (h.offset[a] == 0) { continue; }
+
+            next = h.offset[a];
+            ok   = fwrite(zeros, 1, next - pos, fp) == next - pos;
+
+            if (ok) {
+                ok  = fwrite(*arrays[a], element_size(a), h.count[a], fp) == h.count[a];
+                pos = next + h.count[a] * element_size(a);
+            }
+        }
+
+        ok = (fclose(fp) == 0) && ok;
+        ok = ok && (rename(tmpname, fname) == 0);
+
+        if (! ok) {
+            remove(tmpname);
+        }
+    }
+
+    free(tmpname);
+
+    errno = save_errno;
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+valid_header(const struct grid_binary_header *h, uint64_t length)
+/* ---------------------------------------------------------------------- */
+{
+    uint64_t count[GB_NARRAYS];
+    int      a, ok;
+
+    ok = (length >= sizeof *h) &&
+        (memcmp(h->magic, GRID_BINARY_MAGIC, sizeof h->magic) == 0) &&
+        (h->version         == GRID_BINARY_VERSION)    &&
+        (h->byte_order      == GRID_BINARY_BYTE_ORDER) &&
+        (h->sizeof_int      == sizeof(int))            &&
+        (h->sizeof_double   == sizeof(double))         &&
+        (h->dimensions      >= 2) && (h->dimensions <= 3) &&
+        (h->number_of_cells >= 0) &&
+        (h->number_of_faces >= 0) &&
+        (h->number_of_nodes >= 0);
+
+    if (ok) {
+        array_counts(h->dimensions, h->number_of_cells,
+                     h->number_of_faces, h->number_of_nodes,
+                     h->count[GB_FACE_NODES], h->count[GB_CELL_FACES],
+                     count);
+    }
+
+    for (a = 0; ok && (a < GB_NARRAYS); a++) {
+        if (h->offset[a] == 0) {
+            ok = (h->count[a] == 0) &&
+                ((a == GB_GLOBAL_CELL) || (a == GB_CELL_FACETAG));
+        }
+        else {
+            ok = (h->count[a] == count[a])                    &&
+                (h->offset[a] >= sizeof *h)                    &&
+                ((h->offset[a] % GRID_BINARY_ALIGN) == 0)      &&
+                (h->offset[a] <= length)                       &&
+                (h->count[a] <= (length - h->offset[a]) / element_size(a));
+        }
+    }
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UnstructuredGrid *
+map_grid_binary(const char *fname, uint64_t *key)
+/* ---------------------------------------------------------------------- */
+{
+    const struct grid_binary_header *h;
+    struct mapped_grid              *m;
+    struct UnstructuredGrid         *G;
+    struct stat                      st;
+    void                           **arrays[GB_NARRAYS];
+    void                            *base;
+    size_t                           length;
+    int                              fd, a, ok, save_errno;
+
+    save_errno = errno;
+
+    G    = NULL;
+    base = MAP_FAILED;
+
+    fd = open(fname, O_RDONLY);
+    ok = fd >= 0;
+
+    ok = ok && (fstat(fd, &st) == 0) && (st.st_size >= (off_t) sizeof *h);
+
+    if (ok) {
+        length = st.st_size;
+        base   = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ok     = base != MAP_FAILED;
+    }
+
+    if (fd >= 0) {
+        /* The mapping stays valid after the descriptor is closed. */
+        close(fd);
+    }
+
+    if (ok) {
+        h  = base;
+        ok = valid_header(h, length);
+    }
+
+    if (ok) {
+        m  = malloc(1 * sizeof *m);
+        ok = m != NULL;
+    }
+
+    if (ok) {
+        memset(m, 0, sizeof *m);
+        m->base   = base;
+        m->length = length;
+
+        G = &m->grid;
+        G->dimensions      = h->dimensions;
+        G->number_of_cells = h->number_of_cells;
+        G->number_of_faces = h->number_of_faces;
+        G->number_of_nodes = h->number_of_nodes;
+        G->cartdims[0]     = h->cartdims[0];
+        G->cartdims[1]     = h->cartdims[1];
+        G->cartdims[2]     = h->cartdims[2];
+
+        array_pointers(G, arrays);
+        for (a = 0; a < GB_NARRAYS; a++) {
+            if (h->offset[a] != 0) {
+                *arrays[a] = (char *) base + h->offset[a];
+            }
+        }
+
+        /* Connectivity sizes must agree with the index arrays. */
+        ok = (G->face_nodepos[ G->number_of_faces ] == (int) h->count[GB_FACE_NODES]) &&
+            (G->cell_facepos[ G->number_of_cells ] == (int) h->count[GB_CELL_FACES]);
+
+        if (ok && (key != NULL)) {
+            *key = h->key;
+        }
+
+        if (! ok) {
+            free(m);
+            G = NULL;
+        }
+    }
+
+    if (!ok && (base != MAP_FAILED)) {
+        munmap(base, length);
+    }
+
+    errno = save_errno;
+
+    return G;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+unmap_grid_binary(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    struct mapped_grid *m;
+
+    if (G != NULL) {
+        m = (struct mapped_grid *) G;
+
+        munmap(m->base, m->length);
+        free(m);
+    }
+}
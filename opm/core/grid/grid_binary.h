@@ -0,0 +1,101 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_GRID_BINARY_H_HEADER
+#define OPM_GRID_BINARY_H_HEADER
+
+/**
+ * \file
+ * Binary serialisation of UnstructuredGrid.
+ *
+ * The file holds a fixed-size header followed by the grid arrays
+ * (topology, geometry, global_cell and cell_facetag), each stored in
+ * native byte order and aligned on an eight-byte boundary.  A grid is
+ * loaded by mapping the file into memory and pointing the grid arrays
+ * into the mapping, so no parsing or copying takes place.
+ *
+ * Files are only readable on machines with the byte order and integer
+ * sizes of the writer; other files, and files of another format
+ * version, are rejected.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
+/**
+ * Current version of the binary grid format.  Also increment this when
+ * corner-point processing or geometry computation changes, so that
+ * grids cached by an earlier version are no longer accepted.
+ */
+#define GRID_BINARY_VERSION 2
+
+/**
+ * Write grid to file in binary format.
+ *
+ * The file is first written under a temporary name and then renamed,
+ * so that concurrent readers never observe a partially written file.
+ *
+ * @param[in] G     Grid.
+ * @param[in] key   Arbitrary 64-bit tag stored in the header, e.g., a
+ *                  hash of the input from which the grid was built.
+ * @param[in] fname File name.
+ *
+ * @return One (1) if successful, zero (0) otherwise.
+ */
+int
+write_grid_binary(const struct UnstructuredGrid *G,
+                  uint64_t                       key,
+                  const char                    *fname);
+
+
+/**
+ * Map grid from binary file into memory.
+ *
+ * The mapping is private: the grid arrays may be modified, but changes
+ * are not written back to the file.
+ *
+ * @param[in]  fname File name.
+ * @param[out] key   Tag stored in file header.  Ignored if @c NULL.
+ *
+ * @return Grid whose arrays refer to the mapped file.  Must be released
+ * using function unmap_grid_binary(), not destroy_grid().  @c NULL if the
+ * file does not exist or is not a valid binary grid of this version.
+ */
+struct UnstructuredGrid *
+map_grid_binary(const char *fname, uint64_t *key);
+
+
+/**
+ * Release grid obtained from map_grid_binary().
+ *
+ * @param[in,out] G Grid.  May be @c NULL.
+ */
+void
+unmap_grid_binary(struct UnstructuredGrid *G);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPM_GRID_BINARY_H_HEADER */
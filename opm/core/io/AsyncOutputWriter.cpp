@@ -0,0 +1,298 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <opm/core/io/AsyncOutputWriter.hpp>
+
+#include <opm/core/simulator/BlackoilState.hpp>
+#include <opm/core/simulator/SimulatorState.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <stdexcept>
+#include <typeinfo>
+#include <utility>
+
+namespace Opm {
+
+namespace {
+
+/// Frozen copy of the values a timer reports at a given instant.
+/// Values that the source timer does not define at that instant
+/// (step length when done, step length taken before the first step)
+/// raise an error if they are asked for, as the original would.
+class TimerSnapshot : public SimulatorTimerInterface {
+public:
+    TimerSnapshot ()
+        : stepNum_ (0), reportStepNum_ (0)
+        , stepLength_ (0.0), stepLengthTaken_ (0.0), reportStepLengthTaken_ (0.0)
+        , elapsed_ (0.0), done_ (false)
+        , hasStepLength_ (false), hasStepLengthTaken_ (false)
+        , posixTime_ (0)
+    { }
+
+    void assign (const SimulatorTimerInterface& timer) {
+        stepNum_ = timer.currentStepNum ();
+        reportStepNum_ = timer.reportStepNum ();
+        done_ = timer.done ();
+        hasStepLength_ = !done_;
+        stepLength_ = hasStepLength_ ? timer.currentStepLength () : 0.0;
+        hasStepLengthTaken_ = stepNum_ > 0;
+        stepLengthTaken_ = hasStepLengthTaken_ ? timer.stepLengthTaken () : 0.0;
+        reportStepLengthTaken_ = (hasStepLengthTaken_ && reportStepNum_ > 0)
+            ? timer.reportStepLengthTaken () : stepLengthTaken_;
+        elapsed_ = timer.simulationTimeElapsed ();
+        startDateTime_ = timer.startDateTime ();
+        currentDateTime_ = timer.currentDateTime ();
+        posixTime_ = timer.currentPosixTime ();
+    }
+
+    virtual int currentStepNum () const { return stepNum_; }
+    virtual int reportStepNum () const { return reportStepNum_; }
+
+    virtual double currentStepLength () const {
+        if (!hasStepLength_) {
+            OPM_THROW(std::logic_error, "Step length requested from a finished timer");
+        }
+        return stepLength_;
+    }
+
+    virtual double stepLengthTaken () const {
+        if (!hasStepLengthTaken_) {
+            OPM_THROW(std::logic_error, "Step length taken requested before the first step");
+        }
+        return stepLengthTaken_;
+    }
+
+    virtual double reportStepLengthTaken () const {
+        if (!hasStepLengthTaken_) {
+            OPM_THROW(std::logic_error, "Report step length taken requested before the first step");
+        }
+        return reportStepLengthTaken_;
+    }
+
+    virtual double simulationTimeElapsed () const { return elapsed_; }
+
+    virtual void advance () {
+        OPM_THROW(std::logic_error, "Cannot advance a timer snapshot");
+    }
+
+    virtual bool done () const { return done_; }
+
+    virtual boost::posix_time::ptime startDateTime () const { return startDateTime_; }
+    virtual boost::posix_time::ptime currentDateTime () const { return currentDateTime_; }
+    virtual time_t currentPosixTime () const { return posixTime_; }
+
+private:
+    int stepNum_;
+    int reportStepNum_;
+    double stepLength_;
+    double stepLengthTaken_;
+    double reportStepLengthTaken_;
+    double elapsed_;
+    bool done_;
+    bool hasStepLength_;
+    bool hasStepLengthTaken_;
+    boost::posix_time::ptime startDateTime_;
+    boost::posix_time::ptime currentDateTime_;
+    time_t posixTime_;
+};
+
+/// Copy a reservoir state into a recycled buffer, keeping the dynamic
+/// type so that writers may still downcast to e.g. BlackoilState.
+void assignState (std::unique_ptr <SimulatorState>& dst,
+                  const SimulatorState& src) {
+    if (const BlackoilState* bo = dynamic_cast <const BlackoilState*> (&src)) {
+        BlackoilState* dst_bo = dynamic_cast <BlackoilState*> (dst.get ());
+        if (dst_bo) {
+            *dst_bo = *bo;
+        }
+        else {
+            dst.reset (new BlackoilState (*bo));
+        }
+    }
+    else {
+        if (dst && typeid (*dst) == typeid (SimulatorState)) {
+            *dst = src;
+        }
+        else {
+            dst.reset (new SimulatorState (src));
+        }
+    }
+}
+
+} // anonymous namespace
+
+/// One pending output request.
+struct AsyncOutputWriter::Snapshot {
+    bool init;
+    bool isSubstep;
+    TimerSnapshot timer;
+    std::unique_ptr <SimulatorState> state;
+    WellState wellState;
+};
+
+AsyncOutputWriter::AsyncOutputWriter (std::unique_ptr <OutputWriter> writer,
+                                      int queueDepth)
+    : writer_ (std::move (writer))
+    , queueDepth_ (queueDepth > 0 ? queueDepth : 1)
+    , busy_ (false)
+    , stop_ (false)
+{
+    worker_ = std::thread (&AsyncOutputWriter::run_, this);
+}
+
+AsyncOutputWriter::~AsyncOutputWriter () {
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all ();
+    worker_.join ();
+    // errors from the last steps cannot be reported from a destructor
+    if (error_) {
+        try {
+            std::rethrow_exception (error_);
+        }
+        catch (const std::exception& e) {
+            OPM_MESSAGE("Asynchronous output failed: " << e.what ());
+        }
+        catch (...) {
+            OPM_MESSAGE("Asynchronous output failed");
+        }
+    }
+}
+
+void
+AsyncOutputWriter::writeInit (const SimulatorTimerInterface &timer) {
+    SnapshotPtr s = acquire_ ();
+    s->init = true;
+    s->isSubstep = false;
+    s->timer.assign (timer);
+    submit_ (std::move (s));
+}
+
+void
+AsyncOutputWriter::writeTimeStep (const SimulatorTimerInterface& timer,
+                                  const SimulatorState& reservoirState,
+                                  const WellState& wellState,
+                                  bool  isSubstep) {
+    SnapshotPtr s = acquire_ ();
+    s->init = false;
+    s->isSubstep = isSubstep;
+    s->timer.assign (timer);
+    assignState (s->state, reservoirState);
+    s->wellState = wellState;
+    submit_ (std::move (s));
+}
+
+void
+AsyncOutputWriter::sync () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    changed_.wait (lock, [this] { return (pending_.empty () && !busy_) || error_; });
+    lock.unlock ();
+    rethrow_ ();
+}
+
+AsyncOutputWriter::SnapshotPtr
+AsyncOutputWriter::acquire_ () {
+    rethrow_ ();
+    std::unique_lock <std::mutex> lock (mutex_);
+    changed_.wait (lock, [this] { return pending_.size () < queueDepth_ || error_; });
+    if (error_) {
+        lock.unlock ();
+        rethrow_ ();
+    }
+    if (free_.empty ()) {
+        return SnapshotPtr (new Snapshot ());
+    }
+    SnapshotPtr s = std::move (free_.back ());
+    free_.pop_back ();
+    return s;
+}
+
+void
+AsyncOutputWriter::submit_ (SnapshotPtr snapshot) {
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        pending_.push_back (std::move (snapshot));
+    }
+    changed_.notify_all ();
+}
+
+void
+AsyncOutputWriter::rethrow_ () {
+    std::exception_ptr error;
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        std::swap (error, error_);
+    }
+    if (error) {
+        std::rethrow_exception (error);
+    }
+}
+
+void
+AsyncOutputWriter::run_ () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    for (;;) {
+        changed_.wait (lock, [this] { return !pending_.empty () || stop_; });
+        if (pending_.empty ()) {
+            // stop requested and everything written
+            return;
+        }
+
+        SnapshotPtr s = std::move (pending_.front ());
+        pending_.pop_front ();
+        busy_ = true;
+        lock.unlock ();
+
+        std::exception_ptr error;
+        try {
+            if (s->init) {
+                writer_->writeInit (s->timer);
+            }
+            else {
+                writer_->writeTimeStep (s->timer, *s->state, s->wellState, s->isSubstep);
+            }
+        }
+        catch (...) {
+            error = std::current_exception ();
+        }
+
+        lock.lock ();
+        busy_ = false;
+        if (error) {
+            // output is sequential; drop whatever was queued after
+            // the failing step and let the producer see the error
+            if (!error_) {
+                error_ = error;
+            }
+            while (!pending_.empty ()) {
+                free_.push_back (std::move (pending_.front ()));
+                pending_.pop_front ();
+            }
+        }
+        free_.push_back (std::move (s));
+        changed_.notify_all ();
+    }
+}
+
+} // namespace Opm
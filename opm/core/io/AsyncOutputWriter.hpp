@@ -0,0 +1,106 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_ASYNC_OUTPUT_WRITER_HPP
+#define OPM_ASYNC_OUTPUT_WRITER_HPP
+
+#include <opm/core/io/OutputWriter.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * Output writer decorator which moves the actual file output to a
+ * background thread.
+ *
+ * Each call to writeInit() or writeTimeStep() takes a snapshot of the
+ * timer, reservoir state and well state and hands it to a worker
+ * thread, which forwards it to the wrapped writer.  The simulator may
+ * therefore start on the next time step while the previous one is
+ * being converted and written.  Snapshots are recycled, so that the
+ * state buffers are only allocated once.
+ *
+ * At most queueDepth snapshots are pending at any time; if the
+ * simulator produces output faster than it can be written, the
+ * producing call blocks until a slot is available.  Use sync() to
+ * wait for all pending output to reach the wrapped writer.
+ *
+ * All calls into the wrapped writer are made from the worker thread
+ * and in submission order, so the wrapped writer need not be thread
+ * safe.  An exception thrown by the wrapped writer is rethrown from
+ * the next call to writeInit(), writeTimeStep() or sync().
+ */
+class AsyncOutputWriter : public OutputWriter {
+public:
+    /// Take ownership of the writer that does the actual output.
+    /// \param[in] writer      Writer receiving the snapshots.
+    /// \param[in] queueDepth  Maximum number of pending snapshots, at least one.
+    AsyncOutputWriter (std::unique_ptr <OutputWriter> writer,
+                       int queueDepth);
+
+    /// Write all pending output and stop the worker thread.
+    virtual ~AsyncOutputWriter ();
+
+    virtual void writeInit(const SimulatorTimerInterface &timer);
+
+    virtual void writeTimeStep(const SimulatorTimerInterface& timer,
+                               const SimulatorState& reservoirState,
+                               const WellState& wellState,
+                               bool  isSubstep);
+
+    /// Block until all pending output has been written.
+    virtual void sync ();
+
+private:
+    struct Snapshot;
+    typedef std::unique_ptr <Snapshot> SnapshotPtr;
+
+    /// Get a free snapshot, waiting for queue space if necessary.
+    SnapshotPtr acquire_ ();
+    /// Queue a filled snapshot for the worker.
+    void submit_ (SnapshotPtr snapshot);
+    /// Rethrow the first failure of the worker, if any.
+    void rethrow_ ();
+    /// Worker thread main loop.
+    void run_ ();
+
+    std::unique_ptr <OutputWriter> writer_;
+    const std::size_t queueDepth_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque <SnapshotPtr> pending_;
+    std::vector <SnapshotPtr> free_;
+    bool busy_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    std::thread worker_;
+};
+
+} // namespace Opm
+
+#endif /* OPM_ASYNC_OUTPUT_WRITER_HPP */
@@ -1,6 +1,7 @@
 #include "OutputWriter.hpp"
 
 #include <opm/core/grid.h>
+#include <opm/core/io/AsyncOutputWriter.hpp>
 #include <opm/core/io/eclipse/EclipseWriter.hpp>
 #include <opm/core/utility/parameters/Parameter.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
@@ -41,6 +42,12 @@ struct MultiWriter : public OutputWriter {
         }
     }
 
+    virtual void sync() {
+        for (it_t it = writers_->begin (); it != writers_->end(); ++it) {
+            (*it)->sync ();
+        }
+    }
+
 private:
     ptr_t writers_;
 };
@@ -99,5 +106,12 @@ OutputWriter::create (const ParameterGroup& params,
     }
 
     // create a multiplexer from the list of formats we found
-    return unique_ptr <OutputWriter> (new MultiWriter (std::move (list)));
+    unique_ptr <OutputWriter> writer (new MultiWriter (std::move (list)));
+
+    // optionally move the file output off the simulator thread
+    if (params.getDefault <bool> ("output_async", false)) {
+        const int depth = params.getDefault <int> ("output_queue_depth", 2);
+        writer.reset (new AsyncOutputWriter (std::move (writer), depth));
+    }
+    return writer;
 }
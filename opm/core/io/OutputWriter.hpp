@@ -56,6 +56,9 @@ struct PhaseUsage;
  *  // after each timestep
  *  writer->writeTimeStep (timer, state, wellState);
  *
+ *  // before reading back any of the files written
+ *  writer->sync ();
+ *
  * \endcode
  */
 class OutputWriter {
@@ -91,6 +94,14 @@ public:
                                const WellState& wellState,
                                bool  isSubstep) = 0;
 
+    /*!
+     * \brief Block until all output requested so far has been written.
+     *
+     * Writers that do their work in the calling thread need not
+     * override this; it is a no-op by default.
+     */
+    virtual void sync() { }
+
     /*!
      * Create a suitable set of output formats based on configuration.
      *
@@ -102,6 +113,10 @@ public:
      *
      * @param eclipseState The internalized input deck.
      *
+     * If the parameter output_async is true, the writers run in a
+     * background thread (see AsyncOutputWriter), with at most
+     * output_queue_depth (default 2) time steps pending.
+     *
      * @return       Pointer to a multiplexer to all applicable output formats.
      *
      * @see Opm::share_obj
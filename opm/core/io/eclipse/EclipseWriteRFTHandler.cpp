@@ -26,6 +26,7 @@
 #include <opm/core/props/BlackoilPhases.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/common/ErrorMacros.hpp>
 
 
 #include <opm/parser/eclipse/EclipseState/Schedule/CompletionSet.hpp>
@@ -37,16 +38,28 @@
 
 #include <ert/ecl/ecl_rft_node.h>
 #include <ert/ecl/ecl_rft_file.h>
+#include <ert/ecl/fortio.h>
+#include <ert/util/util.h>
+
+#include <stdexcept>
 
 
 
 namespace Opm {
 namespace EclipseWriterDetails {
 
-    EclipseWriteRFTHandler::EclipseWriteRFTHandler(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize) {
+    EclipseWriteRFTHandler::EclipseWriteRFTHandler(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize)
+        : fortio_(NULL)
+    {
         initGlobalToActiveIndex(compressedToCartesianCellIdx, numCells, cartesianSize);
     }
 
+    EclipseWriteRFTHandler::~EclipseWriteRFTHandler() {
+        if (fortio_) {
+            fortio_fclose(fortio_);
+        }
+    }
+
     void EclipseWriteRFTHandler::writeTimeStep(const std::string& filename,
                                                const ert_ecl_unit_enum ecl_unit,
                                                const SimulatorTimerInterface& simulatorTimer,
@@ -58,10 +71,28 @@ namespace EclipseWriterDetails {
 
 
 
-        std::vector<ecl_rft_node_type *> rft_nodes;
+        const int reportStep = simulatorTimer.reportStepNum();
+        const time_t date = simulatorTimer.currentPosixTime();
+        bool written = false;
         for (std::vector<WellConstPtr>::const_iterator ci = wells.begin(); ci != wells.end(); ++ci) {
             WellConstPtr well = *ci;
-            if ((well->getRFTActive(simulatorTimer.reportStepNum())) || (well->getPLTActive(simulatorTimer.reportStepNum()))) {
+            if ((well->getRFTActive(reportStep)) || (well->getPLTActive(reportStep))) {
+                // The file is opened on the first record, so that runs
+                // without RFT requests do not leave an empty file behind.
+                if (fortio_ && (filename != filename_)) {
+                    fortio_fclose(fortio_);
+                    fortio_ = NULL;
+                }
+                if (!fortio_) {
+                    openFile(filename, ecl_unit, date);
+                }
+
+                // The last substep of a report step and the report step
+                // itself share the same time; keep only the first record.
+                if (!written_.insert(std::make_pair(well->name(), date)).second) {
+                    continue;
+                }
+
                 ecl_rft_node_type * ecl_node = createEclRFTNode(well,
                                                                  simulatorTimer,
                                                                  eclipseGrid,
@@ -71,21 +102,56 @@ namespace EclipseWriterDetails {
 
                 // TODO: replace this silenced warning with an appropriate
                 //       use of the OpmLog facilities.
-                // if (well->getPLTActive(simulatorTimer.reportStepNum())) {
+                // if (well->getPLTActive(reportStep)) {
                 //     std::cerr << "PLT not supported, writing RFT data" << std::endl;
                 // }
 
-                rft_nodes.push_back(ecl_node);
+                ecl_rft_node_fwrite(ecl_node, fortio_, ecl_unit);
+                ecl_rft_node_free(ecl_node);
+                written = true;
             }
         }
 
+        // Records are appended in time order; flush so that the file is
+        // complete on disk after every step.
+        if (written) {
+            fortio_fflush(fortio_);
+        }
+    }
+
 
-        if (rft_nodes.size() > 0) {
-            ecl_rft_file_update(filename.c_str(), rft_nodes.data(), rft_nodes.size(), ecl_unit);
+    void EclipseWriteRFTHandler::openFile(const std::string& filename,
+                                          const ert_ecl_unit_enum ecl_unit,
+                                          const time_t date) {
+        // An existing file is left over from an earlier run, e.g. the
+        // one being restarted.  Its records before the current time are
+        // kept; the later ones are superseded by this run.
+        ecl_rft_file_type * previous = NULL;
+        if (util_file_exists(filename.c_str())) {
+            previous = ecl_rft_file_alloc(filename.c_str());
         }
 
-        //Cleanup: The ecl_rft_file_update method takes care of freeing the ecl_rft_nodes that it receives.
-        //         Each ecl_rft_node is again responsible for freeing it's cells.
+        fortio_ = fortio_open_writer(filename.c_str(), /*fmt_file=*/false, ECL_ENDIAN_FLIP);
+        if (!fortio_) {
+            if (previous) {
+                ecl_rft_file_free(previous);
+            }
+            OPM_THROW(std::runtime_error, "Could not open RFT file '" << filename << "'");
+        }
+        filename_ = filename;
+        written_.clear();
+
+        if (previous) {
+            for (int index = 0; index < ecl_rft_file_get_size(previous); ++index) {
+                ecl_rft_node_type * ecl_node = ecl_rft_file_iget_node(previous, index);
+                const time_t node_date = ecl_rft_node_get_date(ecl_node);
+                if (node_date < date) {
+                    ecl_rft_node_fwrite(ecl_node, fortio_, ecl_unit);
+                    written_.insert(std::make_pair(std::string(ecl_rft_node_get_well_name(ecl_node)), node_date));
+                }
+            }
+            ecl_rft_file_free(previous);
+        }
     }
 
 
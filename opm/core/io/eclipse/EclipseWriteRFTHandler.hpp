@@ -28,6 +28,12 @@
 
 #include <ert/ecl/ecl_rft_node.h>
 #include <ert/ecl/ecl_util.h>
+#include <ert/ecl/fortio.h>
+
+#include <ctime>
+#include <set>
+#include <string>
+#include <utility>
 
 
 namespace Opm {
@@ -42,7 +48,15 @@ namespace EclipseWriterDetails {
     public:
     EclipseWriteRFTHandler(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize);
 
+    /// Closes the RFT file, if one was opened.
+    ~EclipseWriteRFTHandler();
 
+    /// Append RFT records for the wells requesting RFT or PLT output at
+    /// the current report step. The file is opened on the first record
+    /// written and then kept open, and flushed after each step, until
+    /// the handler is destroyed. Records of an existing file dated
+    /// before the first record are kept. A well is written at most
+    /// once per date.
     void writeTimeStep(const std::string& filename,
                        const ert_ecl_unit_enum ecl_unit,
                        const SimulatorTimerInterface& simulatorTimer,
@@ -63,9 +77,19 @@ namespace EclipseWriterDetails {
                                          const std::vector<double>& swat,
                                          const std::vector<double>& sgas);
 
+    void openFile(const std::string& filename,
+                  const ert_ecl_unit_enum ecl_unit,
+                  const time_t date);
+
     void initGlobalToActiveIndex(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize);
 
     std::vector<int> globalToActiveIndex_;
+    fortio_type * fortio_;
+    std::string filename_;
+    std::set<std::pair<std::string, time_t>> written_;
+
+    EclipseWriteRFTHandler(const EclipseWriteRFTHandler&) = delete;
+    EclipseWriteRFTHandler& operator=(const EclipseWriteRFTHandler&) = delete;
 
     };
 
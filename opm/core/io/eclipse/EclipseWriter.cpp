@@ -1358,31 +1358,29 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
     }
 
 
-    //Write RFT data for current timestep to RFT file
-    std::shared_ptr<EclipseWriterDetails::EclipseWriteRFTHandler> eclipseWriteRFTHandler = std::make_shared<EclipseWriterDetails::EclipseWriteRFTHandler>(
-                                                                                                                      compressedToCartesianCellIdx_,
-                                                                                                                      numCells_,
-                                                                                                                      eclipseState_->getEclipseGrid()->getCartesianSize());
-
-    // Write RFT file.
-    {
-        char * rft_filename = ecl_util_alloc_filename(outputDir_.c_str(),
-                                                      baseName_.c_str(),
-                                                      ECL_RFT_FILE,
-                                                      ioConfig->getFMTOUT(),
-                                                      0);
+    // Write RFT file, for the wells requesting it at this report step.
+    // The set of such wells only changes with the report step.
+    if (rftWellsStep_ != timer.reportStepNum()) {
+        rftWellsStep_ = timer.reportStepNum();
+        rftWells_.clear();
+        const auto& wells = eclipseState_->getSchedule()->getWells(rftWellsStep_);
+        for (const auto& well : wells) {
+            if (well->getRFTActive(rftWellsStep_) || well->getPLTActive(rftWellsStep_)) {
+                rftWells_.push_back(well);
+            }
+        }
+    }
+    if (!rftWells_.empty()) {
         auto unit_type = eclipseState_->getDeckUnitSystem().getType();
         ert_ecl_unit_enum ecl_unit = convertUnitTypeErtEclUnitEnum(unit_type);
-        std::vector<WellConstPtr> wells = eclipseState_->getSchedule()->getWells(timer.reportStepNum());
-        eclipseWriteRFTHandler->writeTimeStep(rft_filename,
-                                              ecl_unit,
-                                              timer,
-                                              wells,
-                                              eclipseState_->getEclipseGrid(),
-                                              pressure,
-                                              saturation_water,
-                                              saturation_gas);
-        free( rft_filename );
+        rftHandler_->writeTimeStep(rftFileName_,
+                                   ecl_unit,
+                                   timer,
+                                   rftWells_,
+                                   eclipseState_->getEclipseGrid(),
+                                   pressure,
+                                   saturation_water,
+                                   saturation_gas);
     }
 
     /* Summary variables (well reporting) */
@@ -1481,6 +1479,7 @@ void EclipseWriter::init(const parameter::ParameterGroup& params)
     // set the index of the first time step written to 0...
     writeStepIdx_  = 0;
     reportStepIdx_ = -1;
+    rftWellsStep_  = -1;
 
     if (enableOutput_) {
         // make sure that the output directory exists, if not try to create it
@@ -1494,6 +1493,20 @@ void EclipseWriter::init(const parameter::ParameterGroup& params)
                       "The path specified as output directory '" << outputDir_
                       << "' is not a directory");
         }
+
+        // the RFT index maps and file name do not change during the run
+        rftHandler_.reset(new EclipseWriterDetails::EclipseWriteRFTHandler(
+                              compressedToCartesianCellIdx_,
+                              numCells_,
+                              eclipseState_->getEclipseGrid()->getCartesianSize()));
+
+        char * rft_filename = ecl_util_alloc_filename(outputDir_.c_str(),
+                                                      baseName_.c_str(),
+                                                      ECL_RFT_FILE,
+                                                      eclipseState_->getIOConfigConst()->getFMTOUT(),
+                                                      0);
+        rftFileName_ = rft_filename;
+        free(rft_filename);
     }
 }
 
@@ -45,6 +45,7 @@ namespace Opm {
 // forward declarations
 namespace EclipseWriterDetails {
 class Summary;
+class EclipseWriteRFTHandler;
 }
 
 class SimulatorState;
@@ -126,6 +127,10 @@ private:
     std::string baseName_;
     PhaseUsage phaseUsage_; // active phases in the input deck
     std::shared_ptr<EclipseWriterDetails::Summary> summary_;
+    std::unique_ptr<EclipseWriterDetails::EclipseWriteRFTHandler> rftHandler_;
+    std::string rftFileName_;
+    int rftWellsStep_;                  // report step of rftWells_
+    std::vector<WellConstPtr> rftWells_; // wells requesting RFT output then
 
     void init(const parameter::ParameterGroup& params);
 };
@@ -25,11 +25,20 @@
 #include <boost/lexical_cast.hpp>
 #include <set>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <sstream>
 #include <vector>
 
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 
 
 namespace Opm
@@ -315,5 +324,329 @@ namespace Opm
         }
     }
 
-} // namespace Opm
 
+
+    VtkDataFormat vtkDataFormatFromString(const std::string& name)
+    {
+        if (name == "ascii") {
+            return VtkAscii;
+        } else if (name == "binary") {
+            return VtkBinary;
+        } else if (name == "compressed") {
+            return VtkBinaryCompressed;
+        }
+        OPM_THROW(std::runtime_error, "Unknown Vtk data format: " << name);
+    }
+
+
+    namespace
+    {
+        /// Data array in the appended data section of a .vtu file.
+        struct AppendedArray
+        {
+            std::string name;
+            std::string type;
+            int num_comps;
+            std::string block;  // Size header(s) followed by the data.
+        };
+
+        bool littleEndian()
+        {
+            const std::uint16_t one = 1;
+            return *reinterpret_cast<const unsigned char*>(&one) == 1;
+        }
+
+        // Encode an array in the raw appended format with UInt64 headers:
+        // uncompressed, the data size followed by the data; compressed,
+        // [#blocks, block size, size of partial last block, compressed
+        // size of each block] followed by the compressed blocks.
+        template <typename T>
+        AppendedArray appendedArray(const std::string& name,
+                                    const std::string& type,
+                                    const int num_comps,
+                                    const std::vector<T>& values,
+                                    const bool compress)
+        {
+            AppendedArray a;
+            a.name = name;
+            a.type = type;
+            a.num_comps = num_comps;
+            const char* data = values.empty() ? 0 : reinterpret_cast<const char*>(&values[0]);
+            const std::uint64_t num_bytes = values.size()*sizeof(T);
+#if HAVE_ZLIB
+            if (compress) {
+                const std::uint64_t block_size = 1 << 15;
+                const std::uint64_t num_blocks = (num_bytes + block_size - 1)/block_size;
+                std::vector<std::uint64_t> header(3 + num_blocks);
+                header[0] = num_blocks;
+                header[1] = block_size;
+                header[2] = num_bytes % block_size;
+                std::string compressed;
+                std::vector<Bytef> buf(compressBound(block_size));
+                for (std::uint64_t b = 0; b < num_blocks; ++b) {
+                    const std::uint64_t size = std::min(block_size, num_bytes - b*block_size);
+                    uLongf len = buf.size();
+                    if (compress2(&buf[0], &len, reinterpret_cast<const Bytef*>(data + b*block_size),
+                                  size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+                        OPM_THROW(std::runtime_error, "Compression of Vtk data array " << name << " failed");
+                    }
+                    header[3 + b] = len;
+                    compressed.append(reinterpret_cast<const char*>(&buf[0]), len);
+                }
+                a.block.assign(reinterpret_cast<const char*>(&header[0]), header.size()*sizeof(std::uint64_t));
+                a.block += compressed;
+                return a;
+            }
+#else
+            static_cast<void>(compress);
+#endif
+            a.block.assign(reinterpret_cast<const char*>(&num_bytes), sizeof(num_bytes));
+            a.block.append(data, num_bytes);
+            return a;
+        }
+
+        // Points and cell arrays of a grid, as polyhedral (type 42) cells.
+        void gridArrays(const UnstructuredGrid& grid,
+                        const bool compress,
+                        std::vector<AppendedArray>& points,
+                        std::vector<AppendedArray>& cells)
+        {
+            const int num_pts = grid.number_of_nodes;
+            const int num_cells = grid.number_of_cells;
+            std::vector<double> coords(grid.node_coordinates, grid.node_coordinates + 3*num_pts);
+            points.push_back(appendedArray("Coordinates", "Float64", 3, coords, compress));
+
+            std::vector<std::int32_t> connectivity;
+            std::vector<std::int32_t> offsets;
+            std::vector<std::int32_t> faces;
+            std::vector<std::int32_t> faceoffsets;
+            offsets.reserve(num_cells);
+            faceoffsets.reserve(num_cells);
+            std::vector<int> cell_pts;
+            for (int c = 0; c < num_cells; ++c) {
+                cell_pts.clear();
+                faces.push_back(grid.cell_facepos[c+1] - grid.cell_facepos[c]);
+                for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c+1]; ++hf) {
+                    const int f = grid.cell_faces[hf];
+                    const int* fnbeg = grid.face_nodes + grid.face_nodepos[f];
+                    const int* fnend = grid.face_nodes + grid.face_nodepos[f+1];
+                    cell_pts.insert(cell_pts.end(), fnbeg, fnend);
+                    faces.push_back(fnend - fnbeg);
+                    faces.insert(faces.end(), fnbeg, fnend);
+                }
+                std::sort(cell_pts.begin(), cell_pts.end());
+                cell_pts.erase(std::unique(cell_pts.begin(), cell_pts.end()), cell_pts.end());
+                connectivity.insert(connectivity.end(), cell_pts.begin(), cell_pts.end());
+                offsets.push_back(connectivity.size());
+                faceoffsets.push_back(faces.size());
+            }
+            const std::vector<std::uint8_t> types(num_cells, 42);
+            cells.push_back(appendedArray("connectivity", "Int32", 1, connectivity, compress));
+            cells.push_back(appendedArray("offsets", "Int32", 1, offsets, compress));
+            cells.push_back(appendedArray("faces", "Int32", 1, faces, compress));
+            cells.push_back(appendedArray("faceoffsets", "Int32", 1, faceoffsets, compress));
+            cells.push_back(appendedArray("types", "UInt8", 1, types, compress));
+        }
+
+        // Write DataArray tags referring to the appended data section,
+        // and collect the arrays in order of appearance.
+        void appendedTags(const std::vector<AppendedArray>& arrays,
+                          std::vector<const AppendedArray*>& appended,
+                          std::uint64_t& offset,
+                          std::ostream& os)
+        {
+            PMap pm;
+            pm["format"] = "appended";
+            for (std::size_t i = 0; i < arrays.size(); ++i) {
+                pm["Name"] = arrays[i].name;
+                pm["type"] = arrays[i].type;
+                pm["NumberOfComponents"] = boost::lexical_cast<std::string>(arrays[i].num_comps);
+                pm["offset"] = boost::lexical_cast<std::string>(offset);
+                Tag t("DataArray", pm, os);
+                offset += arrays[i].block.size();
+                appended.push_back(&arrays[i]);
+            }
+        }
+
+        void writeAppendedVtu(const UnstructuredGrid& grid,
+                              const std::vector<AppendedArray>& points,
+                              const std::vector<AppendedArray>& cells,
+                              const DataMap& data,
+                              const bool compress,
+                              std::ostream& os)
+        {
+            const int num_cells = grid.number_of_cells;
+            std::vector<AppendedArray> cell_data;
+            std::vector<double> field_copy;
+            for (DataMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
+                const std::vector<double>& field = *(dit->second);
+                const int num_comps = field.size()/num_cells;
+                field_copy.assign(field.begin(), field.begin() + num_cells*num_comps);
+                for (std::size_t i = 0; i < field_copy.size(); ++i) {
+                    if (std::fabs(field_copy[i]) < std::numeric_limits<double>::min()) {
+                        // Avoiding denormal numbers to work around
+                        // bug in Paraview.
+                        field_copy[i] = 0.0;
+                    }
+                }
+                cell_data.push_back(appendedArray(dit->first, "Float64", num_comps, field_copy, compress));
+            }
+
+            std::vector<const AppendedArray*> appended;
+            std::uint64_t offset = 0;
+            os << "<?xml version=\"1.0\"?>\n";
+            PMap pm;
+            pm["type"] = "UnstructuredGrid";
+            pm["version"] = "1.0";
+            pm["byte_order"] = littleEndian() ? "LittleEndian" : "BigEndian";
+            pm["header_type"] = "UInt64";
+#if HAVE_ZLIB
+            if (compress) {
+                pm["compressor"] = "vtkZLibDataCompressor";
+            }
+#endif
+            Tag vtkfiletag("VTKFile", pm, os);
+            {
+                Tag ugtag("UnstructuredGrid", os);
+                pm.clear();
+                pm["NumberOfPoints"] = boost::lexical_cast<std::string>(grid.number_of_nodes);
+                pm["NumberOfCells"] = boost::lexical_cast<std::string>(num_cells);
+                Tag piecetag("Piece", pm, os);
+                {
+                    Tag pointstag("Points", os);
+                    appendedTags(points, appended, offset, os);
+                }
+                {
+                    Tag cellstag("Cells", os);
+                    appendedTags(cells, appended, offset, os);
+                }
+                {
+                    pm.clear();
+                    if (data.find("saturation") != data.end()) {
+                        pm["Scalars"] = "saturation";
+                    } else if (data.find("pressure") != data.end()) {
+                        pm["Scalars"] = "pressure";
+                    }
+                    Tag celldatatag("CellData", pm, os);
+                    appendedTags(cell_data, appended, offset, os);
+                }
+            }
+            Tag::indent(os);
+            os << "<AppendedData encoding=\"raw\">\n";
+            Tag::indent(os);
+            os << '_';
+            for (std::size_t i = 0; i < appended.size(); ++i) {
+                os.write(appended[i]->block.data(), appended[i]->block.size());
+            }
+            os << '\n';
+            Tag::indent(os);
+            os << "</AppendedData>\n";
+        }
+
+    } // anonymous namespace
+
+
+    void writeVtkData(const UnstructuredGrid& grid,
+                      const DataMap& data,
+                      std::ostream& os,
+                      VtkDataFormat format)
+    {
+        if (format == VtkAscii) {
+            writeVtkData(grid, data, os);
+            return;
+        }
+        if (grid.dimensions != 3) {
+            OPM_THROW(std::runtime_error, "Vtk output for 3d grids only");
+        }
+        const bool compress = (format == VtkBinaryCompressed);
+        std::vector<AppendedArray> points;
+        std::vector<AppendedArray> cells;
+        gridArrays(grid, compress, points, cells);
+        writeAppendedVtu(grid, points, cells, data, compress, os);
+    }
+
+
+    /// Encoded grid arrays, kept between steps.
+    struct VtkSeriesWriter::Geometry
+    {
+        std::vector<AppendedArray> points;
+        std::vector<AppendedArray> cells;
+    };
+
+
+    VtkSeriesWriter::VtkSeriesWriter(const UnstructuredGrid& grid,
+                                     const std::string& dir,
+                                     const std::string& basename,
+                                     VtkDataFormat format)
+        : grid_(grid),
+          dir_(dir),
+          basename_(basename),
+          format_(format)
+    {
+        if (grid.dimensions != 3) {
+            OPM_THROW(std::runtime_error, "Vtk output for 3d grids only");
+        }
+    }
+
+
+    VtkSeriesWriter::~VtkSeriesWriter()
+    {
+    }
+
+
+    void VtkSeriesWriter::write(const DataMap& data, int step, double time)
+    {
+        std::ostringstream name;
+        name << basename_ << "-" << std::setw(3) << std::setfill('0') << step << ".vtu";
+        const std::string vtkfilename = dir_ + "/" + name.str();
+        {
+            std::ofstream vtkfile(vtkfilename.c_str(), std::ios::out | std::ios::binary);
+            if (!vtkfile) {
+                OPM_THROW(std::runtime_error, "Failed to open " << vtkfilename);
+            }
+            if (format_ == VtkAscii) {
+                writeVtkData(grid_, data, vtkfile);
+            } else {
+                const bool compress = (format_ == VtkBinaryCompressed);
+                if (!geometry_) {
+                    geometry_.reset(new Geometry);
+                    gridArrays(grid_, compress, geometry_->points, geometry_->cells);
+                }
+                writeAppendedVtu(grid_, geometry_->points, geometry_->cells, data, compress, vtkfile);
+            }
+            if (!vtkfile) {
+                OPM_THROW(std::runtime_error, "Failed writing " << vtkfilename);
+            }
+        }
+
+        // Rewrite the collection file, replacing an earlier entry for
+        // the same file if the step is written again.
+        std::vector<std::pair<double, std::string> >::iterator it = steps_.begin();
+        while (it != steps_.end() && it->second != name.str()) {
+            ++it;
+        }
+        if (it == steps_.end()) {
+            steps_.push_back(std::make_pair(time, name.str()));
+        } else {
+            it->first = time;
+        }
+        const std::string pvdfilename = dir_ + "/" + basename_ + ".pvd";
+        std::ofstream pvdfile(pvdfilename.c_str());
+        if (!pvdfile) {
+            OPM_THROW(std::runtime_error, "Failed to open " << pvdfilename);
+        }
+        pvdfile.precision(16);
+        pvdfile << "<?xml version=\"1.0\"?>\n";
+        PMap pm;
+        pm["type"] = "Collection";
+        pm["version"] = "0.1";
+        Tag vtkfiletag("VTKFile", pm, pvdfile);
+        Tag collectiontag("Collection", pvdfile);
+        for (std::size_t i = 0; i < steps_.size(); ++i) {
+            Tag::indent(pvdfile);
+            pvdfile << "<DataSet timestep=\"" << steps_[i].first
+                    << "\" group=\"\" part=\"0\" file=\"" << steps_[i].second << "\"/>\n";
+        }
+    }
+
+} // namespace Opm
@@ -26,6 +26,8 @@
 #include <vector>
 #include <array>
 #include <iosfwd>
+#include <memory>
+#include <utility>
 #include <opm/core/utility/DataMap.hpp>
 
 struct UnstructuredGrid;
@@ -43,6 +45,62 @@ namespace Opm
     void writeVtkData(const UnstructuredGrid& grid,
                       const DataMap& data,
                       std::ostream& os);
+
+    /// Encoding of the data arrays in Vtk (.vtu) output for general grids.
+    enum VtkDataFormat {
+        VtkAscii,            //!< Inline ascii text.
+        VtkBinary,           //!< Raw binary data appended to the file.
+        VtkBinaryCompressed  //!< As VtkBinary, but zlib compressed. Written
+                             //!< as VtkBinary if built without zlib.
+    };
+
+    /// Parse a data format name: "ascii", "binary" or "compressed".
+    VtkDataFormat vtkDataFormatFromString(const std::string& name);
+
+    /// Vtk output for general grids, with a given data encoding.
+    /// The stream should be opened in binary mode for the binary formats.
+    void writeVtkData(const UnstructuredGrid& grid,
+                      const DataMap& data,
+                      std::ostream& os,
+                      VtkDataFormat format);
+
+    /// Vtk output of a time series on a fixed general grid.
+    /// Each step is written to its own .vtu file, and a .pvd collection
+    /// file listing all steps written so far is kept up to date, so that
+    /// the series can be opened as one data set with time information.
+    /// With the binary formats, the grid arrays are encoded once and
+    /// reused for every step.
+    class VtkSeriesWriter
+    {
+    public:
+        /// \param[in] grid      Grid of all steps. Must outlive the writer.
+        /// \param[in] dir       Existing output directory.
+        /// \param[in] basename  Steps are written to <dir>/<basename>-<step>.vtu,
+        ///                      with step numbers padded to three digits,
+        ///                      and the collection to <dir>/<basename>.pvd.
+        /// \param[in] format    Data encoding.
+        VtkSeriesWriter(const UnstructuredGrid& grid,
+                        const std::string& dir,
+                        const std::string& basename,
+                        VtkDataFormat format);
+        ~VtkSeriesWriter();
+
+        /// Write data of one step, and update the collection file.
+        /// \param[in] data  Cell data to write.
+        /// \param[in] step  Step number, used in the file name.
+        /// \param[in] time  Simulation time of the step.
+        void write(const DataMap& data, int step, double time);
+
+    private:
+        struct Geometry;
+
+        const UnstructuredGrid& grid_;
+        std::string dir_;
+        std::string basename_;
+        VtkDataFormat format_;
+        std::unique_ptr<Geometry> geometry_;
+        std::vector<std::pair<double, std::string> > steps_;
+    };
 } // namespace Opm
 
 #endif // OPM_WRITEVTKDATA_HEADER_INCLUDED
@@ -38,11 +38,15 @@ namespace Opm
         /// Struct for reporting data about the solution process back
         /// to the caller. The only field that is mandatory to set is
         /// 'converged' (even for direct solvers) to indicate success.
+        /// The timings are zero unless measured by the solver.
         struct LinearSolverReport
         {
             bool converged;
             int iterations;
             double residual_reduction;
+            double setup_time = 0.0;    // seconds spent setting up the preconditioner
+            double solve_time = 0.0;    // seconds spent in the iterative solve
+            int preconditioner_setups = 0;  // preconditioners set up by the solve
         };
 
         /// Solve a linear system, with a matrix given in compressed sparse row format.
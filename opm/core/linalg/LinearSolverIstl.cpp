@@ -24,6 +24,7 @@
 
 #include <opm/core/linalg/LinearSolverIstl.hpp>
 #include <opm/core/linalg/ParallelIstlInformation.hpp>
+#include <opm/core/utility/StopWatch.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 // Silence compatibility warning from DUNE headers since we don't use
@@ -53,9 +54,13 @@
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Opm
 {
@@ -92,10 +97,78 @@ namespace Opm
         template<class O, class S, class C>
         LinearSolverInterface::LinearSolverReport
         solveBiCGStab_ILU0(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity);
+
+        typedef Dune::Preconditioner<Vector, Vector> SeqPreconditioner;
+
+        void copyCsrToBcrs(const int size, const int* ia, const int* ja, const double* sa, Mat& A);
+
+        std::shared_ptr<SeqPreconditioner>
+        makeSeqAMG(Operator& opA, const Dune::Amg::SequentialInformation& comm, int verbosity,
+                   double prolongateFactor, int smoothsteps);
     } // anonymous namespace
 
 
 
+    /// Matrix, operator and preconditioner kept between solves with
+    /// an unchanged sparsity pattern.
+    struct LinearSolverIstl::PatternReuse
+    {
+        PatternReuse(const int size, const int nonzeros, const int* ia_in, const int* ja_in)
+            : ia(ia_in, ia_in + size + 1),
+              ja(ja_in, ja_in + nonzeros),
+              A(new Mat(size, size, nonzeros, Mat::row_wise))
+        {
+            for (Mat::CreateIterator row = A->createbegin(); row != A->createend(); ++row) {
+                const int ri = row.index();
+                for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
+                    row.insert(ja[i]);
+                }
+            }
+            if (int(A->nonzeroes()) != nonzeros) {
+                OPM_THROW(std::runtime_error, "Matrix pattern has repeated entries, cannot reuse it.");
+            }
+
+            // Columns of a BCRS row are sorted, record which CSR entry
+            // feeds each of them so values can be copied without lookups.
+            entry.reserve(nonzeros);
+            std::vector<std::pair<int, int> > row_cols;
+            for (int ri = 0; ri < size; ++ri) {
+                row_cols.clear();
+                for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
+                    row_cols.push_back(std::make_pair(ja[i], i));
+                }
+                std::sort(row_cols.begin(), row_cols.end());
+                for (std::size_t k = 0; k < row_cols.size(); ++k) {
+                    entry.push_back(row_cols[k].second);
+                }
+            }
+            op.reset(new Operator(*A));
+        }
+
+        void setValues(const double* sa)
+        {
+            int k = 0;
+            for (Mat::RowIterator row = A->begin(); row != A->end(); ++row) {
+                for (Mat::ColIterator col = row->begin(); col != row->end(); ++col, ++k) {
+                    *col = sa[entry[k]];
+                }
+            }
+        }
+
+        std::vector<int> ia;
+        std::vector<int> ja;
+        std::vector<int> entry;             // CSR index of each BCRS entry, in storage order
+        std::vector<double> setup_values;   // CSR values at the last preconditioner setup
+        int baseline_iterations = -1;       // iterations of the first solve after the last setup
+        bool rebuild = false;               // set up the preconditioner again in the next solve
+        std::unique_ptr<Mat> A;
+        std::unique_ptr<Operator> op;
+        Dune::Amg::SequentialInformation comm;
+        std::shared_ptr<SeqPreconditioner> precond;
+    };
+
+
+
 
     LinearSolverIstl::LinearSolverIstl()
         : linsolver_residual_tolerance_(1e-8),
@@ -104,7 +177,11 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_pattern_(false),
+          linsolver_reuse_drift_(0.1),
+          linsolver_reuse_policy_(ReuseDrift),
+          linsolver_reuse_iteration_factor_(1.5)
     {
     }
 
@@ -118,7 +195,11 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_pattern_(false),
+          linsolver_reuse_drift_(0.1),
+          linsolver_reuse_policy_(ReuseDrift),
+          linsolver_reuse_iteration_factor_(1.5)
     {
         linsolver_residual_tolerance_ = param.getDefault("linsolver_residual_tolerance", linsolver_residual_tolerance_);
         linsolver_verbosity_ = param.getDefault("linsolver_verbosity", linsolver_verbosity_);
@@ -130,6 +211,18 @@ namespace Opm
         linsolver_max_iterations_ = param.getDefault("linsolver_max_iterations", linsolver_max_iterations_);
         linsolver_smooth_steps_ = param.getDefault("linsolver_smooth_steps", linsolver_smooth_steps_);
         linsolver_prolongate_factor_ = param.getDefault("linsolver_prolongate_factor", linsolver_prolongate_factor_);
+        linsolver_reuse_pattern_ = param.getDefault("linsolver_reuse_pattern", linsolver_reuse_pattern_);
+        linsolver_reuse_drift_ = param.getDefault("linsolver_reuse_drift", linsolver_reuse_drift_);
+        const std::string policy = param.getDefault("linsolver_reuse_policy", std::string("drift"));
+        if (policy == "drift") {
+            linsolver_reuse_policy_ = ReuseDrift;
+        } else if (policy == "iterations") {
+            linsolver_reuse_policy_ = ReuseIterations;
+        } else {
+            OPM_THROW(std::runtime_error, "Unknown linsolver_reuse_policy: " << policy);
+        }
+        linsolver_reuse_iteration_factor_ = param.getDefault("linsolver_reuse_iteration_factor",
+                                                             linsolver_reuse_iteration_factor_);
     }
 
     LinearSolverIstl::~LinearSolverIstl()
@@ -145,25 +238,21 @@ namespace Opm
                             double* solution,
                             const boost::any& comm) const
     {
-        // Build Istl structures from input.
-        // System matrix
-        Mat A(size, size, nonzeros, Mat::row_wise);
-        for (Mat::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
-            int ri = row.index();
-            for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
-                row.insert(ja[i]);
-            }
-        }
-        for (int ri = 0; ri < size; ++ri) {
-            for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
-                A[ri][ja[i]] = sa[i];
-            }
-        }
-
         int maxit = linsolver_max_iterations_;
         if (maxit == 0) {
             maxit = 5000;
         }
+
+        if (linsolver_reuse_pattern_ && comm.empty() && !linsolver_save_system_
+            && (linsolver_type_ == CG_AMG || linsolver_type_ == CG_ILU0)) {
+            return solveReusingPattern(size, nonzeros, ia, ja, sa, rhs, solution, maxit);
+        }
+
+        // Build Istl structures from input.
+        // System matrix
+        Mat A(size, size, nonzeros, Mat::row_wise);
+        copyCsrToBcrs(size, ia, ja, sa, A);
+
 #if HAVE_MPI
         if(comm.type()==typeid(ParallelISTLInformation))
         {
@@ -256,10 +345,115 @@ namespace Opm
             std::cerr << "Unknown linsolver_type: " << int(linsolver_type_) << '\n';
             throw std::runtime_error("Unknown linsolver_type");
         }
+        res.preconditioner_setups = 1;
         std::copy(x.begin(), x.end(), solution);
         return res;
     }
 
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveReusingPattern(const int size,
+                                          const int nonzeros,
+                                          const int* ia,
+                                          const int* ja,
+                                          const double* sa,
+                                          const double* rhs,
+                                          double* solution,
+                                          int maxit) const
+    {
+        const bool same_pattern = reuse_
+            && int(reuse_->ia.size()) == size + 1
+            && int(reuse_->ja.size()) == nonzeros
+            && std::equal(ia, ia + size + 1, reuse_->ia.begin())
+            && std::equal(ja, ja + nonzeros, reuse_->ja.begin());
+        if (!same_pattern) {
+            reuse_.reset(new PatternReuse(size, nonzeros, ia, ja));
+        }
+        PatternReuse& r = *reuse_;
+        r.setValues(sa);
+
+        // Set up the preconditioner again if the matrix has drifted
+        // too far from the one it was built for, or if the previous
+        // solve needed too many iterations with it.
+        bool setup = !r.precond || r.rebuild;
+        if (!setup && linsolver_reuse_policy_ == ReuseDrift) {
+            double diff2 = 0.0;
+            double ref2 = 0.0;
+            for (int i = 0; i < nonzeros; ++i) {
+                const double d = sa[i] - r.setup_values[i];
+                diff2 += d*d;
+                ref2 += r.setup_values[i]*r.setup_values[i];
+            }
+            setup = diff2 > linsolver_reuse_drift_*linsolver_reuse_drift_*ref2;
+        }
+
+        LinearSolverReport res;
+        time::StopWatch clock;
+        clock.start();
+        if (setup) {
+            setupReusedPreconditioner(nonzeros, sa);
+            res.preconditioner_setups = 1;
+            res.setup_time = clock.secsSinceLast();
+        }
+
+        Vector b(size);
+        std::copy(rhs, rhs + size, b.begin());
+        Vector x(size);
+        x = 0.0;
+
+        Dune::SeqScalarProduct<Vector> sp;
+        Dune::InverseOperatorResult result;
+        {
+            Dune::CGSolver<Vector> linsolve(*r.op, sp, *r.precond, linsolver_residual_tolerance_,
+                                            maxit, linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+        }
+        res.solve_time = clock.secsSinceLast();
+
+        if (linsolver_reuse_policy_ == ReuseIterations && !setup) {
+            if (!result.converged) {
+                // The old preconditioner failed, solve again with a new one.
+                setupReusedPreconditioner(nonzeros, sa);
+                res.preconditioner_setups += 1;
+                res.setup_time += clock.secsSinceLast();
+                std::copy(rhs, rhs + size, b.begin());
+                x = 0.0;
+                Dune::CGSolver<Vector> linsolve(*r.op, sp, *r.precond, linsolver_residual_tolerance_,
+                                                maxit, linsolver_verbosity_);
+                linsolve.apply(x, b, result);
+                res.solve_time += clock.secsSinceLast();
+            } else if (result.iterations > linsolver_reuse_iteration_factor_*r.baseline_iterations) {
+                // Convergence has degraded, set up again next time.
+                r.rebuild = true;
+            }
+        }
+        if (r.baseline_iterations < 0) {
+            r.baseline_iterations = result.iterations;
+        }
+        std::copy(x.begin(), x.end(), solution);
+
+        res.converged = result.converged;
+        res.iterations = result.iterations;
+        res.residual_reduction = result.reduction;
+        return res;
+    }
+
+    void LinearSolverIstl::setupReusedPreconditioner(const int nonzeros, const double* sa) const
+    {
+        PatternReuse& r = *reuse_;
+        r.precond.reset();
+        if (linsolver_type_ == CG_AMG) {
+            r.precond = makeSeqAMG(*r.op, r.comm, linsolver_verbosity_,
+                                   linsolver_prolongate_factor_, linsolver_smooth_steps_);
+        } else {
+            r.precond.reset(new Dune::SeqILU0<Mat,Vector,Vector>(*r.A, 1.0));
+        }
+        if (linsolver_reuse_policy_ == ReuseDrift) {
+            r.setup_values.assign(sa, sa + nonzeros);
+        }
+        r.baseline_iterations = -1;
+        r.rebuild = false;
+    }
+
     void LinearSolverIstl::setTolerance(const double tol)
     {
         linsolver_residual_tolerance_ = tol;
@@ -272,6 +466,34 @@ namespace Opm
 
     namespace
     {
+    // Set up pattern and values of A, which must be in the row_wise
+    // build mode, from a CSR matrix. Values are copied in a single
+    // pass over each row when its columns are sorted, as they are
+    // for matrices from sparse_sys.h, avoiding a column search per
+    // entry. Rows are independent and filled in parallel.
+    void copyCsrToBcrs(const int size, const int* ia, const int* ja, const double* sa, Mat& A)
+    {
+        for (Mat::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
+            const int ri = row.index();
+            for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
+                row.insert(ja[i]);
+            }
+        }
+#pragma omp parallel for schedule(static)
+        for (int ri = 0; ri < size; ++ri) {
+            Mat::row_type& row = A[ri];
+            Mat::ColIterator col = row.begin();
+            int i = ia[ri];
+            for (; i < ia[ri + 1] && col != row.end() && int(col.index()) == ja[i]; ++i, ++col) {
+                *col = sa[i];
+            }
+            // Unsorted or repeated columns, look up the remaining entries.
+            for (; i < ia[ri + 1]; ++i) {
+                row[ja[i]] = sa[i];
+            }
+        }
+    }
+
     template<class P, class O, class C>
     struct SmootherChooser
     {
@@ -319,8 +541,11 @@ namespace Opm
     {
 
         // Construct preconditioner.
+        time::StopWatch clock;
+        clock.start();
         typedef Dune::SeqILU0<Mat,Vector,Vector> Preconditioner;
         auto precond = makePreconditioner<Preconditioner>(opA, 1.0, comm);
+        const double setup_time = clock.secsSinceLast();
 
         // Construct linear solver.
         Dune::CGSolver<Vector> linsolve(opA, sp, *precond, tolerance, maxit, verbosity);
@@ -334,6 +559,8 @@ namespace Opm
         res.converged = result.converged;
         res.iterations = result.iterations;
         res.residual_reduction = result.reduction;
+        res.setup_time = setup_time;
+        res.solve_time = clock.secsSinceLast();
         return res;
     }
 
@@ -387,11 +614,14 @@ namespace Opm
         typedef Dune::Amg::AMG<O,Vector,Smoother,C>   Precond;
 
         // Construct preconditioner.
+        time::StopWatch clock;
+        clock.start();
         Criterion criterion;
         typename Precond::SmootherArgs smootherArgs;
         setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
                        linsolver_smooth_steps);
         Precond precond(opA, criterion, smootherArgs, comm);
+        const double setup_time = clock.secsSinceLast();
 
         // Construct linear solver.
         Dune::CGSolver<Vector> linsolve(opA, sp, precond, tolerance, maxit, verbosity);
@@ -405,10 +635,45 @@ namespace Opm
         res.converged = result.converged;
         res.iterations = result.iterations;
         res.residual_reduction = result.reduction;
+        res.setup_time = setup_time;
+        res.solve_time = clock.secsSinceLast();
         return res;
     }
 
 
+    std::shared_ptr<SeqPreconditioner>
+    makeSeqAMG(Operator& opA, const Dune::Amg::SequentialInformation& comm, int verbosity,
+               double linsolver_prolongate_factor, int linsolver_smooth_steps)
+    {
+        // Same setup as in solveCG_AMG(), but the hierarchy outlives the call.
+#if FIRST_DIAGONAL
+        typedef Dune::Amg::FirstDiagonal CouplingMetric;
+#else
+        typedef Dune::Amg::RowSum        CouplingMetric;
+#endif
+
+#if SYMMETRIC
+        typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric>   CriterionBase;
+#else
+        typedef Dune::Amg::UnSymmetricCriterion<Mat,CouplingMetric> CriterionBase;
+#endif
+
+#if SMOOTHER_ILU
+        typedef Dune::SeqILU0<Mat,Vector,Vector>        Smoother;
+#else
+        typedef Dune::SeqSOR<Mat,Vector,Vector>        Smoother;
+#endif
+        typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+        typedef Dune::Amg::AMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation> Precond;
+
+        Criterion criterion;
+        Precond::SmootherArgs smootherArgs;
+        setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
+                       linsolver_smooth_steps);
+        return std::shared_ptr<SeqPreconditioner>(new Precond(opA, criterion, smootherArgs, comm));
+    }
+
+
 #if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
     template<class O, class S, class C>
     LinearSolverInterface::LinearSolverReport
@@ -439,11 +704,14 @@ namespace Opm
         typedef Dune::Amg::KAMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation>   Precond;
 
         // Construct preconditioner.
+        time::StopWatch clock;
+        clock.start();
         Precond::SmootherArgs smootherArgs;
         Criterion criterion;
         setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
                        linsolver_smooth_steps);
         Precond precond(sOpA, criterion, smootherArgs);
+        const double setup_time = clock.secsSinceLast();
 
         // Construct linear solver.
         Dune::GeneralizedPCGSolver<Vector> linsolve(sOpA, precond, tolerance, maxit, verbosity);
@@ -457,6 +725,8 @@ namespace Opm
         res.converged = result.converged;
         res.iterations = result.iterations;
         res.residual_reduction = result.reduction;
+        res.setup_time = setup_time;
+        res.solve_time = clock.secsSinceLast();
         return res;
     }
 
@@ -485,6 +755,8 @@ namespace Opm
         typedef Dune::Amg::FastAMG<Operator,Vector>   Precond;
 
         // Construct preconditioner.
+        time::StopWatch clock;
+        clock.start();
         Criterion criterion;
         const int smooth_steps = 1;
         setUpCriterion(criterion, linsolver_prolongate_factor, verbosity, smooth_steps);
@@ -494,6 +766,7 @@ namespace Opm
         parms.setNoPostSmoothSteps(smooth_steps);
         parms.setProlongationDampingFactor(linsolver_prolongate_factor);
         Precond precond(sOpA, criterion, parms);
+        const double setup_time = clock.secsSinceLast();
 
         // Construct linear solver.
         Dune::GeneralizedPCGSolver<Vector> linsolve(sOpA, precond, tolerance, maxit, verbosity);
@@ -507,6 +780,8 @@ namespace Opm
         res.converged = result.converged;
         res.iterations = result.iterations;
         res.residual_reduction = result.reduction;
+        res.setup_time = setup_time;
+        res.solve_time = clock.secsSinceLast();
         return res;
     }
 #endif
@@ -517,8 +792,11 @@ namespace Opm
     {
 
         // Construct preconditioner.
+        time::StopWatch clock;
+        clock.start();
         typedef Dune::SeqILU0<Mat,Vector,Vector> Preconditioner;
         auto precond = makePreconditioner<Preconditioner>(opA, 1.0, comm);
+        const double setup_time = clock.secsSinceLast();
 
         // Construct linear solver.
         Dune::BiCGSTABSolver<Vector> linsolve(opA, sp, *precond, tolerance, maxit, verbosity);
@@ -532,6 +810,8 @@ namespace Opm
         res.converged = result.converged;
         res.iterations = result.iterations;
         res.residual_reduction = result.reduction;
+        res.setup_time = setup_time;
+        res.solve_time = clock.secsSinceLast();
         return res;
     }
 
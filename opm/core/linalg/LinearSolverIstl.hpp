@@ -23,6 +23,7 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <memory>
 #include <string>
 #include <boost/any.hpp>
 
@@ -47,6 +48,22 @@ namespace Opm
         ///   linsolver_smooth_steps        2
         ///   linsolver_prolongate_factor   1.6
         ///   linsolver_verbosity           0
+        ///   linsolver_reuse_pattern       false
+        ///   linsolver_reuse_drift         0.1
+        ///   linsolver_reuse_policy        drift (alternative: iterations)
+        ///   linsolver_reuse_iteration_factor 1.5
+        /// If linsolver_reuse_pattern is true, sequential CG_AMG and
+        /// CG_ILU0 solves keep the matrix and preconditioner alive
+        /// between calls with an unchanged sparsity pattern, only
+        /// updating the matrix values. With the drift policy the
+        /// preconditioner is set up again when the relative change (in
+        /// the 2-norm) of the matrix values since the last setup exceeds
+        /// linsolver_reuse_drift. With the iterations policy it is kept
+        /// as long as solves need at most linsolver_reuse_iteration_factor
+        /// times the iterations of the first solve after its setup; it
+        /// is set up again for the next solve when that is exceeded, and
+        /// at once, repeating the solve, if a solve fails to converge.
+        /// The reports of all solves give setup and solve times.
         LinearSolverIstl();
 
         /// Construct from parameters
@@ -97,6 +114,20 @@ namespace Opm
         LinearSolverReport solveSystem(O& opA, double* solution, const double *rhs,
                                        S& sp, const C& comm, int maxit) const;
 
+        /// \brief Solve the linear system reusing matrix and preconditioner.
+        /// See the linsolver_reuse_pattern parameter.
+        LinearSolverReport solveReusingPattern(const int size,
+                                               const int nonzeros,
+                                               const int* ia,
+                                               const int* ja,
+                                               const double* sa,
+                                               const double* rhs,
+                                               double* solution,
+                                               int maxit) const;
+
+        /// \brief Set up the preconditioner kept by solveReusingPattern().
+        void setupReusedPreconditioner(const int nonzeros, const double* sa) const;
+
         double linsolver_residual_tolerance_;
         int linsolver_verbosity_;
         enum LinsolverType { CG_ILU0 = 0, CG_AMG = 1, BiCGStab_ILU0 = 2, FastAMG=3, KAMG=4 };
@@ -108,7 +139,18 @@ namespace Opm
         int linsolver_smooth_steps_;
         /** \brief The factor to scale the coarse grid correction with. */
         double linsolver_prolongate_factor_;
-
+        /** \brief Whether to keep matrix and preconditioner between solves. */
+        bool linsolver_reuse_pattern_;
+        /** \brief Relative change of matrix values triggering a new preconditioner setup. */
+        double linsolver_reuse_drift_;
+        enum ReusePolicy { ReuseDrift, ReuseIterations };
+        /** \brief What triggers a new preconditioner setup when reusing it. */
+        ReusePolicy linsolver_reuse_policy_;
+        /** \brief Iteration growth triggering a new setup with the iterations policy. */
+        double linsolver_reuse_iteration_factor_;
+
+        struct PatternReuse;
+        mutable std::shared_ptr<PatternReuse> reuse_;
     };
 
 
@@ -21,12 +21,19 @@
 #include <opm/core/linalg/LinearSolverUmfpack.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/linalg/call_umfpack.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <stdexcept>
 
 namespace Opm
 {
 
     LinearSolverUmfpack::LinearSolverUmfpack()
+        : cache_(umfpack_cache_create(), &umfpack_cache_destroy)
     {
+        if (!cache_) {
+            OPM_THROW(std::runtime_error, "Failed to allocate UMFPACK factorisation cache.");
+        }
     }
 
 
@@ -48,6 +55,22 @@ namespace Opm
                                const double* rhs,
                                double* solution,
                                const boost::any&) const
+    {
+        return solveMultiple(size, nonzeros, ia, ja, sa, 1, rhs, solution);
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverUmfpack::solveMultiple(const int size,
+                                       const int nonzeros,
+                                       const int* ia,
+                                       const int* ja,
+                                       const double* sa,
+                                       const int num_rhs,
+                                       const double* rhs,
+                                       double* solution) const
     {
         CSRMatrix A  = {
             (size_t)size,
@@ -56,9 +79,8 @@ namespace Opm
             const_cast<int*>(ja),
             const_cast<double*>(sa)
         };
-        call_UMFPACK(&A, rhs, solution);
         LinearSolverReport rep = {};
-        rep.converged = true;
+        rep.converged = call_UMFPACK_cached(cache_.get(), &A, num_rhs, rhs, solution) != 0;
         return rep;
     }
 
@@ -23,12 +23,21 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 
+#include <memory>
+
+struct UMFPACKCache;
 
 namespace Opm
 {
 
 
     /// Concrete class encapsulating the UMFPACK direct linear solver.
+    /// The symbolic analysis of the most recent matrix is kept and
+    /// reused while the sparsity pattern is unchanged, and so is the
+    /// numeric factorisation while the matrix values are unchanged.
+    /// The cache is updated by the (const) solve methods without any
+    /// locking, so an instance must not be used by several threads at
+    /// once.  Use one instance per thread instead.
     class LinearSolverUmfpack : public LinearSolverInterface
     {
     public:
@@ -58,6 +67,27 @@ namespace Opm
                                          double* solution,
                                          const boost::any& add=boost::any()) const;
 
+        /// Solve a linear system for several right hand sides, with a
+        /// matrix given in compressed sparse row format. The matrix is
+        /// factored once for all right hand sides.
+        /// \param[in] size        # of rows in matrix
+        /// \param[in] nonzeros    # of nonzeros elements in matrix
+        /// \param[in] ia          array of length (size + 1) containing start and end indices for each row
+        /// \param[in] ja          array of length nonzeros containing column numbers for the nonzero elements
+        /// \param[in] sa          array of length nonzeros containing the values of the nonzero elements
+        /// \param[in] num_rhs     # of right hand sides
+        /// \param[in] rhs         array of length (num_rhs * size) containing the right hand sides,
+        ///                        one after the other
+        /// \param[out] solution   array of length (num_rhs * size) to which the solutions will be written
+        LinearSolverReport solveMultiple(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const int num_rhs,
+                                         const double* rhs,
+                                         double* solution) const;
+
         /// Set tolerance for the linear solver.
         /// \param[in] tol         tolerance value
         /// Not used for UMFPACK solver.
@@ -68,7 +98,8 @@ namespace Opm
         /// Not used for UMFPACK solver. Returns -1.
         virtual double getTolerance() const;
 
-
+    private:
+        std::unique_ptr<UMFPACKCache, void (*)(UMFPACKCache*)> cache_;
     };
 
 
@@ -36,6 +36,7 @@
 #include "config.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <umfpack.h>
 
@@ -141,45 +142,290 @@ csr_to_csc(const int        *ia,
 }
 
 
+/* ---------------------------------------------------------------------- */
+/* Factorisation cache.  Holds the CSC copy of the most recent matrix, a
+ * copy of its CSR sparsity pattern, the position of each CSR element in
+ * the CSC arrays and the UMFPACK symbolic and numeric objects. */
+/* ---------------------------------------------------------------------- */
+struct UMFPACKCache {
+    struct CSCMatrix *csc;
+
+    UF_long  m;                 /* Pattern of cached matrix (CSR) */
+    int     *ia;
+    int     *ja;
+    UF_long *pos;               /* CSR element -> CSC position    */
+
+    void    *Symbolic;
+    void    *Numeric;
+
+    size_t   nanalyse;          /* Symbolic analyses performed    */
+    size_t   nfactor;           /* Numeric factorisations         */
+
+    double   Control[UMFPACK_CONTROL];
+};
+
+
 /* ---------------------------------------------------------------------- */
 static void
-solve_umfpack(struct CSCMatrix *csc, const double *b, double *x)
+cache_clear(struct UMFPACKCache *cache)
 /* ---------------------------------------------------------------------- */
 {
-    void *Symbolic, *Numeric;
-    double Info[UMFPACK_INFO], Control[UMFPACK_CONTROL];
+    if (cache->Numeric  != NULL) { umfpack_dl_free_numeric (&cache->Numeric ); }
+    if (cache->Symbolic != NULL) { umfpack_dl_free_symbolic(&cache->Symbolic); }
+
+    csc_deallocate(cache->csc);
+    free(cache->pos);
+    free(cache->ja);
+    free(cache->ia);
+
+    cache->csc = NULL;
+    cache->m   = 0;
+    cache->ia  = NULL;
+    cache->ja  = NULL;
+    cache->pos = NULL;
+}
 
-    umfpack_dl_defaults(Control);
 
-    umfpack_dl_symbolic(csc->n, csc->n, csc->p, csc->i, csc->x,
-                        &Symbolic, Control, Info);
-    umfpack_dl_numeric (csc->p, csc->i, csc->x,
-                        Symbolic, &Numeric, Control, Info);
+/* ---------------------------------------------------------------------- */
+struct UMFPACKCache *
+umfpack_cache_create(void)
+/* ---------------------------------------------------------------------- */
+{
+    struct UMFPACKCache *new;
 
-    umfpack_dl_free_symbolic(&Symbolic);
+    new = malloc(1 * sizeof *new);
 
-    umfpack_dl_solve(UMFPACK_A, csc->p, csc->i, csc->x, x, b,
-                     Numeric, Control, Info);
+    if (new != NULL) {
+        new->csc      = NULL;
+        new->m        = 0;
+        new->ia       = NULL;
+        new->ja       = NULL;
+        new->pos      = NULL;
+        new->Symbolic = NULL;
+        new->Numeric  = NULL;
+        new->nanalyse = 0;
+        new->nfactor  = 0;
+
+        umfpack_dl_defaults(new->Control);
+    }
 
-    umfpack_dl_free_numeric(&Numeric);
+    return new;
 }
 
 
-/*---------------------------------------------------------------------------*/
+/* ---------------------------------------------------------------------- */
 void
-call_UMFPACK(struct CSRMatrix *A, const double *b, double *x)
+umfpack_cache_destroy(struct UMFPACKCache *cache)
+/* ---------------------------------------------------------------------- */
+{
+    if (cache != NULL) {
+        cache_clear(cache);
+    }
+
+    free(cache);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+umfpack_cache_counts(const struct UMFPACKCache *cache,
+                     size_t *nanalyse, size_t *nfactor)
+/* ---------------------------------------------------------------------- */
+{
+    *nanalyse = cache->nanalyse;
+    *nfactor  = cache->nfactor;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+same_pattern(const struct UMFPACKCache *cache, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t nnz;
+
+    if ((cache->csc == NULL) || (cache->m != (UF_long) A->m)) {
+        return 0;
+    }
+
+    nnz = A->ia[A->m];
+
+    return ((UF_long) nnz == cache->csc->nnz) &&
+        (memcmp(cache->ia, A->ia, (A->m + 1) * sizeof *A->ia) == 0) &&
+        (memcmp(cache->ja, A->ja, nnz        * sizeof *A->ja) == 0);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Build CSC pattern and CSR->CSC position map for new sparsity pattern,
+ * and run symbolic analysis. */
+/* ---------------------------------------------------------------------- */
+static int
+cache_analyse(struct UMFPACKCache *cache, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    UF_long nnz, nz;
+    int     status;
+
+    cache_clear(cache);
+
+    nnz        = A->ia[A->m];
+    cache->m   = A->m;
+    cache->csc = csc_allocate(A->m, nnz);
+    cache->ia  = malloc((A->m + 1) * sizeof *cache->ia);
+    cache->ja  = malloc(nnz        * sizeof *cache->ja);
+    cache->pos = malloc(nnz        * sizeof *cache->pos);
+
+    if ((cache->csc == NULL) || (cache->ia  == NULL) ||
+        (cache->ja  == NULL) || (cache->pos == NULL)) {
+        cache_clear(cache);
+        return 0;
+    }
+
+    memcpy(cache->ia, A->ia, (A->m + 1) * sizeof *A->ia);
+    memcpy(cache->ja, A->ja, nnz        * sizeof *A->ja);
+
+    /* Transpose once with element numbers as values to get the
+     * position of each CSR element in the CSC arrays. */
+    {
+        double *elm = malloc(nnz * sizeof *elm);
+
+        if (elm == NULL) {
+            cache_clear(cache);
+            return 0;
+        }
+
+        for (nz = 0; nz < nnz; nz++) { elm[nz] = (double) nz; }
+
+        csr_to_csc(A->ia, A->ja, elm, cache->csc);
+
+        for (nz = 0; nz < nnz; nz++) {
+            cache->pos[ (UF_long) cache->csc->x[nz] ] = nz;
+        }
+
+        free(elm);
+    }
+
+    for (nz = 0; nz < nnz; nz++) {
+        cache->csc->x[ cache->pos[nz] ] = A->sa[nz];
+    }
+
+    status = umfpack_dl_symbolic(cache->csc->n, cache->csc->n,
+                                 cache->csc->p, cache->csc->i, cache->csc->x,
+                                 &cache->Symbolic, cache->Control, NULL);
+
+    if (status != UMFPACK_OK) {
+        cache_clear(cache);
+        return 0;
+    }
+
+    cache->nanalyse += 1;
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Scatter matrix values into CSC copy.  Returns whether any value
+ * changed, in which case the numeric factorisation is stale. */
+/* ---------------------------------------------------------------------- */
+static int
+cache_update_values(struct UMFPACKCache *cache, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    UF_long nz, nnz;
+    double *x;
+    int     changed;
+
+    nnz     = cache->csc->nnz;
+    x       = cache->csc->x;
+    changed = 0;
+
+    for (nz = 0; nz < nnz; nz++) {
+        if (x[ cache->pos[nz] ] != A->sa[nz]) {
+            x[ cache->pos[nz] ] = A->sa[nz];
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+
+/*---------------------------------------------------------------------------*/
+int
+call_UMFPACK_cached(struct UMFPACKCache *cache,
+                    struct CSRMatrix    *A,
+                    size_t               nrhs,
+                    const double        *b,
+                    double              *x)
 /*---------------------------------------------------------------------------*/
 {
-    struct CSCMatrix *csc;
+    size_t  k;
+    UF_long n;
+    int     status, refactor;
 
-    csc = csc_allocate(A->m, A->ia[A->m]);
+    refactor = 1;
 
-    if (csc != NULL) {
-        csr_to_csc(A->ia, A->ja, A->sa, csc);
+    if (! same_pattern(cache, A)) {
+        if (! cache_analyse(cache, A)) {
+            return 0;
+        }
+    }
+    else if (cache->Numeric != NULL) {
+        refactor = cache_update_values(cache, A);
+    }
+    else {
+        (void) cache_update_values(cache, A);
+    }
+
+    if (refactor) {
+        if (cache->Numeric != NULL) {
+            umfpack_dl_free_numeric(&cache->Numeric);
+        }
+
+        status = umfpack_dl_numeric(cache->csc->p, cache->csc->i, cache->csc->x,
+                                    cache->Symbolic, &cache->Numeric,
+                                    cache->Control, NULL);
+
+        /* Singular matrices yield a warning (positive status) and a
+         * usable, if meaningless, factorisation, as before. */
+        if (status < UMFPACK_OK) {
+            cache->Numeric = NULL;
+            return 0;
+        }
+
+        cache->nfactor += 1;
+    }
 
-        solve_umfpack(csc, b, x);
+    n = cache->csc->n;
+    for (k = 0; k < nrhs; k++) {
+        status = umfpack_dl_solve(UMFPACK_A,
+                                  cache->csc->p, cache->csc->i, cache->csc->x,
+                                  x + k*n, b + k*n,
+                                  cache->Numeric, cache->Control, NULL);
+
+        if (status < UMFPACK_OK) {
+            return 0;
+        }
     }
 
-    csc_deallocate(csc);
+    return 1;
 }
 
+
+/*---------------------------------------------------------------------------*/
+void
+call_UMFPACK(struct CSRMatrix *A, const double *b, double *x)
+/*---------------------------------------------------------------------------*/
+{
+    struct UMFPACKCache *cache;
+
+    cache = umfpack_cache_create();
+
+    if (cache != NULL) {
+        call_UMFPACK_cached(cache, A, 1, b, x);
+    }
+
+    umfpack_cache_destroy(cache);
+}
@@ -39,10 +39,37 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 struct CSRMatrix;
+struct UMFPACKCache;
 
+/* Solve A x = b.  Analyses and factors A from scratch. */
 void call_UMFPACK(struct CSRMatrix *A, const double *b, double *x);
 
+/* Create and destroy a factorisation cache for call_UMFPACK_cached(). */
+struct UMFPACKCache *umfpack_cache_create(void);
+void umfpack_cache_destroy(struct UMFPACKCache *cache);
+
+/* Number of symbolic analyses and numeric factorisations performed
+ * with the cache so far. */
+void umfpack_cache_counts(const struct UMFPACKCache *cache,
+                          size_t *nanalyse, size_t *nfactor);
+
+/* Solve A X = B for nrhs right-hand sides, stored one after another
+ * in b (and x), each of length A->m.
+ *
+ * The symbolic analysis is reused while A has the same sparsity pattern
+ * as in the previous call with the same cache, and the numeric
+ * factorisation is reused while A also has the same values.
+ *
+ * Returns one (1) if successful, zero (0) otherwise. */
+int call_UMFPACK_cached(struct UMFPACKCache *cache,
+                        struct CSRMatrix    *A,
+                        size_t               nrhs,
+                        const double        *b,
+                        double              *x);
+
 #ifdef __cplusplus
 }
 #endif
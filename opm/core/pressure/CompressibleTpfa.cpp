@@ -219,13 +219,25 @@ namespace Opm
         const double grav = gravity_ ? gravity_[dim - 1] : 0.0;
         wellperf_wdp_.clear();
         wellperf_wdp_.resize(nperf, 0.0);
-        if (not (std::abs(grav) > 0.0)) {
+        if (not (std::abs(grav) > 0.0) || nperf == 0) {
             return;
         }
 
-        // Temporary storage for perforation A matrices and densities.
-        std::vector<double> A(np*np, 0.0);
-        std::vector<double> rho(np, 0.0);
+        // Evaluate the perforation cell densities in a single batch.
+        perf_cells_.assign(wells_->well_cells, wells_->well_cells + nperf);
+        perf_p_.resize(nperf);
+        perf_T_.resize(nperf);
+        perf_z_.resize(nperf*np);
+        for (int j = 0; j < nperf; ++j) {
+            const int cell = perf_cells_[j];
+            perf_p_[j] = state.pressure()[cell];
+            perf_T_[j] = state.temperature()[cell];
+            std::copy(&state.surfacevol()[np*cell], &state.surfacevol()[np*cell] + np, &perf_z_[np*j]);
+        }
+        perf_work_.resize(nperf*np*np);
+        std::vector<double> rho(nperf*np);
+        props_.matrix(nperf, &perf_p_[0], &perf_T_[0], &perf_z_[0], &perf_cells_[0], &perf_work_[0], 0);
+        props_.density(nperf, &perf_work_[0], &perf_cells_[0], &rho[0]);
 
         // Main loop, iterate over all perforations,
         // using the following formula (by phase):
@@ -237,11 +249,9 @@ namespace Opm
             for (int j = wells_->well_connpos[w]; j < wells_->well_connpos[w + 1]; ++j) {
                 const int cell = wells_->well_cells[j];
                 const double cell_depth = grid_.cell_centroids[dim * cell + dim - 1];
-                props_.matrix(1, &state.pressure()[cell], &state.temperature()[cell], &state.surfacevol()[np*cell], &cell, &A[0], 0);
-                props_.density(1, &A[0], &cell, &rho[0]);
                 for (int phase = 0; phase < np; ++phase) {
                     const double s_phase = state.saturation()[np*cell + phase];
-                    wellperf_wdp_[j] += s_phase*rho[phase]*grav*(cell_depth - ref_depth);
+                    wellperf_wdp_[j] += s_phase*rho[np*j + phase]*grav*(cell_depth - ref_depth);
                 }
             }
         }
@@ -304,6 +314,7 @@ namespace Opm
         // std::vector<double> cell_viscosity_;
         // std::vector<double> cell_phasemob_;
         // std::vector<double> cell_voldisc_;
+        // std::vector<double> cell_density_; // Empty unless gravity is active.
         // std::vector<double> porevol_;   // Only modified if rock_comp_props_ is non-null.
         // std::vector<double> rock_comp_; // Empty unless rock_comp_props_ is non-null.
         const int nc = grid_.number_of_cells;
@@ -331,6 +342,17 @@ namespace Opm
         cell_voldisc_.clear();
         cell_voldisc_.resize(nc, 0.0);
 
+        // Phase densities, needed by the face gravity contributions.
+        // Evaluated once per cell rather than once per face side.
+        const int dim = grid_.dimensions;
+        const double grav = gravity_ ? gravity_[dim - 1] : 0.0;
+        if (grav != 0.0) {
+            cell_density_.resize(nc*np);
+            props_.density(nc, &cell_A_[0], &allcells_[0], &cell_density_[0]);
+        } else {
+            cell_density_.clear();
+        }
+
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
             computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol_);
             rock_comp_.resize(nc);
@@ -357,12 +379,9 @@ namespace Opm
         const int nf = grid_.number_of_faces;
         const int dim = grid_.dimensions;
         const double grav = gravity_ ? gravity_[dim - 1] : 0.0;
-        std::vector<double> gravcontrib[2];
-        std::vector<double> pot[2];
-        gravcontrib[0].resize(np);
-        gravcontrib[1].resize(np);
-        pot[0].resize(np);
-        pot[1].resize(np);
+        const double* cell_p = &state.pressure()[0];
+        const double* cell_rho = cell_density_.empty() ? 0 : &cell_density_[0];
+        std::vector<double> pot0(np);
         face_A_.resize(nf*np*np);
         face_phasemob_.resize(nf*np);
         face_gravcap_.resize(nf*np);
@@ -371,28 +390,19 @@ namespace Opm
             const double face_depth = grid_.face_centroids[face*dim + dim - 1];
             const int* c = &grid_.face_cells[2*face];
 
-            // Get pressures and compute gravity contributions,
-            // to decide upwind directions.
+            // Get pressures and gravity weights (g*(face_z - cell_z)),
+            // to decide upwind directions. Boundary sides use the face
+            // pressure and have no gravity contribution.
             double c_press[2];
+            double c_gdz[2] = { 0.0, 0.0 };
             for (int j = 0; j < 2; ++j) {
                 if (c[j] >= 0) {
-                    // Pressure
-                    c_press[j] = state.pressure()[c[j]];
-                    // Gravity contribution, gravcontrib = rho*(face_z - cell_z) [per phase].
-                    if (grav != 0.0) {
-                        const double depth_diff = face_depth - grid_.cell_centroids[c[j]*dim + dim - 1];
-                        props_.density(1, &cell_A_[np*np*c[j]], &c[j], &gravcontrib[j][0]);
-                        for (int p = 0; p < np; ++p) {
-                            gravcontrib[j][p] *= depth_diff*grav;
-                        }
-                    } else {
-                        std::fill(gravcontrib[j].begin(), gravcontrib[j].end(), 0.0);
+                    c_press[j] = cell_p[c[j]];
+                    if (cell_rho) {
+                        c_gdz[j] = (face_depth - grid_.cell_centroids[c[j]*dim + dim - 1])*grav;
                     }
                 } else {
-                    // Pressures
                     c_press[j] = state.facepressure()[face];
-                    // Gravity contribution.
-                    std::fill(gravcontrib[j].begin(), gravcontrib[j].end(), 0.0);
                 }
             }
 
@@ -402,9 +412,10 @@ namespace Opm
             // z coordinate of the centroid, and z_12 is the face centroid.
             // Also compute the potentials.
             for (int phase = 0; phase < np; ++phase) {
-                face_gravcap_[np*face + phase] = gravcontrib[0][phase] - gravcontrib[1][phase];
-                pot[0][phase] = c_press[0] + face_gravcap_[np*face + phase];
-                pot[1][phase] = c_press[1];
+                const double g0 = (c[0] >= 0 && cell_rho) ? cell_rho[np*c[0] + phase]*c_gdz[0] : 0.0;
+                const double g1 = (c[1] >= 0 && cell_rho) ? cell_rho[np*c[1] + phase]*c_gdz[1] : 0.0;
+                face_gravcap_[np*face + phase] = g0 - g1;
+                pot0[phase] = c_press[0] + face_gravcap_[np*face + phase];
             }
 
             // Now we can easily find the upwind direction for every phase,
@@ -430,7 +441,7 @@ namespace Opm
             for (int phase = 0; phase < np; ++phase) {
                 int upwindc = -1;
                 if (c[0] >=0 && c[1] >= 0) {
-                    upwindc = (pot[0][phase] < pot[1][phase]) ? c[1] : c[0];
+                    upwindc = (pot0[phase] < c_press[1]) ? c[1] : c[0];
                 } else {
                     upwindc = (c[0] >= 0) ? c[0] : c[1];
                 }
@@ -466,38 +477,56 @@ namespace Opm
         // component fractions from
         // The mobilities are set equal to the perforation grid cells'
         // mobilities for producers.
-        std::vector<double> mu(np);
+        // Injector perforations are gathered and evaluated in one
+        // batch per property method.
+        perf_cells_.clear();
+        perf_p_.clear();
+        perf_T_.clear();
+        perf_z_.clear();
+        std::vector<int> injperf;
         for (int w = 0; w < nw; ++w) {
             bool producer = (wells_->type[w] == PRODUCER);
             const double* comp_frac = &wells_->comp_frac[np*w];
             for (int j = wells_->well_connpos[w]; j < wells_->well_connpos[w+1]; ++j) {
                 const int c = wells_->well_cells[j];
-                double* wpA = &wellperf_A_[np*np*j];
-                double* wpM = &wellperf_phasemob_[np*j];
                 if (producer) {
                     const double* cA = &cell_A_[np*np*c];
-                    std::copy(cA, cA + np*np, wpA);
+                    std::copy(cA, cA + np*np, &wellperf_A_[np*np*j]);
                     const double* cM = &cell_phasemob_[np*c];
-                    std::copy(cM, cM + np, wpM);
+                    std::copy(cM, cM + np, &wellperf_phasemob_[np*j]);
                 } else {
-                    const double bhp = well_state.bhp()[w];
-                    double perf_p = bhp + wellperf_wdp_[j];
-                    const double perf_T = well_state.temperature()[w];
-                    // Hack warning: comp_frac is used as a component
-                    // surface-volume variable in calls to matrix() and
-                    // viscosity(), but as a saturation in the call to
-                    // relperm(). This is probably ok as long as injectors
-                    // only inject pure fluids.
-                    props_.matrix(1, &perf_p,  &perf_T, comp_frac, &c, wpA, NULL);
-                    props_.viscosity(1, &perf_p, &perf_T, comp_frac, &c, &mu[0], NULL);
                     assert(std::fabs(std::accumulate(comp_frac, comp_frac + np, 0.0) - 1.0) < 1e-6);
-                    props_.relperm  (1, comp_frac, &c, wpM , NULL);
-                    for (int phase = 0; phase < np; ++phase) {
-                        wpM[phase] /= mu[phase];
-                    }
+                    injperf.push_back(j);
+                    perf_cells_.push_back(c);
+                    perf_p_.push_back(well_state.bhp()[w] + wellperf_wdp_[j]);
+                    perf_T_.push_back(well_state.temperature()[w]);
+                    perf_z_.insert(perf_z_.end(), comp_frac, comp_frac + np);
                 }
             }
         }
+        const int ninj = injperf.size();
+        if (ninj == 0) {
+            return;
+        }
+        // Hack warning: comp_frac is used as a component
+        // surface-volume variable in calls to matrix() and
+        // viscosity(), but as a saturation in the call to
+        // relperm(). This is probably ok as long as injectors
+        // only inject pure fluids.
+        perf_work_.resize(ninj*np*np + 2*ninj*np);
+        double* A = &perf_work_[0];
+        double* mu = A + ninj*np*np;
+        double* kr = mu + ninj*np;
+        props_.matrix(ninj, &perf_p_[0], &perf_T_[0], &perf_z_[0], &perf_cells_[0], A, NULL);
+        props_.viscosity(ninj, &perf_p_[0], &perf_T_[0], &perf_z_[0], &perf_cells_[0], mu, NULL);
+        props_.relperm(ninj, &perf_z_[0], &perf_cells_[0], kr, NULL);
+        for (int i = 0; i < ninj; ++i) {
+            const int j = injperf[i];
+            std::copy(A + np*np*i, A + np*np*(i + 1), &wellperf_A_[np*np*j]);
+            for (int phase = 0; phase < np; ++phase) {
+                wellperf_phasemob_[np*j + phase] = kr[np*i + phase] / mu[np*i + phase];
+            }
+        }
     }
 
 
@@ -143,6 +143,7 @@ namespace Opm
         std::vector<double> cell_viscosity_;
         std::vector<double> cell_phasemob_;
         std::vector<double> cell_voldisc_;
+        std::vector<double> cell_density_; // Empty unless gravity is active.
         std::vector<double> face_A_;
         std::vector<double> face_phasemob_;
         std::vector<double> face_gravcap_;
@@ -150,6 +151,12 @@ namespace Opm
         std::vector<double> wellperf_phasemob_;
         std::vector<double> porevol_;   // Only modified if rock_comp_props_ is non-null.
         std::vector<double> rock_comp_; // Empty unless rock_comp_props_ is non-null.
+        // Well perforation work arrays, for batched property evaluation.
+        std::vector<int> perf_cells_;
+        std::vector<double> perf_p_;
+        std::vector<double> perf_T_;
+        std::vector<double> perf_z_;
+        std::vector<double> perf_work_;
         // The update to be applied to the pressures (cell and bhp).
         std::vector<double> pressure_increment_;
         // True if the matrix assembled would be singular but for the
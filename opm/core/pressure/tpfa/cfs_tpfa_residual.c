@@ -5,6 +5,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <opm/core/wells.h>
 #include <opm/core/well_controls.h>
@@ -56,6 +59,11 @@ struct cfs_tpfa_res_impl {
 
     struct densrat_util *ratio;
 
+    /* Per-thread scratch for the parallel cell and face loops.
+     * thread_ratio[0] == ratio, flux_work holds nthreads blocks. */
+    int                   nthreads;
+    struct densrat_util **thread_ratio;
+
     /* Linear storage */
     double *ddata;
 };
@@ -115,14 +123,48 @@ allocate_densrat(size_t max_conn, int np)
 }
 
 
+/* ---------------------------------------------------------------------- */
+static int
+max_threads(void)
+/* ---------------------------------------------------------------------- */
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+thread_num(void)
+/* ---------------------------------------------------------------------- */
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+
 /* ---------------------------------------------------------------------- */
 static void
 impl_deallocate(struct cfs_tpfa_res_impl *pimpl)
 /* ---------------------------------------------------------------------- */
 {
+    int t;
+
     if (pimpl != NULL) {
-        free              (pimpl->ddata);
-        deallocate_densrat(pimpl->ratio);
+        free(pimpl->ddata);
+
+        if (pimpl->thread_ratio != NULL) {
+            for (t = 0; t < pimpl->nthreads; t++) {
+                deallocate_densrat(pimpl->thread_ratio[t]);
+            }
+        }
+        free(pimpl->thread_ratio);
     }
 
     free(pimpl);
@@ -137,6 +179,7 @@ impl_allocate(struct UnstructuredGrid   *G       ,
               int                        np      )
 /* ---------------------------------------------------------------------- */
 {
+    int                   t, nthreads;
     size_t                nnu, nwperf;
     struct cfs_tpfa_res_impl *new;
 
@@ -161,22 +204,41 @@ impl_allocate(struct UnstructuredGrid   *G       ,
     ddata_sz += np *      nwperf ;             /* compflux_p */
     ddata_sz += np * (2 * nwperf);             /* compflux_deriv_p */
 
-    ddata_sz += np * (1 + 2)                 ; /* flux_work */
+    nthreads  = max_threads();
+    ddata_sz += np * (1 + 2) * nthreads      ; /* flux_work */
 
     ddata_sz += 1  *      G->number_of_faces ; /* scratch_f */
 
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
-        new->ddata = malloc(ddata_sz * sizeof *new->ddata);
-        new->ratio = allocate_densrat(max_conn, np);
+        new->ddata        = malloc(ddata_sz * sizeof *new->ddata);
+        new->nthreads     = nthreads;
+        new->thread_ratio = calloc(nthreads, sizeof *new->thread_ratio);
+
+        if (new->thread_ratio != NULL) {
+            for (t = 0; t < nthreads; t++) {
+                new->thread_ratio[t] = allocate_densrat(max_conn, np);
+            }
+        }
 
-        if (new->ddata == NULL || new->ratio == NULL) {
+        if (new->ddata == NULL || new->thread_ratio == NULL) {
             impl_deallocate(new);
             new = NULL;
         }
     }
 
+    if (new != NULL) {
+        for (t = 0; t < nthreads; t++) {
+            if (new->thread_ratio[t] == NULL) {
+                impl_deallocate(new);
+                return NULL;
+            }
+        }
+
+        new->ratio = new->thread_ratio[0];
+    }
+
     return new;
 }
 
@@ -383,32 +445,33 @@ compute_compflux_and_deriv(struct UnstructuredGrid  *G     ,
 {
     int     c1, c2, f, np2;
     double  dp;
-    double *cflux, *dcflux;
+    double *work;
 
     np2    = np * np;
 
-    cflux  = pimpl->compflux_f;
-    dcflux = pimpl->compflux_deriv_f;
-
-    for (f = 0; f < G->number_of_faces;
-         f++, pmobf += np, gcapf += np, Af += np2,
-             cflux += np, dcflux += 2 * np) {
+    /* Faces are independent, each thread uses its own flux_work block. */
+#pragma omp parallel for num_threads(pimpl->nthreads) \
+    private(c1, c2, dp, work) schedule(static)
+    for (f = 0; f < G->number_of_faces; f++) {
 
         c1 = G->face_cells[2*f + 0];
         c2 = G->face_cells[2*f + 1];
 
         if ((c1 >= 0) && (c2 >= 0)) {
-            dp = cpress[c1] - cpress[c2];
+            dp   = cpress[c1] - cpress[c2];
+            work = pimpl->flux_work + (thread_num() * (1 + 2) * np);
 
-            compute_darcyflux_and_deriv(np, trans[f], dp, pmobf, gcapf,
-                                        pimpl->flux_work,
-                                        pimpl->flux_work + np);
+            compute_darcyflux_and_deriv(np, trans[f], dp,
+                                        pmobf + (f * np), gcapf + (f * np),
+                                        work, work + np);
 
             /* Component flux = Af * v*/
-            matvec(np, np, Af, pimpl->flux_work     , cflux );
+            matvec(np, np, Af + (f * np2), work     ,
+                   pimpl->compflux_f       + (f * np));
 
             /* Derivative = Af * (dv/dp) */
-            matmat(np, 2 , Af, pimpl->flux_work + np, dcflux);
+            matmat(np, 2 , Af + (f * np2), work + np,
+                   pimpl->compflux_deriv_f + (f * 2 * np));
         }
 
         /* Boundary connections excluded */
@@ -499,19 +562,20 @@ init_cell_contrib(struct UnstructuredGrid  *G    ,
                   double                    pvol ,
                   double                    dt   ,
                   const double             *z    ,
-                  struct cfs_tpfa_res_impl *pimpl)
+                  struct cfs_tpfa_res_impl *pimpl,
+                  struct densrat_util      *ratio)
 {
     int     c1, c2, f, i, conn, nconn;
     double *cflx, *dcflx;
 
     nconn = count_internal_conn(G, c);
 
-    memcpy(pimpl->ratio->linsolve_buffer, z, np * sizeof *z);
+    memcpy(ratio->linsolve_buffer, z, np * sizeof *z);
 
-    pimpl->ratio->coeff[0] = -pvol;
+    ratio->coeff[0] = -pvol;
     conn = 1;
 
-    cflx  = pimpl->ratio->linsolve_buffer + (1 * np);
+    cflx  = ratio->linsolve_buffer + (1 * np);
     dcflx = cflx + (nconn * np);
 
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
@@ -529,18 +593,19 @@ init_cell_contrib(struct UnstructuredGrid  *G    ,
             cflx  += 1 * np;
             dcflx += 2 * np;
 
-            pimpl->ratio->coeff[ conn++ ] = dt * (2*(c1 == c) - 1.0);
+            ratio->coeff[ conn++ ] = dt * (2*(c1 == c) - 1.0);
         }
     }
 
     assert (conn == nconn + 1);
-    assert (cflx == pimpl->ratio->linsolve_buffer + (nconn + 1)*np);
+    assert (cflx == ratio->linsolve_buffer + (nconn + 1)*np);
 
     return nconn;
 }
 
 
-static void
+/* Returns whether the cell's Jacobian row lacks compressibility. */
+static int
 compute_cell_contrib(struct UnstructuredGrid  *G    ,
                      int                       c    ,
                      int                       np   ,
@@ -549,49 +614,50 @@ compute_cell_contrib(struct UnstructuredGrid  *G    ,
                      const double             *z    ,
                      const double             *Ac   ,
                      const double             *dAc  ,
-                     struct cfs_tpfa_res_impl *pimpl)
+                     struct cfs_tpfa_res_impl *pimpl,
+                     struct densrat_util      *ratio)
 {
-    int        c1, c2, f, i, off, nconn, p;
+    int        c1, c2, f, i, off, nconn, p, is_incomp;
     MAT_SIZE_T nrhs;
     double     s, dF1, dF2, *dv, *dv1, *dv2;
 
-    nconn = init_cell_contrib(G, c, np, pvol, dt, z, pimpl);
+    nconn = init_cell_contrib(G, c, np, pvol, dt, z, pimpl, ratio);
     nrhs  = 1 + (1 + 2)*nconn;  /* [z, Af*v, Af*dv] */
 
-    factorise_fluid_matrix(np, Ac, pimpl->ratio);
-    solve_linear_systems  (np, nrhs, pimpl->ratio,
-                           pimpl->ratio->linsolve_buffer);
+    factorise_fluid_matrix(np, Ac, ratio);
+    solve_linear_systems  (np, nrhs, ratio,
+                           ratio->linsolve_buffer);
 
     /* Sum residual contributions over the connections (+ accumulation):
      *   t1 <- (Ac \ [z, Af*v]) * [-pvol; repmat(dt, [nconn, 1])] */
-    matvec(np, nconn + 1, pimpl->ratio->linsolve_buffer,
-           pimpl->ratio->coeff, pimpl->ratio->t1);
+    matvec(np, nconn + 1, ratio->linsolve_buffer,
+           ratio->coeff, ratio->t1);
 
     /* Compute residual in cell 'c' */
-    pimpl->ratio->residual = pvol;
+    ratio->residual = pvol;
     for (p = 0; p < np; p++) {
-        pimpl->ratio->residual += pimpl->ratio->t1[ p ];
+        ratio->residual += ratio->t1[ p ];
     }
 
     /* Jacobian row */
 
     vector_zero(1 + (G->cell_facepos[c + 1] - G->cell_facepos[c]),
-                pimpl->ratio->mat_row);
+                ratio->mat_row);
 
     /* t2 <- A \ ((dA/dp) * t1) */
-    matvec(np, np, dAc, pimpl->ratio->t1, pimpl->ratio->t2);
-    solve_linear_systems(np, 1, pimpl->ratio, pimpl->ratio->t2);
+    matvec(np, np, dAc, ratio->t1, ratio->t2);
+    solve_linear_systems(np, 1, ratio, ratio->t2);
 
     dF2 = 0.0;
     for (p = 0; p < np; p++) {
-        dF2 += pimpl->ratio->t2[ p ];
+        dF2 += ratio->t2[ p ];
     }
 
-    pimpl->is_incomp           = pimpl->is_incomp && (! (fabs(dF2) > 0));
-    pimpl->ratio->mat_row[ 0 ] = - dF2;
+    is_incomp           = ! (fabs(dF2) > 0);
+    ratio->mat_row[ 0 ] = - dF2;
 
     /* Accumulate inter-cell Jacobian contributions */
-    dv  = pimpl->ratio->linsolve_buffer + (1 + nconn)*np;
+    dv  = ratio->linsolve_buffer + (1 + nconn)*np;
     off = 1;
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++, off++) {
 
@@ -609,12 +675,14 @@ compute_cell_contrib(struct UnstructuredGrid  *G    ,
                 dF2 += dv2[ p ];
             }
 
-            pimpl->ratio->mat_row[  0  ] += s * dt * dF1;
-            pimpl->ratio->mat_row[ off ] += s * dt * dF2;
+            ratio->mat_row[  0  ] += s * dt * dF1;
+            ratio->mat_row[ off ] += s * dt * dF2;
 
             dv += 2 * np;       /* '2' == number of one-sided derivatives. */
         }
     }
+
+    return is_incomp;
 }
 
 
@@ -636,16 +704,17 @@ assemble_sources(double                    dt ,
 
 /* ---------------------------------------------------------------------- */
 static int
-assemble_cell_contrib(struct UnstructuredGrid  *G,
-                      int                       c,
-                      struct cfs_tpfa_res_data *h)
+assemble_cell_contrib(struct UnstructuredGrid   *G    ,
+                      int                        c    ,
+                      const struct densrat_util *ratio,
+                      struct cfs_tpfa_res_data  *h    )
 /* ---------------------------------------------------------------------- */
 {
     int c1, c2, i, f, j1, j2, off;
 
     j1 = csrmatrix_elm_index(c, c, h->J);
 
-    h->J->sa[j1] += h->pimpl->ratio->mat_row[ 0 ];
+    h->J->sa[j1] += ratio->mat_row[ 0 ];
 
     off = 1;
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++, off++) {
@@ -659,11 +728,11 @@ assemble_cell_contrib(struct UnstructuredGrid  *G,
         if (c2 >= 0) {
             j2 = csrmatrix_elm_index(c, c2, h->J);
 
-            h->J->sa[j2] += h->pimpl->ratio->mat_row[ off ];
+            h->J->sa[j2] += ratio->mat_row[ off ];
         }
     }
 
-    h->F[ c ] = h->pimpl->ratio->residual;
+    h->F[ c ] = ratio->residual;
 
     return 0;
 }
@@ -1208,7 +1277,8 @@ cfs_tpfa_res_construct(struct UnstructuredGrid   *G      ,
             h->pimpl->compflux_deriv_p               + (nphases * 2 * nwperf);
 
         h->pimpl->scratch_f        =
-            h->pimpl->flux_work                      + (nphases * (1 + 2));
+            h->pimpl->flux_work                      + (nphases * (1 + 2) *
+                                                        h->pimpl->nthreads);
     }
 
     return h;
@@ -1230,29 +1300,43 @@ cfs_tpfa_res_assemble(struct UnstructuredGrid     *G        ,
                       struct cfs_tpfa_res_data    *h        )
 /* ---------------------------------------------------------------------- */
 {
-    int res_is_neumann, well_is_neumann, c, np2, singular;
+    int res_is_neumann, well_is_neumann, c, np, np2, singular;
+    int is_incomp, cell_is_incomp;
+
+    struct densrat_util *ratio;
 
     csrmatrix_zero(         h->J);
     vector_zero   (h->J->m, h->F);
 
-    h->pimpl->is_incomp = 1;
-
     compute_compflux_and_deriv(G, cq->nphases, cpress, trans,
                                cq->phasemobf, gravcap_f, cq->Af, h->pimpl);
 
     res_is_neumann  = 1;
     well_is_neumann = 1;
 
-    np2 = cq->nphases * cq->nphases;
-    for (c = 0; c < G->number_of_cells;
-         c++, zc += cq->nphases) {
+    /* Each cell only touches its own Jacobian row and residual entry,
+     * so cells are assembled concurrently using per-thread scratch.
+     * The summation order within a row is that of the serial loop,
+     * making the result independent of the number of threads. */
+    np        = cq->nphases;
+    np2       = np * np;
+    is_incomp = 1;
+#pragma omp parallel for num_threads(h->pimpl->nthreads) \
+    private(ratio, cell_is_incomp) reduction(&&: is_incomp) schedule(static)
+    for (c = 0; c < G->number_of_cells; c++) {
+        ratio = h->pimpl->thread_ratio[ thread_num() ];
+
+        cell_is_incomp = compute_cell_contrib(G, c, np, porevol[c], dt,
+                                              zc + (c * np),
+                                              cq->Ac + (c * np2),
+                                              cq->dAc + (c * np2),
+                                              h->pimpl, ratio);
 
-        compute_cell_contrib(G, c, cq->nphases, porevol[c], dt, zc,
-                             cq->Ac + (c * np2), cq->dAc + (c * np2),
-                             h->pimpl);
+        assemble_cell_contrib(G, c, ratio, h);
 
-        assemble_cell_contrib(G, c, h);
+        is_incomp = is_incomp && cell_is_incomp;
     }
+    h->pimpl->is_incomp = is_incomp;
 
     if ((forces           != NULL) &&
         (forces->wells    != NULL) &&
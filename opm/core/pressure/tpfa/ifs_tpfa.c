@@ -20,13 +20,15 @@ mult_csr_matrix(const struct CSRMatrix *A,
                 double                 *v)
 /* ---------------------------------------------------------------------- */
 {
-    int    j;
-    size_t i;
+    int j, i, m;
 
-    for (i = 0, j = 0; i < A->m; i++) {
+    m = (int) A->m;
+
+#pragma omp parallel for private(j) schedule(static)
+    for (i = 0; i < m; i++) {
         v[i] = 0.0;
 
-        for (; j < A->ia[i + 1]; j++) {
+        for (j = A->ia[i]; j < A->ia[i + 1]; j++) {
             v[i] += A->sa[j] * u[ A->ja[j] ];
         }
     }
@@ -604,10 +606,15 @@ assemble_incompressible(struct UnstructuredGrid      *G     ,
 
     compute_grav_term(G, gpress, h->pimpl->fgrav);
 
-    for (c = i = 0; c < G->number_of_cells; c++) {
+    /* Each cell only touches its own row of the system, so the rows
+     * may be filled concurrently.  The summation order within a row
+     * is that of the serial loop, making the result independent of
+     * the number of threads. */
+#pragma omp parallel for private(c1, c2, i, f, j1, j2, s) schedule(static)
+    for (c = 0; c < G->number_of_cells; c++) {
         j1 = csrmatrix_elm_index(c, c, h->A);
 
-        for (; i < G->cell_facepos[c + 1]; i++) {
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
             f = G->cell_faces[i];
 
             c1 = G->face_cells[2*f + 0];
@@ -747,6 +754,7 @@ ifs_tpfa_assemble_comprock(struct UnstructuredGrid      *G        ,
      * after it will always be nonsingular.
      */
     if (ok) {
+#pragma omp parallel for private(j, d) schedule(static)
         for (c = 0; c < G->number_of_cells; c++) {
             j = csrmatrix_elm_index(c, c, h->A);
 
@@ -791,6 +799,7 @@ ifs_tpfa_assemble_comprock_increment(struct UnstructuredGrid      *G        ,
         v = h->pimpl->work;
         mult_csr_matrix(h->A, prev_pressure, v);
 
+#pragma omp parallel for private(j, dpvdt) schedule(static)
         for (c = 0; c < G->number_of_cells; c++) {
             j = csrmatrix_elm_index(c, c, h->A);
 
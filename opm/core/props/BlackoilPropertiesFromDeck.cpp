@@ -24,6 +24,8 @@
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/utility/compressedToCartesian.hpp>
 #include <opm/core/utility/extractPvtTableIndex.hpp>
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include <numeric>
 
@@ -177,6 +179,9 @@ namespace Opm
         SaturationPropsFromDeck* ptr
             = new SaturationPropsFromDeck();
         ptr->init(phaseUsageFromDeck(deck), materialLawManager);
+        if (param.getDefault("satfunc_tabulated", false)) {
+            ptr->tabulate(number_of_cells, param.getDefault("sat_tab_size", 200));
+        }
         satprops_.reset(ptr);
     }
 
@@ -241,6 +246,29 @@ namespace Opm
                                                double* mu,
                                                double* dmudp) const
     {
+        const int np = numPhases();
+        const int num_blocks = (n + BlockSize - 1) / BlockSize;
+#pragma omp parallel for schedule(static) if (num_blocks > MinParallelBlocks)
+        for (int b = 0; b < num_blocks; ++b) {
+            const int start = b*BlockSize;
+            const int bn = std::min(int(BlockSize), n - start);
+            viscosityBlock_(bn, p + start, T + start,
+                            z ? z + np*start : 0,
+                            cells + start,
+                            mu + np*start,
+                            dmudp ? dmudp + np*start : 0);
+        }
+    }
+
+    void BlackoilPropertiesFromDeck::viscosityBlock_(const int n,
+                                                     const double* p,
+                                                     const double* T,
+                                                     const double* z,
+                                                     const int* cells,
+                                                     double* mu,
+                                                     double* dmudp) const
+    {
+        assert(n <= BlockSize);
         const auto& pu = phaseUsage();
         const int np = numPhases();
 
@@ -255,8 +283,8 @@ namespace Opm
 
         pLad.derivatives[0] = 1.0;
 
-        R_.resize(n*np);
-        this->compute_R_(n, p, T, z, cells, &R_[0]);
+        double R[BlockSize*BlackoilPhases::MaxNumPhases];
+        this->compute_R_(n, p, T, z, cells, R);
 
         for (int i = 0; i < n; ++ i) {
             int cellIdx = cells[i];
@@ -266,29 +294,136 @@ namespace Opm
 
             if (pu.phase_used[BlackoilPhases::Aqua]) {
                 muLad = waterPvt_.viscosity(pvtRegionIdx, TLad, pLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Aqua];
+                int offset = np*i + pu.phase_pos[BlackoilPhases::Aqua];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
 
             if (pu.phase_used[BlackoilPhases::Liquid]) {
-                RsLad.value = R_[i*np + pu.phase_pos[BlackoilPhases::Liquid]];
+                RsLad.value = R[i*np + pu.phase_pos[BlackoilPhases::Liquid]];
                 muLad = oilPvt_.viscosity(pvtRegionIdx, TLad, pLad, RsLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Liquid];
+                int offset = np*i + pu.phase_pos[BlackoilPhases::Liquid];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
 
             if (pu.phase_used[BlackoilPhases::Vapour]) {
-                RvLad.value = R_[i*np + pu.phase_pos[BlackoilPhases::Vapour]];
+                RvLad.value = R[i*np + pu.phase_pos[BlackoilPhases::Vapour]];
                 muLad = gasPvt_.viscosity(pvtRegionIdx, TLad, pLad, RvLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Vapour];
+                int offset = np*i + pu.phase_pos[BlackoilPhases::Vapour];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
         }
     }
 
+    namespace
+    {
+        // Kernels for matrix() and density(), instantiated for a
+        // fixed number of phases NP so that the per-cell loops have
+        // compile-time trip counts.  NP == 0 is the generic version
+        // using the runtime number of phases.
+
+        /// Compute A = R*inv(B) and, if requested, dA/dp for n
+        /// points from the B and R factors (and their pressure
+        /// derivatives) of each phase.  The oil-gas coupling is only
+        /// present if OilAndGas.
+        template <int NP, bool OilAndGas>
+        void matrixKernel(const int n, const int num_phases,
+                          const int o, const int g,
+                          const double* Bv, const double* Rv,
+                          const double* dBv, const double* dRv,
+                          double* A, double* dAdp)
+        {
+            const int np = (NP > 0) ? NP : num_phases;
+
+            // Compute A matrix
+            for (int i = 0; i < n; ++i) {
+                double* m = A + i*np*np;
+                for (int k = 0; k < np*np; ++k) {
+                    m[k] = 0.0;
+                }
+                // Diagonal entries.
+                for (int phase = 0; phase < np; ++phase) {
+                    m[phase + phase*np] = 1.0/Bv[i*np + phase];
+                }
+                // Off-diagonal entries.
+                if (OilAndGas) {
+                    m[o + g*np] = Rv[i*np + g]/Bv[i*np + g];
+                    m[g + o*np] = Rv[i*np + o]/Bv[i*np + o];
+                }
+            }
+
+            // Derivative of A matrix.
+            // A     = R*inv(B) whence
+            //
+            // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
+            //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
+            //       = (dR/dp - A*(dB/dp)) * inv(B)
+            //
+            // The B matrix is diagonal and that fact is exploited in the
+            // following implementation.
+            if (dAdp) {
+                for (int i = 0; i < n; ++i) {
+                    const double* a  = A    + i*np*np;
+                    double*       m  = dAdp + i*np*np;
+
+                    // (1), (2): dA/dp <- -A*(dB/dp)
+                    const double* dB = & dBv[i * np];
+                    for (int col = 0; col < np; ++col) {
+                        for (int row = 0; row < np; ++row) {
+                            m[col*np + row] = a[col*np + row] * (- dB[ col ]); // Note sign.
+                        }
+                    }
+
+                    if (OilAndGas) {
+                        // (2b): dA/dp += dR/dp (== dR/dp - A*(dB/dp))
+                        const double* dR = & dRv[i * np];
+
+                        m[o*np + g] += dR[ o ];
+                        m[g*np + o] += dR[ g ];
+                    }
+
+                    // (3): dA/dp *= inv(B) (== final result)
+                    const double* B = & Bv[i * np];
+                    for (int col = 0; col < np; ++col) {
+                        for (int row = 0; row < np; ++row) {
+                            m[col*np + row] /= B[ col ];
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Compute rho = A*surface densities for n points.
+        template <int NP>
+        void densityKernel(const BlackoilPropertiesFromDeck& props,
+                           const int n, const int num_phases,
+                           const double* A, const int* cells,
+                           const int min_parallel, double* rho)
+        {
+            const int np = (NP > 0) ? NP : num_phases;
+#pragma omp parallel for schedule(static) if (n > min_parallel)
+            for (int i = 0; i < n; ++i) {
+                int cellIdx = cells?cells[i]:i;
+                const double *sdens = props.surfaceDensity(cellIdx);
+                for (int phase = 0; phase < np; ++phase) {
+                    double r = 0.0;
+                    for (int comp = 0; comp < np; ++comp) {
+                        r += A[i*np*np + np*phase + comp]*sdens[comp];
+                    }
+                    rho[np*i + phase] = r;
+                }
+            }
+        }
+    } // anonymous namespace
+
     /// \param[in]  n      Number of data points.
     /// \param[in]  p      Array of n pressure values.
     /// \param[in]  T      Array of n temperature values.
@@ -309,82 +444,61 @@ namespace Opm
                                             double* dAdp) const
     {
         const int np = numPhases();
+        const int num_blocks = (n + BlockSize - 1) / BlockSize;
+#pragma omp parallel for schedule(static) if (num_blocks > MinParallelBlocks)
+        for (int b = 0; b < num_blocks; ++b) {
+            const int start = b*BlockSize;
+            const int bn = std::min(int(BlockSize), n - start);
+            matrixBlock_(bn, p + start, T + start,
+                         z ? z + np*start : 0,
+                         cells + start,
+                         A + np*np*start,
+                         dAdp ? dAdp + np*np*start : 0);
+        }
+    }
 
-        B_.resize(n*np);
-        R_.resize(n*np);
-        if (dAdp) {
-            dB_.resize(n*np);
-            dR_.resize(n*np);
+    void BlackoilPropertiesFromDeck::matrixBlock_(const int n,
+                                                  const double* p,
+                                                  const double* T,
+                                                  const double* z,
+                                                  const int* cells,
+                                                  double* A,
+                                                  double* dAdp) const
+    {
+        assert(n <= BlockSize);
+        const int np = numPhases();
 
-            this->compute_dBdp_(n, p, T, z, cells, &B_[0], &dB_[0]);
-            this->compute_dRdp_(n, p, T, z, cells, &R_[0], &dR_[0]);
+        // Scratch space for this block only, so that concurrent
+        // calls do not share any state.
+        double Bv[BlockSize*BlackoilPhases::MaxNumPhases];
+        double Rv[BlockSize*BlackoilPhases::MaxNumPhases];
+        double dBv[BlockSize*BlackoilPhases::MaxNumPhases];
+        double dRv[BlockSize*BlackoilPhases::MaxNumPhases];
+        if (dAdp) {
+            this->compute_dBdp_(n, p, T, z, cells, Bv, dBv);
+            this->compute_dRdp_(n, p, T, z, cells, Rv, dRv);
         } else {
-            this->compute_B_(n, p, T, z, cells, &B_[0]);
-            this->compute_R_(n, p, T, z, cells, &R_[0]);
+            this->compute_B_(n, p, T, z, cells, Bv);
+            this->compute_R_(n, p, T, z, cells, Rv);
         }
         const auto& pu = phaseUsage();
-        bool oil_and_gas = pu.phase_pos[BlackoilPhases::Liquid] &&
-            pu.phase_pos[BlackoilPhases::Vapour];
+        const bool oil_and_gas = pu.phase_used[BlackoilPhases::Liquid] &&
+            pu.phase_used[BlackoilPhases::Vapour];
         const int o = pu.phase_pos[BlackoilPhases::Liquid];
         const int g = pu.phase_pos[BlackoilPhases::Vapour];
 
-        // Compute A matrix
-// #pragma omp parallel for
-        for (int i = 0; i < n; ++i) {
-            double* m = A + i*np*np;
-            std::fill(m, m + np*np, 0.0);
-            // Diagonal entries.
-            for (int phase = 0; phase < np; ++phase) {
-                m[phase + phase*np] = 1.0/B_[i*np + phase];
-            }
-            // Off-diagonal entries.
-            if (oil_and_gas) {
-                m[o + g*np] = R_[i*np + g]/B_[i*np + g];
-                m[g + o*np] = R_[i*np + o]/B_[i*np + o];
-            }
-        }
-
-        // Derivative of A matrix.
-        // A     = R*inv(B) whence
-        //
-        // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
-        //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
-        //       = (dR/dp - A*(dB/dp)) * inv(B)
-        //
-        // The B matrix is diagonal and that fact is exploited in the
-        // following implementation.
-        if (dAdp) {
-// #pragma omp parallel for
-            // (1): dA/dp <- A
-            std::copy(A, A + n*np*np, dAdp);
-
-            for (int i = 0; i < n; ++i) {
-                double*       m  = dAdp + i*np*np;
-
-                // (2): dA/dp <- -dA/dp*(dB/dp) == -A*(dB/dp)
-                const double* dB = & dB_[i * np];
-                for (int col = 0; col < np; ++col) {
-                    for (int row = 0; row < np; ++row) {
-                        m[col*np + row] *= - dB[ col ]; // Note sign.
-                    }
-                }
-
-                if (oil_and_gas) {
-                    // (2b): dA/dp += dR/dp (== dR/dp - A*(dB/dp))
-                    const double* dR = & dR_[i * np];
-
-                    m[o*np + g] += dR[ o ];
-                    m[g*np + o] += dR[ g ];
-                }
-
-                // (3): dA/dp *= inv(B) (== final result)
-                const double* B = & B_[i * np];
-                for (int col = 0; col < np; ++col) {
-                    for (int row = 0; row < np; ++row) {
-                        m[col*np + row] /= B[ col ];
-                    }
-                }
-            }
+        // Dispatch once per block to the kernel for this phase
+        // configuration: water-oil, oil-gas or full black-oil.
+        if (np == 2 && !oil_and_gas) {
+            matrixKernel<2, false>(n, np, o, g, Bv, Rv, dBv, dRv, A, dAdp);
+        } else if (np == 2) {
+            matrixKernel<2, true >(n, np, o, g, Bv, Rv, dBv, dRv, A, dAdp);
+        } else if (np == 3 && oil_and_gas) {
+            matrixKernel<3, true >(n, np, o, g, Bv, Rv, dBv, dRv, A, dAdp);
+        } else if (oil_and_gas) {
+            matrixKernel<0, true >(n, np, o, g, Bv, Rv, dBv, dRv, A, dAdp);
+        } else {
+            matrixKernel<0, false>(n, np, o, g, Bv, Rv, dBv, dRv, A, dAdp);
         }
     }
 
@@ -671,16 +785,17 @@ namespace Opm
                                              double* rho) const
     {
         const int np = numPhases();
-// #pragma omp parallel for
-        for (int i = 0; i < n; ++i) {
-            int cellIdx = cells?cells[i]:i;
-            const double *sdens = surfaceDensity(cellIdx);
-            for (int phase = 0; phase < np; ++phase) {
-                rho[np*i + phase] = 0.0;
-                for (int comp = 0; comp < np; ++comp) {
-                    rho[np*i + phase] += A[i*np*np + np*phase + comp]*sdens[comp];
-                }
-            }
+        const int min_parallel = MinParallelBlocks*BlockSize;
+        switch (np) {
+        case 2:
+            densityKernel<2>(*this, n, np, A, cells, min_parallel, rho);
+            break;
+        case 3:
+            densityKernel<3>(*this, n, np, A, cells, min_parallel, rho);
+            break;
+        default:
+            densityKernel<0>(*this, n, np, A, cells, min_parallel, rho);
+            break;
         }
     }
 
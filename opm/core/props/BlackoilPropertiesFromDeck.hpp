@@ -63,6 +63,8 @@ namespace Opm
         ///                        pvt_tab_size (200)          number of uniform sample points for dead-oil pvt tables.
         ///                        sat_tab_size (200)          number of uniform sample points for saturation tables.
         ///                        threephase_model("simple")  three-phase relperm model (accepts "simple" and "stone2").
+        ///                        satfunc_tabulated (false)   use sat_tab_size uniform table points for two-phase relperm and
+        ///                                                    capillary pressure instead of evaluating the material law.
         ///                      For both size parameters, a 0 or negative value indicates that no spline fitting is to
         ///                      be done, and the input fluid data used directly for linear interpolation.
         BlackoilPropertiesFromDeck(Opm::DeckConstPtr deck,
@@ -260,6 +262,30 @@ namespace Opm
 
         void initSurfaceDensities_(Opm::DeckConstPtr deck);
 
+        // The viscosity() and matrix() methods process the data
+        // points in blocks of BlockSize, using stack-allocated
+        // scratch arrays. This makes them re-entrant, so that a
+        // single object may be used from several threads. Calls
+        // with more than MinParallelBlocks blocks are themselves
+        // split across threads (with OpenMP).
+        enum { BlockSize = 64, MinParallelBlocks = 16 };
+
+        void viscosityBlock_(const int n,
+                             const double* p,
+                             const double* T,
+                             const double* z,
+                             const int* cells,
+                             double* mu,
+                             double* dmudp) const;
+
+        void matrixBlock_(const int n,
+                          const double* p,
+                          const double* T,
+                          const double* z,
+                          const int* cells,
+                          double* A,
+                          double* dAdp) const;
+
         void compute_B_(const int n,
                         const double* p,
                         const double* T,
@@ -316,10 +342,6 @@ namespace Opm
         std::shared_ptr<MaterialLawManager> materialLawManager_;
         std::shared_ptr<SaturationPropsInterface> satprops_;
         std::vector<double> surfaceDensities_;
-        mutable std::vector<double> B_;
-        mutable std::vector<double> dB_;
-        mutable std::vector<double> R_;
-        mutable std::vector<double> dR_;
     };
 
 
@@ -23,6 +23,7 @@
 #include <opm/core/props/IncompPropertiesBasic.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/common/ErrorMacros.hpp>
+#include <algorithm>
 #include <iostream>
 
 namespace Opm
@@ -182,5 +183,20 @@ namespace Opm
         satprops_.satRange(n, smin, smax);
     }
 
+    /// Group cells into classes with identical relative permeability
+    /// and capillary pressure functions. All cells share the same
+    /// functions.
+    /// \param[in]  n           Number of cells.
+    /// \param[in]  cells       Array of n cell indices.
+    /// \param[out] cell_class  Array of n class indices, numbered from zero.
+    /// \return     The number of classes.
+    int IncompPropertiesBasic::satFuncClasses(const int n,
+                                              const int* /*cells*/,
+                                              int* cell_class) const
+    {
+        std::fill(cell_class, cell_class + n, 0);
+        return (n > 0) ? 1 : 0;
+    }
+
 } // namespace Opm
 
@@ -164,5 +164,18 @@ namespace Opm
         satprops_.satRange(n, cells, smin, smax);
     }
 
+    /// Group cells into classes with identical relative permeability
+    /// and capillary pressure functions.
+    /// \param[in]  n           Number of cells.
+    /// \param[in]  cells       Array of n cell indices.
+    /// \param[out] cell_class  Array of n class indices, numbered from zero.
+    /// \return     The number of classes, or -1 if the cells cannot be grouped.
+    int IncompPropertiesFromDeck::satFuncClasses(const int n,
+                                                 const int* cells,
+                                                 int* cell_class) const
+    {
+        return satprops_.satFuncClasses(n, cells, cell_class);
+    }
+
 } // namespace Opm
 
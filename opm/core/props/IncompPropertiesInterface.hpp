@@ -120,6 +120,20 @@ namespace Opm
                               const int* cells,
                               double* smin,
                               double* smax) const = 0;
+
+        /// Group cells into classes with identical relative permeability
+        /// and capillary pressure functions.
+        /// \param[in]  n           Number of cells.
+        /// \param[in]  cells       Array of n cell indices.
+        /// \param[out] cell_class  Array of n class indices, numbered from zero.
+        /// \return     The number of classes, or -1 if the cells cannot be
+        ///             grouped, which is the default.
+        virtual int satFuncClasses(const int /* n */,
+                                   const int* /* cells */,
+                                   int* /* cell_class */) const
+        {
+            return -1;
+        }
     };
 
 
@@ -63,6 +63,9 @@ namespace Opm
                                const int* cells,
                                double* smin,
                                double* smax) const;
+        virtual int satFuncClasses (const int n,
+                                    const int* cells,
+                                    int* cell_class) const;
 
         /**
          * Use a different set of porosities.
@@ -72,6 +72,13 @@ namespace Opm
         prototype_.satRange (n, cells, smin, smax);
     }
 
+    inline int IncompPropertiesShadow::satFuncClasses (const int n,
+                                                       const int* cells,
+                                                       int* cell_class) const
+    {
+        return prototype_.satFuncClasses (n, cells, cell_class);
+    }
+
     /**
      * Return the new value if indicated in the bitfield, otherwise
      * use the original value from the other object.
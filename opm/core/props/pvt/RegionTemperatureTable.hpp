@@ -0,0 +1,142 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_REGION_TEMPERATURE_TABLE_HPP
+#define OPM_REGION_TEMPERATURE_TABLE_HPP
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+    /// Piecewise linear functions of temperature, one per PVT region,
+    /// stored in flat arrays. Used by the thermal PVT wrappers in place
+    /// of looking up deck table columns by name for every cell.
+    ///
+    /// Outside the temperature range of a table the end values are
+    /// used, as in SimpleTable::evaluate(), and the derivative is zero.
+    class RegionTemperatureTable
+    {
+    public:
+        RegionTemperatureTable()
+            : start_(1, 0)
+        {}
+
+        /// True if no regions have been added.
+        bool empty() const
+        {
+            return start_.size() == 1;
+        }
+
+        /// Append the table of the next region.
+        /// \param[in] temperature  Strictly increasing temperatures.
+        /// \param[in] value        Function values at the temperatures.
+        /// \param[in] scale        Factor applied to all values.
+        void addRegion(const std::vector<double>& temperature,
+                       const std::vector<double>& value,
+                       const double scale = 1.0)
+        {
+            if (temperature.empty() || temperature.size() != value.size()) {
+                OPM_THROW(std::runtime_error, "Temperature table must be non-empty "
+                          "and have one value per temperature.");
+            }
+            for (std::size_t i = 0; i < value.size(); ++i) {
+                temperature_.push_back(temperature[i]);
+                value_.push_back(scale*value[i]);
+            }
+            start_.push_back(temperature_.size());
+        }
+
+        /// Evaluate the function of one region, without derivative.
+        /// \param[in]  region  Region index, 0-based.
+        /// \param[in]  T       Temperature.
+        /// \return Function value.
+        double evaluate(const int region, const double T) const
+        {
+            const double* x = &temperature_[start_[region]];
+            const double* y = &value_[start_[region]];
+            const int num = start_[region + 1] - start_[region];
+            if (num == 1 || T <= x[0]) {
+                return y[0];
+            }
+            if (T >= x[num - 1]) {
+                return y[num - 1];
+            }
+            // x[k] < T < x[k+1]
+            const int k = std::upper_bound(x, x + num, T) - x - 1;
+            return y[k] + (y[k + 1] - y[k])/(x[k + 1] - x[k])*(T - x[k]);
+        }
+
+        /// Evaluate the function of one region.
+        /// \param[in]  region  Region index, 0-based.
+        /// \param[in]  T       Temperature.
+        /// \param[out] dvaldT  Derivative with respect to temperature.
+        /// \return Function value.
+        double evaluate(const int region, const double T, double& dvaldT) const
+        {
+            const double* x = &temperature_[start_[region]];
+            const double* y = &value_[start_[region]];
+            const int num = start_[region + 1] - start_[region];
+            if (num == 1 || T <= x[0]) {
+                dvaldT = 0.0;
+                return y[0];
+            }
+            if (T >= x[num - 1]) {
+                dvaldT = 0.0;
+                return y[num - 1];
+            }
+            // x[k] < T < x[k+1]
+            const int k = std::upper_bound(x, x + num, T) - x - 1;
+            dvaldT = (y[k + 1] - y[k])/(x[k + 1] - x[k]);
+            return y[k] + dvaldT*(T - x[k]);
+        }
+
+        /// Evaluate for n cells.
+        /// \param[in]  n       Number of cells.
+        /// \param[in]  region  Region index of each cell, 0-based. If null,
+        ///                     all cells are in region 0.
+        /// \param[in]  T       Temperature of each cell.
+        /// \param[out] val     Function value of each cell.
+        /// \param[out] dvaldT  Temperature derivative of each cell, may be null.
+        void evaluate(const int n, const int* region, const double* T,
+                      double* val, double* dvaldT) const
+        {
+            if (dvaldT) {
+                for (int i = 0; i < n; ++i) {
+                    val[i] = evaluate(region ? region[i] : 0, T[i], dvaldT[i]);
+                }
+            } else {
+                for (int i = 0; i < n; ++i) {
+                    val[i] = evaluate(region ? region[i] : 0, T[i]);
+                }
+            }
+        }
+
+    private:
+        std::vector<double> temperature_;
+        std::vector<double> value_;
+        std::vector<int> start_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_REGION_TEMPERATURE_TABLE_HPP
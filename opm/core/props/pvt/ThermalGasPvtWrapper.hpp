@@ -20,11 +20,14 @@
 #define OPM_THERMAL_GAS_PVT_WRAPPER_HPP
 
 #include <opm/core/props/pvt/PvtInterface.hpp>
+#include <opm/core/props/pvt/RegionTemperatureTable.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 #include <opm/parser/eclipse/EclipseState/Tables/GasvisctTable.hpp>
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 namespace Opm
@@ -35,6 +38,7 @@ namespace Opm
     {
     public:
         ThermalGasPvtWrapper()
+            : gasCompIdx_(0), tref_(0.0)
         {}
 
 
@@ -56,12 +60,16 @@ namespace Opm
 
             // viscosity
             if (deck->hasKeyword("GASVISCT")) {
-                gasvisctTables_ = &tables->getGasvisctTables();
-                assert(int(gasvisctTables_->size()) == numRegions);
-                static_cast<void>(numRegions); //Silence compiler warning
+                const auto& gasvisctTables = tables->getGasvisctTables();
+                assert(int(gasvisctTables.size()) == numRegions);
 
                 gasCompIdx_ = deck->getKeyword("GCOMPIDX").getRecord(0).getItem("GAS_COMPONENT_INDEX").get< int >(0) - 1;
-                gasvisctColumnName_ = "Viscosity"+std::to_string(static_cast<long long>(gasCompIdx_));
+                const std::string columnName = "Viscosity"+std::to_string(static_cast<long long>(gasCompIdx_));
+                for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+                    const GasvisctTable& gasvisctTable = gasvisctTables.getTable<GasvisctTable>(regionIdx);
+                    viscosity_.addRegion(gasvisctTable.getColumn("Temperature").vectorCopy(),
+                                         gasvisctTable.getColumn(columnName).vectorCopy());
+                }
             }
 
             // density
@@ -77,7 +85,7 @@ namespace Opm
                         const double* z,
                         double* output_mu) const
         {
-            if (gasvisctTables_)
+            if (!viscosity_.empty())
                 // TODO: temperature dependence for viscosity depending on z
                 OPM_THROW(std::runtime_error,
                           "temperature dependent viscosity as a function of z "
@@ -96,28 +104,17 @@ namespace Opm
                         double* output_dmudp,
                         double* output_dmudr) const
         {
-            if (gasvisctTables_ != 0) {
-                for (int i = 0; i < n; ++i) {
-                    // temperature dependence of the gas phase. this assumes that the gas
-                    // component index has been set properly, and it also looses the
-                    // pressure dependence of gas. (This does not make much sense, but it
-                    // seems to be what the documentation for the GASVISCT keyword in the
-                    // RM says.)
-
-
-                    int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
-                    double muGasvisct;
-                    {
-                        const GasvisctTable& gasvisctTable = gasvisctTables_->getTable<GasvisctTable>(regionIdx);
-                        muGasvisct = gasvisctTable.evaluate(gasvisctColumnName_, T[i]);
-                    }
-
-                    output_mu[i] = muGasvisct;
-                    output_dmudp[i] = 0.0;
-                    output_dmudr[i] = 0.0;
-
-                    // TODO (?): derivative of gas viscosity w.r.t. temperature.
-                }
+            if (!viscosity_.empty()) {
+                // temperature dependence of the gas phase. this assumes that the gas
+                // component index has been set properly, and it also looses the
+                // pressure dependence of gas. (This does not make much sense, but it
+                // seems to be what the documentation for the GASVISCT keyword in the
+                // RM says.)
+                viscosity_.evaluate(n, pvtRegionIdx, T, output_mu, 0);
+                std::fill(output_dmudp, output_dmudp + n, 0.0);
+                std::fill(output_dmudr, output_dmudr + n, 0.0);
+
+                // TODO (?): derivative of gas viscosity w.r.t. temperature.
             }
             else {
                 // compute the isothermal viscosity and its derivatives
@@ -135,26 +132,17 @@ namespace Opm
                         double* output_dmudp,
                         double* output_dmudr) const
         {
-            if (gasvisctTables_ != 0) {
-                for (int i = 0; i < n; ++i) {
-                    // temperature dependence of the gas phase. this assumes that the gas
-                    // component index has been set properly, and it also looses the
-                    // pressure dependence of gas. (This does not make much sense, but it
-                    // seems to be what the documentation for the GASVISCT keyword in the
-                    // RM says.)
-                    int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
-                    double muGasvisct;
-                    {
-                        const GasvisctTable& gasvisctTable = gasvisctTables_->getTable<GasvisctTable>(regionIdx);
-                        muGasvisct = gasvisctTable.evaluate(gasvisctColumnName_, T[i]);
-                    }
-
-                    output_mu[i] = muGasvisct;
-                    output_dmudp[i] = 0.0;
-                    output_dmudr[i] = 0.0;
-
-                    // TODO (?): derivative of gas viscosity w.r.t. temperature.
-                }
+            if (!viscosity_.empty()) {
+                // temperature dependence of the gas phase. this assumes that the gas
+                // component index has been set properly, and it also looses the
+                // pressure dependence of gas. (This does not make much sense, but it
+                // seems to be what the documentation for the GASVISCT keyword in the
+                // RM says.)
+                viscosity_.evaluate(n, pvtRegionIdx, T, output_mu, 0);
+                std::fill(output_dmudp, output_dmudp + n, 0.0);
+                std::fill(output_dmudr, output_dmudr + n, 0.0);
+
+                // TODO (?): derivative of gas viscosity w.r.t. temperature.
             }
             else {
                 // compute the isothermal viscosity and its derivatives
@@ -296,20 +284,12 @@ namespace Opm
         }
 
     private:
-        int getPvtRegionIndex_(const int* pvtRegionIdx, int cellIdx) const
-        {
-            if (!pvtRegionIdx)
-                return 0;
-            return pvtRegionIdx[cellIdx];
-        }
-
         // the PVT propertied for the isothermal case
         std::shared_ptr<const PvtInterface> isothermalPvt_;
 
-        // The PVT properties needed for temperature dependence of the viscosity. We need
-        // to store one value per PVT region.
-        const TableContainer* gasvisctTables_;
-        std::string gasvisctColumnName_;
+        // GASVISCT viscosity of the gas component, per PVT region. Empty if
+        // the viscosity does not depend on temperature.
+        RegionTemperatureTable viscosity_;
         int gasCompIdx_;
 
         // The PVT properties needed for temperature dependence of the density.
@@ -21,6 +21,7 @@
 #define OPM_THERMAL_OIL_PVT_WRAPPER_HPP
 
 #include <opm/core/props/pvt/PvtInterface.hpp>
+#include <opm/core/props/pvt/RegionTemperatureTable.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -36,6 +37,7 @@ namespace Opm
     {
     public:
         ThermalOilPvtWrapper()
+            : oilCompIdx_(0), tref_(0.0), pref_(0.0), cref_(0.0), thermex1_(0.0)
         {}
 
 
@@ -60,10 +62,10 @@ namespace Opm
 
             // viscosity
             if (deck->hasKeyword("VISCREF")) {
-                oilvisctTables_ = &tables->getOilvisctTables();
+                const auto& oilvisctTables = tables->getOilvisctTables();
                 const auto& viscrefKeyword = deck->getKeyword("VISCREF");
 
-                assert(int(oilvisctTables_->size()) == numRegions);
+                assert(int(oilvisctTables.size()) == numRegions);
                 assert(int(viscrefKeyword.size()) == numRegions);
 
                 viscrefPress_.resize(numRegions);
@@ -89,6 +91,13 @@ namespace Opm
                                        &muRef_[regionIdx],
                                        &tmp1,
                                        &tmp2);
+
+                    // the viscosity relative to the reference viscosity, as
+                    // a function of temperature
+                    const OilvisctTable& oilvisctTable = oilvisctTables.getTable<OilvisctTable>(regionIdx);
+                    viscosityFactor_.addRegion(oilvisctTable.getColumn("Temperature").vectorCopy(),
+                                               oilvisctTable.getColumn("Viscosity").vectorCopy(),
+                                               1.0/muRef_[regionIdx]);
                 }
             }
 
@@ -113,7 +122,7 @@ namespace Opm
                         const double* z,
                         double* output_mu) const
         {
-            if (oilvisctTables_)
+            if (!viscosityFactor_.empty())
                 // TODO: temperature dependence for viscosity depending on z
                 OPM_THROW(std::runtime_error,
                           "temperature dependent viscosity as a function of z "
@@ -135,7 +144,7 @@ namespace Opm
             // compute the isothermal viscosity and its derivatives
             isothermalPvt_->mu(n, pvtRegionIdx, p, T, r, output_mu, output_dmudp, output_dmudr);
 
-            if (!oilvisctTables_)
+            if (viscosityFactor_.empty())
                 // isothermal case
                 return;
 
@@ -143,17 +152,9 @@ namespace Opm
             for (int i = 0; i < n; ++i) {
                 int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double muRef = muRef_[regionIdx];
-
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const OilvisctTable& oilvisctTable = oilvisctTables_->getTable<OilvisctTable>(regionIdx);
-                    double muOilvisct = oilvisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muOilvisct/muRef;
-                }
+                // compute the viscosity deviation due to temperature, i.e., the
+                // OILVISCT viscosity relative to the one at the VISCREF conditions.
+                const double alpha = viscosityFactor_.evaluate(regionIdx, T[i]);
 
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
@@ -175,7 +176,7 @@ namespace Opm
             // compute the isothermal viscosity and its derivatives
             isothermalPvt_->mu(n, pvtRegionIdx, p, T, r, cond, output_mu, output_dmudp, output_dmudr);
 
-            if (!oilvisctTables_)
+            if (viscosityFactor_.empty())
                 // isothermal case
                 return;
 
@@ -183,17 +184,10 @@ namespace Opm
             for (int i = 0; i < n; ++i) {
                 int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double muRef = muRef_[regionIdx];
+                // compute the viscosity deviation due to temperature, i.e., the
+                // OILVISCT viscosity relative to the one at the VISCREF conditions.
+                const double alpha = viscosityFactor_.evaluate(regionIdx, T[i]);
 
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const OilvisctTable& oilvisctTable = oilvisctTables_->getTable<OilvisctTable>(regionIdx);
-                    double muOilvisct = oilvisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muOilvisct/muRef;
-                }
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
                 output_dmudr[i] *= alpha;
@@ -375,7 +369,9 @@ namespace Opm
         std::vector<double> viscrefRs_;
         std::vector<double> muRef_;
 
-        const TableContainer* oilvisctTables_;
+        // OILVISCT viscosity divided by muRef_, per PVT region. Empty if
+        // the viscosity does not depend on temperature.
+        RegionTemperatureTable viscosityFactor_;
 
         // The PVT properties needed for temperature dependence of the density. This is
         // specified as one value per EOS in the manual, but we unconditionally use the
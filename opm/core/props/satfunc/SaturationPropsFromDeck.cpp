@@ -28,6 +28,10 @@
 #include <opm/core/simulator/ExplicitArraysFluidState.hpp>
 #include <opm/core/simulator/ExplicitArraysSatDerivativesFluidState.hpp>
 
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <map>
 
@@ -36,11 +40,52 @@ namespace Opm
 
     typedef SaturationPropsFromDeck::MaterialLawManager::MaterialLaw MaterialLaw;
 
+    namespace
+    {
+        // Linear interpolation in the tables built by tabulate(),
+        // using the first phase saturation of each data point. The
+        // derivatives are the slopes of the interpolant. They are
+        // taken with respect to the first phase saturation only, like
+        // those of the exact two-phase law.
+        void interpolateTable(const int n,
+                              const int np,
+                              const int table_size,
+                              const double* s,
+                              const int* cells,
+                              const int* cell_class,
+                              const double* table,
+                              double* val,
+                              double* dval)
+        {
+            const double h = table_size - 1;
+            for (int i = 0; i < n; ++i) {
+                const double x = s[np*i];
+                const double t = std::min(std::max(x, 0.0), 1.0) * h;
+                const int k = std::min(static_cast<int>(t), table_size - 2);
+                const double w = t - k;
+                const double* a = table + (std::size_t(cell_class[cells[i]])*table_size + k)*np;
+                const double* b = a + np;
+                for (int j = 0; j < np; ++j) {
+                    val[np*i + j] = (1.0 - w)*a[j] + w*b[j];
+                }
+                if (dval) {
+                    // The interpolant is constant outside [0, 1].
+                    const double slope = (x >= 0.0 && x <= 1.0) ? h : 0.0;
+                    std::fill(dval + np*np*i, dval + np*np*(i + 1), 0.0);
+                    for (int j = 0; j < np; ++j) {
+                        dval[np*np*i + j] = slope*(b[j] - a[j]);
+                    }
+                }
+            }
+        }
+    } // anonymous namespace
+
     // ----------- Methods of SaturationPropsFromDeck ---------
 
 
     /// Default constructor.
     SaturationPropsFromDeck::SaturationPropsFromDeck()
+        : table_size_(0)
     {
     }
 
@@ -50,6 +95,121 @@ namespace Opm
     {
         phaseUsage_ = phaseUsage;
         materialLawManager_ = materialLawManager;
+        clearTables_();
+    }
+
+    /// Enable the tabulated evaluation of relperm() and capPress().
+    void SaturationPropsFromDeck::tabulate(const int num_cells,
+                                           const int table_size)
+    {
+        clearTables_();
+        if (numPhases() != 2 || materialLawManager_->enableHysteresis()) {
+            return;
+        }
+        if (table_size < 2) {
+            OPM_THROW(std::runtime_error, "Saturation function tables need at least 2 sample points, got " << table_size);
+        }
+        table_size_ = table_size;
+
+        std::vector<int> cell_class(num_cells);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            cell_class[cell] = tableClass_(cell);
+            if (cell_class[cell] < 0) {
+                OPM_MESSAGE("Warning: more than " << MaxSatFuncClasses
+                            << " distinct saturation function classes, using untabulated evaluation.");
+                clearTables_();
+                return;
+            }
+        }
+        cell_class_.swap(cell_class);
+    }
+
+    /// Group cells into classes with identical saturation functions.
+    int SaturationPropsFromDeck::satFuncClasses(const int n,
+                                                const int* cells,
+                                                int* cell_class) const
+    {
+        // With hysteresis the functions depend on the saturation history.
+        if (materialLawManager_->enableHysteresis()) {
+            return -1;
+        }
+
+        std::map<std::vector<double>, int> class_index;
+        std::vector<double> key;
+        for (int i = 0; i < n; ++i) {
+            satFuncKey_(cells[i], key);
+            const int next = class_index.size();
+            const int cls = class_index.insert(std::make_pair(key, next)).first->second;
+            if (cls >= MaxSatFuncClasses) {
+                return -1;
+            }
+            cell_class[i] = cls;
+        }
+        return class_index.size();
+    }
+
+    /// Without hysteresis, the saturation functions of a cell are given
+    /// by its saturation region and its scaled end-points.
+    void SaturationPropsFromDeck::satFuncKey_(const int cell,
+                                              std::vector<double>& key) const
+    {
+        const auto& eps = materialLawManager_->oilWaterScaledEpsInfoDrainage(cell);
+        key.resize(15);
+        key[0] = materialLawManager_->satnumRegionIdx(cell);
+        key[1] = eps.Swl;
+        key[2] = eps.Sgl;
+        key[3] = eps.Swcr;
+        key[4] = eps.Sgcr;
+        key[5] = eps.Sowcr;
+        key[6] = eps.Sogcr;
+        key[7] = eps.Swu;
+        key[8] = eps.Sgu;
+        key[9] = eps.maxPcow;
+        key[10] = eps.maxPcgo;
+        key[11] = eps.maxKrw;
+        key[12] = eps.maxKrow;
+        key[13] = eps.maxKrog;
+        key[14] = eps.maxKrg;
+    }
+
+    /// Find the table class of a cell, creating the tables for a new
+    /// class if necessary. Returns -1 if there are too many classes.
+    int SaturationPropsFromDeck::tableClass_(const int cell)
+    {
+        std::vector<double> key;
+        satFuncKey_(cell, key);
+        auto it = class_index_.find(key);
+        if (it != class_index_.end()) {
+            return it->second;
+        }
+        const int cls = class_index_.size();
+        if (cls >= MaxSatFuncClasses) {
+            return -1;
+        }
+        class_index_.insert(std::make_pair(key, cls));
+
+        // Sample the new class on a uniform grid.
+        const int np = numPhases();
+        std::vector<double> s(np*table_size_);
+        for (int k = 0; k < table_size_; ++k) {
+            s[np*k] = double(k)/double(table_size_ - 1);
+            s[np*k + 1] = 1.0 - s[np*k];
+        }
+        const std::vector<int> c(table_size_, cell);
+        kr_table_.resize(kr_table_.size() + np*table_size_);
+        pc_table_.resize(pc_table_.size() + np*table_size_);
+        relpermExact_(table_size_, &s[0], &c[0], &kr_table_[kr_table_.size() - np*table_size_], 0);
+        capPressExact_(table_size_, &s[0], &c[0], &pc_table_[pc_table_.size() - np*table_size_], 0);
+        return cls;
+    }
+
+    void SaturationPropsFromDeck::clearTables_()
+    {
+        table_size_ = 0;
+        cell_class_.clear();
+        kr_table_.clear();
+        pc_table_.clear();
+        class_index_.clear();
     }
 
     /// \return   P, the number of phases.
@@ -79,6 +239,20 @@ namespace Opm
     {
         assert(cells != 0);
 
+        if (tabulated()) {
+            interpolateTable(n, numPhases(), table_size_, s, cells,
+                             &cell_class_[0], &kr_table_[0], kr, dkrds);
+        } else {
+            relpermExact_(n, s, cells, kr, dkrds);
+        }
+    }
+
+    void SaturationPropsFromDeck::relpermExact_(const int n,
+                                                const double* s,
+                                                const int* cells,
+                                                double* kr,
+                                                double* dkrds) const
+    {
         const int np = numPhases();
         if (dkrds) {
             ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
@@ -138,6 +312,20 @@ namespace Opm
     {
         assert(cells != 0);
 
+        if (tabulated()) {
+            interpolateTable(n, numPhases(), table_size_, s, cells,
+                             &cell_class_[0], &pc_table_[0], pc, dpcds);
+        } else {
+            capPressExact_(n, s, cells, pc, dpcds);
+        }
+    }
+
+    void SaturationPropsFromDeck::capPressExact_(const int n,
+                                                 const double* s,
+                                                 const int* cells,
+                                                 double* pc,
+                                                 double* dpcds) const
+    {
         const int np = numPhases();
         if (dpcds) {
             ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
@@ -254,5 +442,16 @@ namespace Opm
                                                               double& swat)
     {
         swat = materialLawManager_->applySwatinit(cell, pcow, swat);
+
+        // The scaled capillary pressure may move the cell to another
+        // table class.
+        if (tabulated()) {
+            cell_class_[cell] = tableClass_(cell);
+            if (cell_class_[cell] < 0) {
+                OPM_MESSAGE("Warning: more than " << MaxSatFuncClasses
+                            << " distinct saturation function classes, using untabulated evaluation.");
+                clearTables_();
+            }
+        }
     }
 } // namespace Opm
@@ -29,6 +29,8 @@
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 
+#include <map>
+#include <memory>
 #include <vector>
 
 struct UnstructuredGrid;
@@ -72,6 +74,41 @@ namespace Opm
             init(Opm::phaseUsageFromDeck(deck), materialLawManager);
         }
 
+        /// Enable the tabulated evaluation of relperm() and capPress().
+        /// Cells are grouped by satFuncClasses(), and each class is
+        /// sampled on a uniform grid in the first phase saturation.
+        /// Subsequent evaluations interpolate linearly in these
+        /// tables, and the derivatives returned are the slopes of the
+        /// interpolant with respect to the first phase saturation.
+        /// Only two-phase systems without hysteresis are tabulated,
+        /// the saturations are assumed to sum to one. In all other
+        /// cases, or if the number of distinct classes is too large,
+        /// the exact material law evaluation is retained.
+        /// \param[in]  num_cells   Number of cells to tabulate.
+        /// \param[in]  table_size  Number of uniform sample points, at least 2.
+        void tabulate(const int num_cells,
+                      const int table_size);
+
+        /// Group cells into classes with identical saturation functions,
+        /// i.e. the same saturation region and scaled end-points.
+        /// \param[in]  n           Number of cells.
+        /// \param[in]  cells       Array of n cell indices.
+        /// \param[out] cell_class  Array of n class indices, numbered from zero.
+        /// \return     The number of classes, or -1 if hysteresis is enabled
+        ///             or there are more than MaxSatFuncClasses classes.
+        int satFuncClasses(const int n,
+                           const int* cells,
+                           int* cell_class) const;
+
+        /// Limits the number of classes, and thereby the memory used
+        /// by tables: with end-point scaling on a per-cell basis there
+        /// may be as many classes as cells, in which case tables do
+        /// not pay off.
+        enum { MaxSatFuncClasses = 1024 };
+
+        /// \return   true if relperm() and capPress() use tables.
+        bool tabulated() const { return !cell_class_.empty(); }
+
         /// \return   P, the number of phases.
         int numPhases() const;
 
@@ -134,8 +171,32 @@ namespace Opm
 
 
     private:
+        void relpermExact_(const int n,
+                           const double* s,
+                           const int* cells,
+                           double* kr,
+                           double* dkrds) const;
+
+        void capPressExact_(const int n,
+                            const double* s,
+                            const int* cells,
+                            double* pc,
+                            double* dpcds) const;
+
+        void satFuncKey_(const int cell, std::vector<double>& key) const;
+        int tableClass_(const int cell);
+        void clearTables_();
+
         std::shared_ptr<MaterialLawManager> materialLawManager_;
         PhaseUsage phaseUsage_;
+
+        // Tabulated evaluation, see tabulate(). Each table node holds
+        // the np values at one sample saturation.
+        int table_size_;
+        std::vector<int> cell_class_;
+        std::vector<double> kr_table_;
+        std::vector<double> pc_table_;
+        std::map<std::vector<double>, int> class_index_;
     };
 
 
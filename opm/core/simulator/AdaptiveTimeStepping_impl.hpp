@@ -141,9 +141,14 @@ namespace Opm {
         // create adaptive step timer with previously used sub step size
         AdaptiveSimulatorTimer substepTimer( simulatorTimer, suggested_next_timestep_, max_time_step_ );
 
-        // copy states in case solver has to be restarted (to be revised)
+        // copy states in case solver has to be restarted.  The solver
+        // updates the states in place, so one copy per attempted substep
+        // is needed; it is taken right before the attempt rather than
+        // after each accepted substep, so no copy is wasted on the last
+        // substep of the report step.
         State  last_state( state );
         WState last_well_state( well_state );
+        bool   last_state_valid = true;
 
         // counter for solver restarts
         int restarts = 0;
@@ -160,6 +165,13 @@ namespace Opm {
                           << unit::convert::to(substepTimer.currentStepLength(), unit::day) << " (days)." << std::endl;
             }
 
+            // refresh checkpoint after an accepted substep
+            if( ! last_state_valid ) {
+                last_state       = state;
+                last_well_state  = well_state;
+                last_state_valid = true;
+            }
+
             int linearIterations = -1;
             try {
                 // (linearIterations < 0 means on convergence in solver)
@@ -226,10 +238,8 @@ namespace Opm {
                 // set new time step length
                 substepTimer.provideTimeStepEstimate( dtEstimate );
 
-                // update states
-                last_state      = state ;
-                last_well_state = well_state;
-
+                // checkpoint is refreshed before the next substep, if any
+                last_state_valid = false;
             }
             else // in case of no convergence (linearIterations < 0)
             {
@@ -245,7 +255,7 @@ namespace Opm {
                     std::cerr << "Solver convergence failed, restarting solver with new time step ("
                               << unit::convert::to( newTimeStep, unit::day ) <<" days)." << std::endl;
 
-                // reset states
+                // reset states, the checkpoint remains valid
                 state      = last_state;
                 well_state = last_well_state;
 
@@ -84,6 +84,7 @@ namespace Opm
         bool output_vtk_;
         std::string output_dir_;
         int output_interval_;
+        std::unique_ptr<VtkSeriesWriter> vtk_writer_;
         // Parameters for well control
         bool check_well_controls_;
         int max_well_control_iterations_;
@@ -182,30 +183,17 @@ namespace Opm
     static void outputStateVtk(const UnstructuredGrid& grid,
                                const Opm::TwophaseState& state,
                                const int step,
-                               const std::string& output_dir)
+                               const double time,
+                               Opm::VtkSeriesWriter& vtk_writer)
     {
         // Write data in VTK format.
-        std::ostringstream vtkfilename;
-        vtkfilename << output_dir << "/vtk_files";
-        boost::filesystem::path fpath(vtkfilename.str());
-        try {
-            create_directories(fpath);
-        }
-        catch (...) {
-            OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
-        }
-        vtkfilename << "/output-" << std::setw(3) << std::setfill('0') << step << ".vtu";
-        std::ofstream vtkfile(vtkfilename.str().c_str());
-        if (!vtkfile) {
-            OPM_THROW(std::runtime_error, "Failed to open " << vtkfilename.str());
-        }
         Opm::DataMap dm;
         dm["saturation"] = &state.saturation();
         dm["pressure"] = &state.pressure();
         std::vector<double> cell_velocity;
         Opm::estimateCellVelocity(grid, state.faceflux(), cell_velocity);
         dm["velocity"] = &cell_velocity;
-        Opm::writeVtkData(grid, dm, vtkfile);
+        vtk_writer.write(dm, step, time);
     }
 
     static void outputVectorMatlab(const std::string& name,
@@ -349,11 +337,16 @@ namespace Opm
     {
         // Initialize transport solver.
         if (use_reorder_) {
-            tsolver_.reset(new Opm::TransportSolverTwophaseReorder(grid,
-                                                                   props,
-                                                                   use_segregation_split_ ? gravity : NULL,
-                                                                   param.getDefault("nl_tolerance", 1e-9),
-                                                                   param.getDefault("nl_maxiter", 30)));
+            Opm::TransportSolverTwophaseReorder* tsolver
+                = new Opm::TransportSolverTwophaseReorder(grid,
+                                                          props,
+                                                          use_segregation_split_ ? gravity : NULL,
+                                                          param.getDefault("nl_tolerance", 1e-9),
+                                                          param.getDefault("nl_maxiter", 30));
+            tsolver_.reset(tsolver);
+            tsolver->setParallelComponents(param.getDefault("parallel_components", false));
+            tsolver->setParallelGravity(param.getDefault("parallel_gravity", false));
+            tsolver->setFracFlowTable(param.getDefault("transport_fracflow_table_size", 0));
 
         } else {
             if (rock_comp_props && rock_comp_props->isActive()) {
@@ -387,6 +380,18 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
             }
             output_interval_ = param.getDefault("output_interval", 1);
+            if (output_vtk_) {
+                const std::string vtk_dir = output_dir_ + "/vtk_files";
+                boost::filesystem::path vtkpath(vtk_dir);
+                try {
+                    create_directories(vtkpath);
+                }
+                catch (...) {
+                    OPM_THROW(std::runtime_error, "Creating directories failed: " << vtkpath);
+                }
+                const std::string vtk_format = param.getDefault<std::string>("output_vtk_format", "ascii");
+                vtk_writer_.reset(new VtkSeriesWriter(grid, vtk_dir, "output", vtkDataFormatFromString(vtk_format)));
+            }
         }
 
         // Well control related init.
@@ -460,7 +465,8 @@ namespace Opm
             timer.report(*log_);
             if (output_ && (timer.currentStepNum() % output_interval_ == 0)) {
                 if (output_vtk_) {
-                    outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                    outputStateVtk(grid_, state, timer.currentStepNum(),
+                                   timer.simulationTimeElapsed(), *vtk_writer_);
                 }
                 outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
                 if (use_reorder_) {
@@ -620,7 +626,8 @@ namespace Opm
 
         if (output_) {
             if (output_vtk_) {
-                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                outputStateVtk(grid_, state, timer.currentStepNum(),
+                               timer.simulationTimeElapsed(), *vtk_writer_);
             }
             outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
             if (use_reorder_) {
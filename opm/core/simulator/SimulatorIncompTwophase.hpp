@@ -52,12 +52,20 @@ namespace Opm
         ///     output (true)                  write output to files?
         ///     output_dir ("output")          output directoty
         ///     output_interval (1)            output every nth step
+        ///     output_vtk (true)              write vtk files (with a .pvd index)?
+        ///     output_vtk_format ("ascii")    vtk data encoding: ascii, binary or compressed
         ///     nl_pressure_residual_tolerance (0.0) pressure solver residual tolerance (in Pascal)
         ///     nl_pressure_change_tolerance (1.0)   pressure solver change tolerance (in Pascal)
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
         ///     num_transport_substeps (1)     number of transport steps per pressure step
+        ///     parallel_components (false)    solve independent components of
+        ///                                    the reordered transport problem in parallel.
+        ///     parallel_gravity (false)       solve the columns of the gravity
+        ///                                    segregation problem in parallel.
+        ///     transport_fracflow_table_size (0)  if positive, tabulate fractional flow
+        ///                                    functions with this many points.
         ///     use_segregation_split (false)  solve for gravity segregation (if false,
         ///                                    segregation is ignored).
         ///
@@ -72,9 +72,29 @@ namespace Opm {
                 assert (ndof >  0);
                 assert (ndof == ndof_);
 
-                const ::std::size_t start = ia_[i*ndof + 0];
-                const ::std::size_t off   =
-                    csrmatrix_elm_index(i * ndof, j * ndof, &mat_) - start;
+                assembleBlockAt(ndof, i, blockOffset(i, j), b);
+            }
+
+            // Position of block (i,j) relative to the start of each of
+            // the rows of block row i.  Valid until the structure changes.
+            ::std::size_t
+            blockOffset(::std::size_t i, ::std::size_t j) const {
+                const ::std::size_t start = ia_[i*ndof_ + 0];
+
+                return csrmatrix_elm_index(i * ndof_, j * ndof_, &mat_) - start;
+            }
+
+            // As assembleBlock(), with the block position given by
+            // blockOffset().
+            template <class Block>
+            void
+            assembleBlockAt(::std::size_t ndof,
+                            ::std::size_t i   ,
+                            ::std::size_t off ,
+                            const Block&  b   ) {
+
+                assert (ndof >  0);
+                assert (ndof == ndof_);
 
                 for (::std::size_t row = 0; row < ndof; ++row) {
                     const ::std::size_t J = ia_[i*ndof + row] + off;
@@ -39,14 +39,26 @@
 #include <opm/core/linalg/call_umfpack.h>
 #include <opm/common/ErrorMacros.hpp>
 
+#include <memory>
+#include <stdexcept>
+
 namespace Opm
 {
     namespace ImplicitTransportLinAlgSupport
     {
 
+        /// Direct solver for the implicit transport systems. The
+        /// factorisation is kept between calls; Newton iterations
+        /// share the sparsity pattern and so only refactor numerically.
         class CSRMatrixUmfpackSolver
         {
         public:
+            CSRMatrixUmfpackSolver()
+#if HAVE_SUITESPARSE_UMFPACK_H
+                : cache_(umfpack_cache_create(), &umfpack_cache_destroy)
+#endif
+            {
+            }
 
 
             template <class Vector>
@@ -56,7 +68,9 @@ namespace Opm
                   Vector                  x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(A), b, x);
+                if (!call_UMFPACK_cached(cache_.get(), const_cast<CSRMatrix*>(A), 1, b, x)) {
+                    OPM_THROW(std::runtime_error, "UMFPACK failed to solve implicit transport system.");
+                }
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
@@ -71,7 +85,9 @@ namespace Opm
                   Vector&                 x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(&A), &b[0], &x[0]);
+                if (!call_UMFPACK_cached(cache_.get(), const_cast<CSRMatrix*>(&A), 1, &b[0], &x[0])) {
+                    OPM_THROW(std::runtime_error, "UMFPACK failed to solve implicit transport system.");
+                }
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
@@ -79,6 +95,10 @@ namespace Opm
             }
 
 
+#if HAVE_SUITESPARSE_UMFPACK_H
+        private:
+            std::shared_ptr<UMFPACKCache> cache_;
+#endif
         }; // class CSRMatrixUmfpackSolver
 
     } // namespace ImplicitTransportLinAlgSupport
@@ -52,11 +52,15 @@ namespace Opm {
               asm_buffer_()
         {}
 
+        // Create matrix structure and record the position of every
+        // block assembled by assemble(), so that assembly needs no
+        // searching.  The structure may be reused for any number of
+        // assemble() calls on the same grid.
         template <class Grid          ,
                   class JacobianSystem>
         void
         createSystem(const Grid&     g  ,//const SourceTerms* tsrc,
-                     JacobianSystem& sys) const {
+                     JacobianSystem& sys) {
 
             ::std::size_t m   = g.number_of_cells;
             ::std::size_t nnz = g.number_of_cells
@@ -80,6 +84,27 @@ namespace Opm {
             }
             */
             sys.matasm().finalizeStructure();
+
+            // Block offsets, in the order used by assembleCellContrib():
+            // diagonal first, then one per internal face of the cell.
+            conn_pos_.resize(g.number_of_cells + 1);
+            block_off_.clear();
+            block_off_.reserve(nnz);
+            conn_pos_[0] = 0;
+            for (int c = 0; c < g.number_of_cells; ++c) {
+                block_off_.push_back(sys.matasm().blockOffset(c, c));
+                for (int i = g.cell_facepos[c + 0];
+                     i     < g.cell_facepos[c + 1]; ++i) {
+                    int f  = g.cell_faces[i];
+                    int c1 = g.face_cells[2*f + 0];
+                    int c2 = g.face_cells[2*f + 1];
+
+                    if ((c1 >= 0) && (c2 >= 0)) {
+                        block_off_.push_back(sys.matasm().blockOffset(c, (c1 == c) ? c2 : c1));
+                    }
+                }
+                conn_pos_[c + 1] = block_off_.size();
+            }
         }
 
         template <class ReservoirState,
@@ -95,7 +120,7 @@ namespace Opm {
 
             for (int c = 0; c < g.number_of_cells; ++c) {
                 this->computeCellContrib(state, g, dt, c);
-                this->assembleCellContrib(g, c, sys);
+                this->assembleCellContrib(c, sys);
             }
 
             if (src != 0) {
@@ -197,10 +222,9 @@ namespace Opm {
             return 1;
         }
 
-        template <class Grid, class System>
+        template <class System>
         void
-        assembleCellContrib(const Grid& g  ,
-                            const int   c  ,
+        assembleCellContrib(const int   c  ,
                             System&     sys) const {
             const int ndof  = DofPerCell;
             const int ndof2 = ndof * ndof;
@@ -208,26 +232,21 @@ namespace Opm {
             const double* J1 = &asm_buffer_[0];
             const double* J2 = J1 + ((1*nconn_ + 1) * ndof2);
 
+            const ::std::size_t* off = &block_off_[conn_pos_[c]];
+            const ::std::size_t  diag = off[0];
+
             // Assemble contributions from accumulation term
-            sys.matasm().assembleBlock(ndof, c, c, J1);  J1 += ndof2;
+            sys.matasm().assembleBlockAt(ndof, c, diag, J1);  J1 += ndof2;
 
             // Assemble connection contributions.
-            for (int i = g.cell_facepos[c + 0];
-                 i     < g.cell_facepos[c + 1]; ++i) {
-                int f  = g.cell_faces[i];
-                int c1 = g.face_cells[2*f + 0];
-                int c2 = g.face_cells[2*f + 1];
-
-                c2 = (c1 == c) ? c2 : c1;
+            for (int conn = 1; conn <= nconn_; ++conn) {
+                sys.matasm().assembleBlockAt(ndof, c, diag     , J1);
+                sys.matasm().assembleBlockAt(ndof, c, off[conn], J2);
 
-                if (c2 >= 0) {
-                    sys.matasm().assembleBlock(ndof, c, c , J1);
-                    sys.matasm().assembleBlock(ndof, c, c2, J2);
-
-                    J1 += ndof2;
-                    J2 += ndof2;
-                }
+                J1 += ndof2;
+                J2 += ndof2;
             }
+
             // Assemble residual
             const double* F = &asm_buffer_[(2*nconn_ + 1) * ndof2];
             for (int conn = 0; conn < nconn_ + 2; ++conn, F += ndof) {
@@ -254,14 +273,16 @@ namespace Opm {
 
                 const int c = src->cell[i];
 
-                sys.matasm().assembleBlock(ndof, c, c, J);
-                sys.vector().assembleBlock(ndof, c,    F);
+                sys.matasm().assembleBlockAt(ndof, c, block_off_[conn_pos_[c]], J);
+                sys.vector().assembleBlock(ndof, c, F);
             }
         }
 
         Model&              model_     ;
         int                 nconn_     ;
         std::vector<double> asm_buffer_;
+        std::vector<std::size_t> conn_pos_;   // block_off_ of cell c start at conn_pos_[c]
+        std::vector<std::size_t> block_off_;  // see createSystem()
     };
 }
 #endif  /* OPM_IMPLICITASSEMBLY_HPP_HEADER */
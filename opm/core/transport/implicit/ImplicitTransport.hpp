@@ -106,9 +106,22 @@ namespace Opm {
     public:
         ImplicitTransport(Model& model)
             : model_(model),
-              asm_  (model)
+              asm_  (model),
+              sys_grid_(0),
+              sys_cells_(-1),
+              sys_faces_(-1),
+              sys_facepos_(0),
+              sys_faces_of_cells_(0),
+              sys_face_cells_(0)
         {}
 
+        /// Discard the system structure, so that it is recreated by
+        /// the next solve().  Needed if the grid is modified in place
+        /// without changing its size or arrays.
+        void resetStructure() {
+            sys_grid_ = 0;
+        }
+
         template <class Grid          ,
                   class SourceTerms   ,
                   class ReservoirState,
@@ -124,7 +137,16 @@ namespace Opm {
             typedef typename JacobianSystem::vector_type vector_type;
             typedef typename JacobianSystem::matrix_type matrix_type;
 
-            asm_.createSystem(g, sys_);
+            // The system structure only depends on the grid.
+            if (! sameStructure(g)) {
+                asm_.createSystem(g, sys_);
+                sys_grid_           = &g;
+                sys_cells_          = g.number_of_cells;
+                sys_faces_          = g.number_of_faces;
+                sys_facepos_        = g.cell_facepos;
+                sys_faces_of_cells_ = g.cell_faces;
+                sys_face_cells_     = g.face_cells;
+            }
             model_.initStep(state, g, sys_);
             init = model_.initIteration(state, g, sys_);
 
@@ -162,18 +184,22 @@ namespace Opm {
                 bool finished=rpt.norm_res<ctrl.atol;
                 double alpha=2.0;
                 // store old solution and increment before line search
-                vector_type dx_old(sys_.vector().increment());
-                vector_type x_old(sys_.vector().solution());
+                dx_old_ = sys_.vector().increment();
+                x_old_  = sys_.vector().solution();
                 while(! finished){
                     alpha/=2.0;
-                    VAsgn<vector_type>::assign(alpha, dx_old,
+                    VAsgn<vector_type>::assign(alpha, dx_old_,
                                                sys_.vector().writableIncrement());
-                    VAsgn<vector_type>::assign(x_old,
+                    VAsgn<vector_type>::assign(x_old_,
                                                sys_.vector().writableSolution());
 
                     sys_.vector().addIncrement();
                     init = model_.initIteration(state, g, sys_);
                     if (init) {
+                        // The model evaluates residual and Jacobian
+                        // together, so the full system is assembled.
+                        // The one from the accepted trial is the
+                        // Jacobian of the next Newton iteration.
                         MZero<matrix_type>::zero(sys_.writableMatrix());
                         VZero<vector_type>::zero(sys_.vector().writableResidual());
                         asm_.assemble(state, g, src, dt, sys_);
@@ -219,6 +245,18 @@ namespace Opm {
         ImplicitTransport           (const ImplicitTransport&);
         ImplicitTransport& operator=(const ImplicitTransport&);
 
+        // A grid reallocated at the same address is unlikely to get
+        // the same size and topology arrays, so these are compared too.
+        template <class Grid>
+        bool sameStructure(const Grid& g) const {
+            return (sys_grid_           == &g)
+                && (sys_cells_          == g.number_of_cells)
+                && (sys_faces_          == g.number_of_faces)
+                && (sys_facepos_        == g.cell_facepos)
+                && (sys_faces_of_cells_ == g.cell_faces)
+                && (sys_face_cells_     == g.face_cells);
+        }
+
 #if 0
         using Model::initStep;
         using Model::initIteration;
@@ -229,6 +267,17 @@ namespace Opm {
         Model&                  model_;
         ImplicitAssembly<Model> asm_;
         JacobianSystem          sys_;
+        // Grid for which sys_ was created, see sameStructure().
+        const void*             sys_grid_;
+        int                     sys_cells_;
+        int                     sys_faces_;
+        const void*             sys_facepos_;
+        const void*             sys_faces_of_cells_;
+        const void*             sys_face_cells_;
+
+        // Line search workspace.
+        typename JacobianSystem::vector_type dx_old_;
+        typename JacobianSystem::vector_type x_old_;
     };
 }
 #endif  /* OPM_IMPLICITTRANSPORT_HPP_HEADER */
@@ -204,6 +204,13 @@ namespace Opm {
             void
             assembleBlock(size_t n, size_t i, size j, const Block& b);
 
+            size_t
+            blockOffset(size_t i, size_t j) const;
+
+            template <class Block>
+            void
+            assembleBlockAt(size_t n, size_t i, size_t off, const Block& b);
+
             template <class Connections>
             void
             createBlockRow(size_t i, const Connections& conn, size_t n);
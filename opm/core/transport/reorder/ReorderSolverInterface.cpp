@@ -23,44 +23,209 @@
 #include <opm/core/grid.h>
 #include <opm/core/utility/StopWatch.hpp>
 
-#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <exception>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 
-void Opm::ReorderSolverInterface::reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux)
+Opm::ReorderSolverInterface::ReorderSolverInterface()
+    : ordered_grid_(0),
+      parallel_components_(false),
+      have_levels_(false)
+{
+}
+
+
+void Opm::ReorderSolverInterface::setParallelComponents(const bool parallel)
+{
+    parallel_components_ = parallel;
+}
+
+
+bool Opm::ReorderSolverInterface::parallelComponents() const
+{
+    return parallel_components_;
+}
+
+
+bool Opm::ReorderSolverInterface::updateOrdering(const UnstructuredGrid& grid, const double* darcyflux)
 {
-    // Compute reordered sequence of single-cell problems
+    // Record the sign pattern of the flux, and check whether it
+    // matches the one the current ordering was computed for.
+    const int nf = grid.number_of_faces;
+    bool same = (ordered_grid_ == &grid) && (int(flux_sign_.size()) == nf);
+    flux_sign_.resize(nf);
+    for (int f = 0; f < nf; ++f) {
+        const signed char sign = (darcyflux[f] > 0.0) - (darcyflux[f] < 0.0);
+        same = same && (flux_sign_[f] == sign);
+        flux_sign_[f] = sign;
+    }
+    if (same) {
+        return false;
+    }
+
+    // Compute reordered sequence of single-cell problems. We always
+    // keep the upwind graph, it is needed to find the dependencies
+    // between the strongly connected components.
     sequence_.resize(grid.number_of_cells);
     components_.resize(grid.number_of_cells + 1);
+    ia_upw_.resize(grid.number_of_cells + 1);
+    ja_upw_.resize(grid.number_of_faces);
     int ncomponents;
     time::StopWatch clock;
     clock.start();
-    compute_sequence(&grid, darcyflux, &sequence_[0], &components_[0], &ncomponents);
+    compute_sequence_graph(&grid, darcyflux, &sequence_[0], &components_[0], &ncomponents,
+                           &ia_upw_[0], &ja_upw_[0]);
     clock.stop();
     std::cout << "Topological sort took: " << clock.secsSinceStart() << " seconds." << std::endl;
 
     // Make vector's size match actual used data.
     components_.resize(ncomponents + 1);
 
-    // Invoke appropriate solve method for each interdependent component.
-    for (int comp = 0; comp < ncomponents; ++comp) {
+    ordered_grid_ = &grid;
+    have_levels_ = false;
+    return true;
+}
+
+
+void Opm::ReorderSolverInterface::downwindGraph(std::vector<int>& ia, std::vector<int>& ja) const
+{
+    assert(!ia_upw_.empty());
+    const int num_cells = ia_upw_.size() - 1;
+    ia.assign(num_cells + 1, 0);
+    for (int cell = 0; cell < num_cells; ++cell) {
+        for (int j = ia_upw_[cell]; j < ia_upw_[cell + 1]; ++j) {
+            ++ia[ja_upw_[j] + 1];
+        }
+    }
+    std::partial_sum(ia.begin(), ia.end(), ia.begin());
+    ja.resize(ia[num_cells]);
+    std::vector<int> pos(ia.begin(), ia.end() - 1);
+    for (int cell = 0; cell < num_cells; ++cell) {
+        for (int j = ia_upw_[cell]; j < ia_upw_[cell + 1]; ++j) {
+            ja[pos[ja_upw_[j]]++] = cell;
+        }
+    }
+}
+
+
+void Opm::ReorderSolverInterface::reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux)
+{
+    updateOrdering(grid, darcyflux);
+    const int ncomponents = components_.size() - 1;
+
+    if (!parallel_components_) {
+        // Invoke appropriate solve method for each interdependent component.
+        for (int comp = 0; comp < ncomponents; ++comp) {
 #if 0
 #ifdef MATLAB_MEX_FILE
-	// \TODO replace this with general signal handling code, check if it costs performance.
-        if (interrupt_signal) {
-            mexPrintf("Reorder loop interrupted by user: %d of %d "
-                      "cells finished.\n", i, grid.number_of_cells);
-            break;
-        }
+            // \TODO replace this with general signal handling code, check if it costs performance.
+            if (interrupt_signal) {
+                mexPrintf("Reorder loop interrupted by user: %d of %d "
+                          "cells finished.\n", i, grid.number_of_cells);
+                break;
+            }
 #endif
 #endif
-	const int comp_size = components_[comp + 1] - components_[comp];
-	if (comp_size == 1) {
-	    solveSingleCell(sequence_[components_[comp]]);
-	} else {
-	    solveMultiCell(comp_size, &sequence_[components_[comp]]);
-	}
+            solveComponent(comp);
+        }
+        return;
+    }
+
+    // Solve the components level by level. All components on a
+    // level are independent of each other, and only depend on
+    // components of previous levels.
+    if (!have_levels_) {
+        computeComponentLevels(grid.number_of_cells, ncomponents);
+        have_levels_ = true;
+    }
+    const int num_levels = level_start_.size() - 1;
+    for (int level = 0; level < num_levels; ++level) {
+        const int first = level_start_[level];
+        const int num_comps = level_start_[level + 1] - first;
+        // Exceptions must not escape the parallel region, so we
+        // store the first one thrown and rethrow it afterwards.
+        std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int i = 0; i < num_comps; ++i) {
+            try {
+                solveComponent(level_comps_[first + i]);
+            } catch (...) {
+#pragma omp critical(ReorderSolverInterface_error)
+                {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+
+void Opm::ReorderSolverInterface::solveComponent(const int comp)
+{
+    const int comp_size = components_[comp + 1] - components_[comp];
+    if (comp_size == 1) {
+        solveSingleCell(sequence_[components_[comp]]);
+    } else {
+        solveMultiCell(comp_size, &sequence_[components_[comp]]);
+    }
+}
+
+
+// Assign each strongly connected component to a level, such that
+// every component only has upwind neighbours in earlier levels:
+//     level(c) = 1 + max { level(u) : u upwind of c },
+// and level(c) = 0 for components without upwind neighbours.
+// Since the components are already in topological order, a single
+// pass over the sequence suffices.  The result is stored as a
+// compressed array of components per level.
+void Opm::ReorderSolverInterface::computeComponentLevels(const int num_cells,
+                                                         const int num_components)
+{
+    std::vector<int> comp_of_cell(num_cells);
+    for (int comp = 0; comp < num_components; ++comp) {
+        for (int i = components_[comp]; i < components_[comp + 1]; ++i) {
+            comp_of_cell[sequence_[i]] = comp;
+        }
+    }
+
+    std::vector<int> comp_level(num_components, 0);
+    int num_levels = 0;
+    for (int comp = 0; comp < num_components; ++comp) {
+        int level = 0;
+        for (int i = components_[comp]; i < components_[comp + 1]; ++i) {
+            const int cell = sequence_[i];
+            for (int j = ia_upw_[cell]; j < ia_upw_[cell + 1]; ++j) {
+                const int upw_comp = comp_of_cell[ja_upw_[j]];
+                if (upw_comp != comp) {
+                    assert(upw_comp < comp);
+                    level = std::max(level, comp_level[upw_comp] + 1);
+                }
+            }
+        }
+        comp_level[comp] = level;
+        num_levels = std::max(num_levels, level + 1);
+    }
+
+    // Bucket the components by level, preserving the
+    // topological order within each level.
+    level_start_.assign(num_levels + 1, 0);
+    for (int comp = 0; comp < num_components; ++comp) {
+        ++level_start_[comp_level[comp] + 1];
+    }
+    std::partial_sum(level_start_.begin(), level_start_.end(), level_start_.begin());
+    level_comps_.resize(num_components);
+    std::vector<int> pos(level_start_.begin(), level_start_.end() - 1);
+    for (int comp = 0; comp < num_components; ++comp) {
+        level_comps_[pos[comp_level[comp]]++] = comp;
     }
 }
 
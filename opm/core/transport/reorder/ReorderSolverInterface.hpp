@@ -38,17 +38,62 @@ namespace Opm
     class ReorderSolverInterface
     {
     public:
-    virtual ~ReorderSolverInterface() {}
+        ReorderSolverInterface();
+        virtual ~ReorderSolverInterface() {}
+
+        /// Choose whether reorderAndTransport() should solve mutually
+        /// independent strongly connected components concurrently.
+        /// The components are grouped into levels of the condensed
+        /// (component) upwind graph, such that all components of a
+        /// level only depend on components of earlier levels. All
+        /// components on a level are then solved in parallel, using
+        /// OpenMP. Without OpenMP support the levels are processed
+        /// sequentially, giving the same result as the serial mode.
+        /// Note that in this mode solveSingleCell() and solveMultiCell()
+        /// will be called from several threads simultaneously, and must
+        /// therefore only modify data associated with their own cells.
+        /// \param[in] parallel   If true, enable parallel component solves.
+        void setParallelComponents(const bool parallel);
+
+        /// \return true if parallel component solves are enabled.
+        bool parallelComponents() const;
+
     private:
 	virtual void solveSingleCell(const int cell) = 0;
 	virtual void solveMultiCell(const int num_cells, const int* cells) = 0;
     protected:
 	void reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux);
+        /// Make sequence(), components() and the upwind graph match the
+        /// given flux field. The ordering only depends on the sign of
+        /// the flux on each face, so it is recomputed only if that sign
+        /// pattern differs from the one of the previous call. Called by
+        /// reorderAndTransport(), subclasses only need to call it if they
+        /// need the ordering or graphs before that.
+        /// \return true if the ordering was recomputed.
+        bool updateOrdering(const UnstructuredGrid& grid, const double* darcyflux);
+        /// Compute the downwind graph of the current ordering, i.e. for
+        /// each cell the cells that it is upwind of, in compressed
+        /// format (ia, ja). It is the transpose of the upwind graph, and
+        /// equal to the upwind graph of the negated flux.
+        void downwindGraph(std::vector<int>& ia, std::vector<int>& ja) const;
         const std::vector<int>& sequence() const;
         const std::vector<int>& components() const;
     private:
+        void computeComponentLevels(const int num_cells, const int num_components);
+        void solveComponent(const int comp);
+
         std::vector<int> sequence_;
         std::vector<int> components_;
+        std::vector<int> ia_upw_;         // Upwind graph, from compute_sequence_graph().
+        std::vector<int> ja_upw_;
+        // Ordering cache.
+        const UnstructuredGrid* ordered_grid_; // Grid of the current ordering, if any.
+        std::vector<signed char> flux_sign_;   // Sign of flux per face, for the current ordering.
+        // For parallel component solves.
+        bool parallel_components_;
+        bool have_levels_;                // level_* valid for the current ordering.
+        std::vector<int> level_start_;    // Components of level l are
+        std::vector<int> level_comps_;    // level_comps_[level_start_[l] ... level_start_[l+1]-1].
     };
 
 
@@ -22,7 +22,6 @@
 #include <opm/core/transport/reorder/TransportSolverCompressibleTwophaseReorder.hpp>
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/grid.h>
-#include <opm/core/transport/reorder/reordersequence.h>
 #include <opm/core/utility/RootFinders.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/miscUtilitiesBlackoil.hpp>
@@ -57,8 +56,6 @@ namespace Opm
           fractionalflow_(grid.number_of_cells, -1.0),
           gravity_(0),
           mob_(2*grid.number_of_cells, -1.0),
-          ia_upw_(grid.number_of_cells + 1, -1),
-          ja_upw_(grid.number_of_faces, -1),
           ia_downw_(grid.number_of_cells + 1, -1),
           ja_downw_(grid.number_of_faces, -1)
     {
@@ -104,18 +101,10 @@ namespace Opm
             OPM_THROW(std::runtime_error, "TransportModelCompressibleTwophase requires a property object without miscibility.");
         }
 
-        std::vector<int> seq(grid_.number_of_cells);
-        std::vector<int> comp(grid_.number_of_cells + 1);
-        int ncomp;
-        compute_sequence_graph(&grid_, darcyflux_,
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_upw_[0], &ja_upw_[0]);
-        const int nf = grid_.number_of_faces;
-        std::vector<double> neg_darcyflux(nf);
-        std::transform(darcyflux, darcyflux + nf, neg_darcyflux.begin(), std::negate<double>());
-        compute_sequence_graph(&grid_, &neg_darcyflux[0],
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_downw_[0], &ja_downw_[0]);
+        // The downwind graph only changes with the flux sign pattern.
+        if (updateOrdering(grid_, darcyflux)) {
+            downwindGraph(ia_downw_, ja_downw_);
+        }
         reorderAndTransport(grid_, darcyflux);
         toBothSat(saturation_, saturation);
 
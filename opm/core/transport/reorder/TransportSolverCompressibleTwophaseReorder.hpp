@@ -120,9 +120,7 @@ namespace Opm
         std::vector<double> mob_;
         std::vector<double> s0_;
 
-        // Storing the upwind and downwind graphs for experiments.
-        std::vector<int> ia_upw_;
-        std::vector<int> ja_upw_;
+        // Storing the downwind graph for experiments.
         std::vector<int> ia_downw_;
         std::vector<int> ja_downw_;
 
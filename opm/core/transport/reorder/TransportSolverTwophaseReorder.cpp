@@ -21,12 +21,14 @@
 #include <opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp>
 #include <opm/core/props/IncompPropertiesInterface.hpp>
 #include <opm/core/grid.h>
-#include <opm/core/transport/reorder/reordersequence.h>
 #include <opm/core/grid/ColumnExtract.hpp>
 #include <opm/core/utility/RootFinders.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <iostream>
 #include <fstream>
 #include <iterator>
@@ -58,13 +60,13 @@ namespace Opm
           saturation_(grid.number_of_cells, -1.0),
           fractionalflow_(grid.number_of_cells, -1.0),
           reorder_iterations_(grid.number_of_cells, 0),
-          mob_(2*grid.number_of_cells, -1.0)
+          mob_(2*grid.number_of_cells, -1.0),
+          parallel_gravity_(false)
 #ifdef EXPERIMENT_GAUSS_SEIDEL
-        , ia_upw_(grid.number_of_cells + 1, -1),
-          ja_upw_(grid.number_of_faces, -1),
-          ia_downw_(grid.number_of_cells + 1, -1),
+        , ia_downw_(grid.number_of_cells + 1, -1),
           ja_downw_(grid.number_of_faces, -1)
 #endif
+        , fracflow_table_size_(0)
     {
         if (props.numPhases() != 2) {
             OPM_THROW(std::runtime_error, "Property object must have 2 phases");
@@ -102,18 +104,10 @@ namespace Opm
         toWaterSat(state.saturation(), saturation_);
 
 #ifdef EXPERIMENT_GAUSS_SEIDEL
-        std::vector<int> seq(grid_.number_of_cells);
-        std::vector<int> comp(grid_.number_of_cells + 1);
-        int ncomp;
-        compute_sequence_graph(&grid_, darcyflux_,
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_upw_[0], &ja_upw_[0]);
-        const int nf = grid_.number_of_faces;
-        std::vector<double> neg_darcyflux(nf);
-        std::transform(darcyflux_, darcyflux_ + nf, neg_darcyflux.begin(), std::negate<double>());
-        compute_sequence_graph(&grid_, &neg_darcyflux[0],
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_downw_[0], &ja_downw_[0]);
+        // The downwind graph only changes with the flux sign pattern.
+        if (updateOrdering(grid_, darcyflux_)) {
+            downwindGraph(ia_downw_, ja_downw_);
+        }
 #endif
         std::fill(reorder_iterations_.begin(),reorder_iterations_.end(),0);
         reorderAndTransport(grid_, darcyflux_);
@@ -127,6 +121,67 @@ namespace Opm
     }
 
 
+    void TransportSolverTwophaseReorder::setFracFlowTable(const int table_size)
+    {
+        fracflow_class_.clear();
+        fracflow_table_.clear();
+        fracflow_table_size_ = 0;
+        if (table_size <= 0) {
+            return;
+        }
+        if (table_size < 2) {
+            OPM_THROW(std::runtime_error, "Fractional flow tables need at least 2 sample points, got " << table_size);
+        }
+
+        // Cells with the same saturation functions share one table.
+        const int num_cells = grid_.number_of_cells;
+        std::vector<int> cells(num_cells);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            cells[cell] = cell;
+        }
+        std::vector<int> cell_class(num_cells);
+        const int num_classes = (num_cells > 0)
+            ? props_.satFuncClasses(num_cells, &cells[0], &cell_class[0]) : -1;
+        if (num_classes < 0) {
+            OPM_MESSAGE("Warning: saturation functions cannot be grouped into classes, "
+                        "fractional flow is not tabulated.");
+            return;
+        }
+
+        // Tabulate the fractional flow of one cell per class.
+        std::vector<int> sample_cell(num_classes, -1);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            if (sample_cell[cell_class[cell]] < 0) {
+                sample_cell[cell_class[cell]] = cell;
+            }
+        }
+        std::vector<double> table(std::size_t(num_classes)*table_size);
+        for (int cls = 0; cls < num_classes; ++cls) {
+            for (int k = 0; k < table_size; ++k) {
+                table[std::size_t(cls)*table_size + k]
+                    = fracFlowExact(double(k)/double(table_size - 1), sample_cell[cls]);
+            }
+        }
+        fracflow_class_.swap(cell_class);
+        fracflow_table_.swap(table);
+        fracflow_table_size_ = table_size;
+    }
+
+
+    inline double TransportSolverTwophaseReorder::fracFlow(double s, int cell) const
+    {
+        if (fracflow_class_.empty()) {
+            return fracFlowExact(s, cell);
+        }
+        const int n = fracflow_table_size_;
+        const double t = std::min(std::max(s, 0.0), 1.0)*(n - 1);
+        const int k = std::min(static_cast<int>(t), n - 2);
+        const double w = t - k;
+        const double* f = &fracflow_table_[std::size_t(fracflow_class_[cell])*n + k];
+        return (1.0 - w)*f[0] + w*f[1];
+    }
+
+
     // Residual function r(s) for a single-cell implicit Euler transport
     //
     //     r(s) = s - s0 + dt/pv*( influx + outflux*f(s) )
@@ -455,7 +510,7 @@ namespace Opm
 #endif // EXPERIMENT_GAUSS_SEIDEL
     }
 
-    double TransportSolverTwophaseReorder::fracFlow(double s, int cell) const
+    double TransportSolverTwophaseReorder::fracFlowExact(double s, int cell) const
     {
         double sat[2] = { s, 1.0 - s };
         double mob[2];
@@ -565,6 +620,16 @@ namespace Opm
     void TransportSolverTwophaseReorder::initColumns()
     {
         extractColumn(grid_, columns_);
+
+        // Longest columns first, for load balance when solving in parallel.
+        const int ncol = columns_.size();
+        column_order_.resize(ncol);
+        for (int col = 0; col < ncol; ++col) {
+            column_order_[col] = col;
+        }
+        std::stable_sort(column_order_.begin(), column_order_.end(),
+                         [this](const int a, const int b)
+                         { return columns_[a].size() > columns_[b].size(); });
     }
 
 
@@ -606,9 +671,9 @@ namespace Opm
         }
 
         // Store initial saturation s0
-        s0_.resize(nc);
+        std::vector<double> s0(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
+            s0[ci] = saturation_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -620,9 +685,9 @@ namespace Opm
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
+                saturation_[cells[ci]] = s0[ci];
                 solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
+                saturation_[cells[ci2]] = s0[ci2];
                 solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
                 max_s_change = std::max(max_s_change, std::max(std::fabs(saturation_[cells[ci]] - old_s[0]),
                                                                std::fabs(saturation_[cells[ci2]] - old_s[1])));
@@ -662,18 +727,66 @@ namespace Opm
         dt_ = dt;
         toWaterSat(state.saturation(), saturation_);
 
-        // Solve on all columns.
-        int num_iters = 0;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns_.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns_[i]);
+        // Solve on all columns. The columns have no cells in common,
+        // so they may be solved in any order, or concurrently.
+        const int ncol = columns_.size();
+        column_iterations_.assign(ncol, 0);
+        if (parallel_gravity_) {
+            // Exceptions must not escape the parallel region, so we
+            // store the first one thrown and rethrow it afterwards.
+            std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int i = 0; i < ncol; ++i) {
+                const int col = column_order_[i];
+                try {
+                    column_iterations_[col] = solveGravityColumn(columns_[col]);
+                } catch (...) {
+#pragma omp critical(TransportSolverTwophaseReorder_error)
+                    {
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        } else {
+            for (int col = 0; col < ncol; ++col) {
+                column_iterations_[col] = solveGravityColumn(columns_[col]);
+            }
+        }
+
+        // Report iteration statistics.
+        if (ncol > 0) {
+            const int num_iters = std::accumulate(column_iterations_.begin(), column_iterations_.end(), 0);
+            const int max_col = std::max_element(column_iterations_.begin(), column_iterations_.end())
+                - column_iterations_.begin();
+            std::cout << "Gauss-Seidel column solver iterations: average "
+                      << double(num_iters)/double(ncol)
+                      << ", max " << column_iterations_[max_col]
+                      << " (column " << max_col << " with " << columns_[max_col].size() << " cells)"
+                      << std::endl;
         }
-        std::cout << "Gauss-Seidel column solver average iterations: "
-                  << double(num_iters)/double(columns_.size()) << std::endl;
 
         toBothSat(saturation_, state.saturation());
     }
 
+
+
+    void TransportSolverTwophaseReorder::setParallelGravity(const bool parallel)
+    {
+        parallel_gravity_ = parallel;
+    }
+
+
+
+    const std::vector<int>& TransportSolverTwophaseReorder::getGravityColumnIterations() const
+    {
+        return column_iterations_;
+    }
+
 } // namespace Opm
 
 
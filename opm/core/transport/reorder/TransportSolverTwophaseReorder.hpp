@@ -68,6 +68,10 @@ namespace Opm
         /// This uses a column-wise nonlinear Gauss-Seidel approach.
         /// It assumes that the grid can be divided into vertical columns
         /// that do not interact with each other (for gravity segregation).
+        /// If parallel gravity is enabled (see setParallelGravity())
+        /// the columns are solved concurrently, longest columns first.
+        /// Each column is solved independently of the others, so the
+        /// result does not depend on the number of threads.
         /// \param[in] porevolume        Array of pore volumes.
         /// \param[in] dt                Time step.
         /// \param[in, out] state        Reservoir state. Calling solveGravity() will read state.faceflux() and
@@ -76,10 +80,36 @@ namespace Opm
                           const double dt,
                           TwophaseState& state);
 
+        /// Solve independent strongly connected components in parallel.
+        /// See ReorderSolverInterface::setParallelComponents().
+        using ReorderSolverInterface::setParallelComponents;
+
+        /// Solve the columns of solveGravity() in parallel, using OpenMP.
+        /// This is independent of setParallelComponents().
+        /// \param[in] parallel   If true, enable parallel column solves.
+        void setParallelGravity(const bool parallel);
+
+        /// Use tabulated fractional flow functions in the single-cell solves.
+        /// Cells in the same class of IncompPropertiesInterface::satFuncClasses()
+        /// share one table of fractional flow values, sampled uniformly
+        /// in water saturation and interpolated linearly. This avoids
+        /// calling the property object in every root finder iteration.
+        /// Linear interpolation keeps the tabulated function monotone
+        /// where the exact one is, as the root finder requires. If the
+        /// property object cannot group the cells, the exact fractional
+        /// flow is used.
+        /// \param[in] table_size   Number of sample points, 0 to disable tables.
+        void setFracFlowTable(const int table_size);
+
         //// Return the number of iterations used by the reordering solver.
         //// \return vector of iteration per cell
         const std::vector<int>& getReorderIterations() const;
 
+        /// Return the number of Gauss-Seidel sweeps used per column by
+        /// the last call to solveGravity().
+        /// \return vector of sweeps per column
+        const std::vector<int>& getGravityColumnIterations() const;
+
     private:
         void initGravity(const double* grav);
         void initColumns();
@@ -110,17 +140,24 @@ namespace Opm
         // For gravity segregation.
         std::vector<double> gravflux_;
         std::vector<double> mob_;
-        std::vector<double> s0_;
         std::vector<std::vector<int> > columns_;
+        std::vector<int> column_order_;         // column indices by decreasing length
+        std::vector<int> column_iterations_;    // one per column
+        bool parallel_gravity_;                 // solve columns concurrently
 
-        // Storing the upwind and downwind graphs for experiments.
-        std::vector<int> ia_upw_;
-        std::vector<int> ja_upw_;
+        // Storing the downwind graph for experiments.
         std::vector<int> ia_downw_;
         std::vector<int> ja_downw_;
 
+        // Tabulated fractional flow, see setFracFlowTable().
+        // One table of fracflow_table_size_ values per class.
+        std::vector<int> fracflow_class_;   // one per cell, empty if not tabulated
+        std::vector<double> fracflow_table_;
+        int fracflow_table_size_;
+
         struct Residual;
         double fracFlow(double s, int cell) const;
+        double fracFlowExact(double s, int cell) const;
 
         struct GravityResidual;
         void mobility(double s, int cell, double* mob) const;
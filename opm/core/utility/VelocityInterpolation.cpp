@@ -169,14 +169,25 @@ namespace Opm
     {
         const int n = bcmethod_.numCorners(cell);
         const int dim = grid_.dimensions;
-        bary_coord_.resize(n);
-        bcmethod_.cartToBary(cell, x, &bary_coord_[0]);
+        // Local storage, so that interpolate() may be called
+        // from multiple threads simultaneously.  Cells rarely have
+        // more corners than fit on the stack, so the heap is only
+        // used as a fallback.
+        enum { MaxStackCorners = 16 };
+        double stack_coord[MaxStackCorners];
+        std::vector<double> heap_coord;
+        double* bary_coord = stack_coord;
+        if (n > MaxStackCorners) {
+            heap_coord.resize(n);
+            bary_coord = &heap_coord[0];
+        }
+        bcmethod_.cartToBary(cell, x, bary_coord);
         std::fill(v, v + dim, 0.0);
         const SparseTable<WachspressCoord::CornerInfo>& all_ci = bcmethod_.cornerInfo();
         for (int i = 0; i < n; ++i) {
             const int cid = all_ci[cell][i].corner_id;
             for (int dd = 0; dd < dim; ++dd) {
-                v[dd] += corner_velocity_[dim*cid + dd] * bary_coord_[i];
+                v[dd] += corner_velocity_[dim*cid + dd] * bary_coord[i];
             }
         }
     }
@@ -110,7 +110,6 @@ namespace Opm
     private:
         WachspressCoord bcmethod_;
         const UnstructuredGrid& grid_;
-        mutable std::vector<double> bary_coord_;
         std::vector<double> corner_velocity_; // size = dim * #corners
     };
 
@@ -38,6 +38,7 @@
 #include <string>
 #include <utility>
 #include <iostream>
+#include <limits>
 
 namespace
 {
@@ -391,22 +392,38 @@ namespace Opm
         well_collection_.applyExplicitReinjectionControls(well_reservoirrates_phase, well_surfacerates_phase);
     }
 
-    void WellsManager::setupCompressedToCartesian(const int* global_cell, int number_of_cells,
-                                                  std::map<int,int>& cartesian_to_compressed ) {
+    WellsManager::CartesianToCompressed::CartesianToCompressed(const int* global_cell,
+                                                              int number_of_cells)
+        : global_cell_(global_cell),
+          number_of_cells_(number_of_cells)
+    {
         // global_cell is a map from compressed cells to Cartesian grid cells.
         // We must make the inverse lookup.
-
-        if (global_cell) {
-            for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(global_cell[i], i));
-            }
-        }
-        else {
+        if (global_cell && !std::is_sorted(global_cell, global_cell + number_of_cells)) {
+            sorted_.reserve(number_of_cells);
             for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(i, i));
+                sorted_.push_back(std::make_pair(global_cell[i], i));
             }
+            std::sort(sorted_.begin(), sorted_.end());
         }
+    }
 
+
+
+    int WellsManager::CartesianToCompressed::find(int cartesian_index) const
+    {
+        // For repeated Cartesian indices, the lowest compressed index is used.
+        if (!sorted_.empty()) {
+            const std::pair<int, int> key(cartesian_index, std::numeric_limits<int>::min());
+            const auto it = std::lower_bound(sorted_.begin(), sorted_.end(), key);
+            return (it != sorted_.end() && it->first == cartesian_index) ? it->second : -1;
+        }
+        if (!global_cell_) {
+            return (cartesian_index >= 0 && cartesian_index < number_of_cells_) ? cartesian_index : -1;
+        }
+        const int* end = global_cell_ + number_of_cells_;
+        const int* it = std::lower_bound(global_cell_, end, cartesian_index);
+        return (it != end && *it == cartesian_index) ? int(it - global_cell_) : -1;
     }
 
 
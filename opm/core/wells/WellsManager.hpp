@@ -29,6 +29,9 @@
 
 #include <opm/core/utility/CompressedPropertyAccess.hpp>
 
+#include <utility>
+#include <vector>
+
 struct Wells;
 struct UnstructuredGrid;
 
@@ -157,7 +160,23 @@ namespace Opm
         // Disable copying and assignment.
         WellsManager(const WellsManager& other);
         WellsManager& operator=(const WellsManager& other);
-        static void setupCompressedToCartesian(const int* global_cell, int number_of_cells, std::map<int,int>& cartesian_to_compressed );
+
+        /// Lookup of compressed cell indices from Cartesian indices.
+        /// When global_cell is sorted, as for grids from the corner-point
+        /// processing, it is searched directly and no index is built.
+        /// Otherwise a sorted copy is made once.
+        class CartesianToCompressed
+        {
+        public:
+            CartesianToCompressed(const int* global_cell, int number_of_cells);
+            /// Compressed index of a Cartesian cell, -1 if not in the grid.
+            int find(int cartesian_index) const;
+        private:
+            const int* global_cell_;
+            int number_of_cells_;
+            std::vector<std::pair<int, int> > sorted_;
+        };
+
         void setupWellControls(std::vector<WellConstPtr>& wells, size_t timeStep,
                                std::vector<std::string>& well_names, const PhaseUsage& phaseUsage,
                                const std::vector<int>& wells_on_proc);
@@ -173,7 +192,7 @@ namespace Opm
                                    std::vector<WellData>& well_data,
                                    std::map<std::string, int> & well_names_to_index,
                                    const PhaseUsage& phaseUsage,
-                                   const std::map<int,int>& cartesian_to_compressed,
+                                   const CartesianToCompressed& cartesian_to_compressed,
                                    const double* permeability,
                                    const NTG& ntg,
                                    std::vector<int>& wells_on_proc);
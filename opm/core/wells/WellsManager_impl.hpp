@@ -116,7 +116,7 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
                                         std::vector<WellData>& well_data,
                                         std::map<std::string, int>& well_names_to_index,
                                         const PhaseUsage& phaseUsage,
-                                        const std::map<int,int>& cartesian_to_compressed,
+                                        const CartesianToCompressed& cartesian_to_compressed,
                                         const double* permeability,
                                         const NTG& ntg,
                                         std::vector<int>& wells_on_proc)
@@ -157,8 +157,8 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
 
                     const int* cpgdim = cart_dims;
                     int cart_grid_indx = i + cpgdim[0]*(j + cpgdim[1]*k);
-                    std::map<int, int>::const_iterator cgit = cartesian_to_compressed.find(cart_grid_indx);
-                    if (cgit == cartesian_to_compressed.end()) {
+                    const int cell = cartesian_to_compressed.find(cart_grid_indx);
+                    if (cell < 0) {
                         if ( is_parallel_run_ )
                         {
                             completion_on_proc[c]=0;
@@ -173,7 +173,6 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
                     }
                     else
                     {
-                        int cell = cgit->second;
                         PerfData pd;
                         pd.cell = cell;
                         {
@@ -359,9 +358,7 @@ WellsManager::init(const Opm::EclipseStateConstPtr eclipseState,
         return;
     }
 
-    std::map<int,int> cartesian_to_compressed;
-    setupCompressedToCartesian(global_cell, number_of_cells,
-                               cartesian_to_compressed);
+    const CartesianToCompressed cartesian_to_compressed(global_cell, number_of_cells);
 
     // Obtain phase usage data.
     PhaseUsage pu = phaseUsageFromDeck(eclipseState);
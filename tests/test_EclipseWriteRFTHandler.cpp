@@ -232,3 +232,156 @@ BOOST_AUTO_TEST_CASE(test_EclipseWriterRFTHandler)
 
 
 
+namespace {
+
+/// The deck of test_EclipseWriterRFTHandler, with RFT output requested
+/// at 10 OKT 2008 and/or 10 NOV 2008.
+std::string rftDeckString(bool rftOkt, bool rftNov)
+{
+    std::string deck =
+        "RUNSPEC\n"
+        "OIL\n"
+        "GAS\n"
+        "WATER\n"
+        "DIMENS\n"
+        " 10 10 10 /\n"
+        "GRID\n"
+        "DXV\n"
+        "10*0.25 /\n"
+        "DYV\n"
+        "10*0.25 /\n"
+        "DZV\n"
+        "10*0.25 /\n"
+        "TOPS\n"
+        "100*0.25 /\n"
+        "\n"
+        "START             -- 0 \n"
+        "1 NOV 1979 / \n"
+        "SCHEDULE\n"
+        "DATES             -- 1\n"
+        " 1 DES 1979/ \n"
+        "/\n"
+        "WELSPECS\n"
+        "    'OP_1'       'OP'   9   9 1*     'OIL' 1*      1*  1*   1*  1*   1*  1*  / \n"
+        "    'OP_2'       'OP'   4   4 1*     'OIL' 1*      1*  1*   1*  1*   1*  1*  / \n"
+        "/\n"
+        "COMPDAT\n"
+        " 'OP_1'  9  9   1   1 'OPEN' 1*   32.948   0.311  3047.839 1*  1*  'X'  22.100 / \n"
+        " 'OP_1'  9  9   2   2 'OPEN' 1*   46.825   0.311  4332.346 1*  1*  'X'  22.123 / \n"
+        " 'OP_1'  9  9   3  9 'OPEN' 1*   32.948   0.311  3047.839 1*  1*  'X'  22.100 / \n"
+        " 'OP_2'  4  4   4  9 'OPEN' 1*   32.948   0.311  3047.839 1*  1*  'X'  22.100 / \n"
+        "/\n"
+        "DATES             -- 2\n"
+        " 10  OKT 2008 / \n"
+        "/\n";
+    if (rftOkt) {
+        deck +=
+            "WRFT \n"
+            "/ \n";
+    }
+    deck +=
+        "WELOPEN\n"
+        " 'OP_1' OPEN / \n"
+        " 'OP_2' OPEN / \n"
+        "/\n"
+        "DATES             -- 3\n"
+        " 10  NOV 2008 / \n"
+        "/\n";
+    if (rftNov) {
+        deck +=
+            "WRFT \n"
+            "/ \n";
+    }
+    deck +=
+        "DATES             -- 4\n"
+        " 10  DES 2008 / \n"
+        "/\n";
+    return deck;
+}
+
+
+
+/// Run the writer through the whole schedule of the deck.  With
+/// substeps, every step is written once more as the last substep of
+/// the step, at the same time.
+void writeAllSteps(const std::string& deckString, bool substeps)
+{
+    std::shared_ptr<const Opm::Deck>   deck         = createDeck(deckString);
+    std::shared_ptr<Opm::EclipseState> eclipseState = std::make_shared<Opm::EclipseState>(deck , Opm::ParseContext());
+
+    std::shared_ptr<Opm::SimulatorTimer> simulatorTimer = std::make_shared<Opm::SimulatorTimer>();
+    simulatorTimer->init(eclipseState->getSchedule()->getTimeMap());
+
+    std::shared_ptr<Opm::GridManager>  ourFineGridManagerPtr = std::make_shared<Opm::GridManager>(eclipseState->getEclipseGrid());
+    const UnstructuredGrid &ourFinerUnstructuredGrid = *ourFineGridManagerPtr->c_grid();
+    const int* compressedToCartesianCellIdx = Opm::UgGridHelpers::globalCell(ourFinerUnstructuredGrid);
+
+    std::shared_ptr<Opm::EclipseWriter> eclipseWriter = createEclipseWriter(deck,
+                                                                            eclipseState,
+                                                                            ourFineGridManagerPtr,
+                                                                            compressedToCartesianCellIdx);
+    eclipseWriter->writeInit(*simulatorTimer);
+
+    for (; simulatorTimer->currentStepNum() < simulatorTimer->numSteps(); ++ (*simulatorTimer)) {
+        std::shared_ptr<Opm::BlackoilState> blackoilState2 = createBlackoilState(simulatorTimer->currentStepNum(),ourFineGridManagerPtr);
+        std::shared_ptr<Opm::WellState> wellState = createWellState(blackoilState2);
+        if (substeps) {
+            eclipseWriter->writeTimeStep(*simulatorTimer, *blackoilState2, *wellState, true);
+        }
+        eclipseWriter->writeTimeStep(*simulatorTimer, *blackoilState2, *wellState, false);
+    }
+}
+
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_EclipseWriterRFTHandlerNoDuplicates)
+{
+    test_work_area_type * new_ptr = test_work_area_alloc("test_EclipseWriterRFTHandlerNoDuplicates");
+    std::shared_ptr<test_work_area_type> test_area;
+    test_area.reset(new_ptr, test_work_area_free);
+
+    // A substep ending on the report step time must not add a second
+    // record for the same well and date.
+    writeAllSteps(rftDeckString(true, false), true);
+
+    std::string cwd(test_work_area_get_cwd(test_area.get()));
+    std::string rft_filename = cwd + "/TESTCASE.RFT";
+    std::shared_ptr<ecl_rft_file_type> rft_file(ecl_rft_file_alloc(rft_filename.c_str()), ecl_rft_file_free);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_size(rft_file.get()), 2);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_well_occurences(rft_file.get(), "OP_1"), 1);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_well_occurences(rft_file.get(), "OP_2"), 1);
+    verifyRFTFile(rft_filename);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_EclipseWriterRFTHandlerRestart)
+{
+    test_work_area_type * new_ptr = test_work_area_alloc("test_EclipseWriterRFTHandlerRestart");
+    std::shared_ptr<test_work_area_type> test_area;
+    test_area.reset(new_ptr, test_work_area_free);
+
+    std::string cwd(test_work_area_get_cwd(test_area.get()));
+    std::string rft_filename = cwd + "/TESTCASE.RFT";
+
+    // The first run writes both dates.
+    writeAllSteps(rftDeckString(true, true), false);
+    {
+        std::shared_ptr<ecl_rft_file_type> rft_file(ecl_rft_file_alloc(rft_filename.c_str()), ecl_rft_file_free);
+        BOOST_CHECK_EQUAL(ecl_rft_file_get_size(rft_file.get()), 4);
+    }
+
+    // The second run, as after a restart, first writes at 10 NOV 2008.
+    // The records of 10 OKT 2008 are kept, and those of 10 NOV 2008 are
+    // replaced instead of duplicated.
+    writeAllSteps(rftDeckString(false, true), false);
+    std::shared_ptr<ecl_rft_file_type> rft_file(ecl_rft_file_alloc(rft_filename.c_str()), ecl_rft_file_free);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_size(rft_file.get()), 4);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_well_occurences(rft_file.get(), "OP_1"), 2);
+    BOOST_CHECK_EQUAL(ecl_rft_file_get_well_occurences(rft_file.get(), "OP_2"), 2);
+    time_t november = util_make_datetime(0, 0, 0, 10, 11, 2008);
+    BOOST_CHECK(ecl_rft_file_get_well_time_rft(rft_file.get(), "OP_1", november) != NULL);
+    verifyRFTFile(rft_filename);
+}
@@ -0,0 +1,161 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE AsyncOutputWriterTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/AsyncOutputWriter.hpp>
+#include <opm/core/simulator/BlackoilState.hpp>
+#include <opm/core/simulator/WellState.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Opm;
+
+namespace {
+
+/// Fixed-step timer starting on 2015-01-01.
+class StepTimer : public SimulatorTimerInterface {
+public:
+    StepTimer () : step_ (0) { }
+    virtual int currentStepNum () const { return step_; }
+    virtual double currentStepLength () const { return 10.0; }
+    virtual double stepLengthTaken () const { return 10.0; }
+    virtual double simulationTimeElapsed () const { return 10.0 * step_; }
+    virtual void advance () { ++step_; }
+    virtual bool done () const { return step_ >= 100; }
+    virtual boost::posix_time::ptime startDateTime () const {
+        return boost::posix_time::ptime (boost::gregorian::date (2015, 1, 1));
+    }
+private:
+    int step_;
+};
+
+/// Records what it is asked to write, slowly.  The methods run on
+/// the writer thread, where Boost.Test must not be used, so they only
+/// record; the checks are made on the main thread after sync().
+struct RecordingWriter : public OutputWriter {
+    RecordingWriter (int failAt = -1) : failAt_ (failAt) { }
+
+    virtual void writeInit (const SimulatorTimerInterface& timer) {
+        initSteps.push_back (timer.currentStepNum ());
+    }
+
+    virtual void writeTimeStep (const SimulatorTimerInterface& timer,
+                                const SimulatorState& state,
+                                const WellState& wellState,
+                                bool /* isSubstep */) {
+        std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        if (timer.currentStepNum () == failAt_) {
+            throw std::runtime_error ("write failed");
+        }
+        blackoil.push_back (dynamic_cast <const BlackoilState*> (&state) != 0);
+        steps.push_back (timer.currentStepNum ());
+        pressures.push_back (state.pressure ()[0]);
+        bhps.push_back (wellState.bhp ().empty () ? 0.0 : wellState.bhp ()[0]);
+        times.push_back (timer.simulationTimeElapsed ());
+    }
+
+    std::vector <int> initSteps;
+    std::vector <bool> blackoil;
+    std::vector <int> steps;
+    std::vector <double> pressures;
+    std::vector <double> bhps;
+    std::vector <double> times;
+
+private:
+    int failAt_;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (SnapshotsAreWrittenInOrder)
+{
+    RecordingWriter* rec = new RecordingWriter ();
+    AsyncOutputWriter writer (std::unique_ptr <OutputWriter> (rec), 2);
+
+    StepTimer timer;
+    BlackoilState state;
+    state.init (4, 0, 3);
+    WellState wellState;
+    wellState.bhp ().resize (1);
+
+    writer.writeInit (timer);
+    for (int step = 1; step <= 10; ++step) {
+        timer.advance ();
+        state.pressure ()[0] = 100.0 * step;
+        wellState.bhp ()[0] = 2.0 * step;
+        writer.writeTimeStep (timer, state, wellState, false);
+        // the simulator is free to modify its state right away
+        state.pressure ()[0] = -1.0;
+        wellState.bhp ()[0] = -1.0;
+    }
+    writer.sync ();
+
+    BOOST_REQUIRE_EQUAL (rec->initSteps.size (), 1u);
+    BOOST_CHECK_EQUAL (rec->initSteps[0], 0);
+    BOOST_REQUIRE_EQUAL (rec->steps.size (), 10u);
+    for (int i = 0; i < 10; ++i) {
+        // the snapshot must keep the dynamic type of the state
+        BOOST_CHECK (rec->blackoil[i]);
+        BOOST_CHECK_EQUAL (rec->steps[i], i + 1);
+        BOOST_CHECK_EQUAL (rec->pressures[i], 100.0 * (i + 1));
+        BOOST_CHECK_EQUAL (rec->bhps[i], 2.0 * (i + 1));
+        BOOST_CHECK_EQUAL (rec->times[i], 10.0 * (i + 1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (WriterErrorsReachTheCaller)
+{
+    AsyncOutputWriter writer (std::unique_ptr <OutputWriter> (new RecordingWriter (3)), 1);
+
+    StepTimer timer;
+    BlackoilState state;
+    state.init (4, 0, 3);
+    WellState wellState;
+
+    bool thrown = false;
+    try {
+        for (int step = 1; step <= 10; ++step) {
+            timer.advance ();
+            writer.writeTimeStep (timer, state, wellState, false);
+        }
+        writer.sync ();
+    }
+    catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    BOOST_CHECK (thrown);
+
+    // the error is reported once; later output proceeds
+    timer.advance ();
+    writer.writeTimeStep (timer, state, wellState, false);
+    BOOST_CHECK_NO_THROW (writer.sync ());
+}
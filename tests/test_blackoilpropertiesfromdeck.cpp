@@ -0,0 +1,166 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE BlackoilPropertiesFromDeckTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/props/BlackoilPhases.hpp>
+#include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Deck with live oil and wet gas, with or without water.
+std::string deckString(const bool water)
+{
+    return std::string("RUNSPEC\n"
+                       "DIMENS\n 1 1 1 /\n")
+        + (water ? "WATER\n" : "")
+        + "OIL\nGAS\nDISGAS\nVAPOIL\n"
+        "METRIC\n"
+        "TABDIMS\n/\n"
+        "GRID\n"
+        "DX\n 1 /\nDY\n 1 /\nDZ\n 1 /\nTOPS\n 0 /\n"
+        "PORO\n 0.3 /\n"
+        "PERMX\n 100 /\nPERMY\n 100 /\nPERMZ\n 100 /\n"
+        "PROPS\n"
+        "PVTO\n"
+        "  10    50  1.10  1.0\n"
+        "       150  1.08  1.1 /\n"
+        "  30   150  1.20  0.9\n"
+        "       250  1.18  1.0 /\n"
+        "/\n"
+        "PVTG\n"
+        "   50  1.0e-4  0.020  0.015\n"
+        "       0.0     0.021  0.014 /\n"
+        "  150  4.0e-4  0.008  0.020\n"
+        "       0.0     0.009  0.019 /\n"
+        "/\n"
+        "SGOF\n"
+        "  0.0  0.0  1.0  0.0\n"
+        "  0.8  1.0  0.0  0.0 /\n"
+        + (water ?
+           "SWOF\n"
+           "  0.2  0.0  1.0  0.0\n"
+           "  1.0  1.0  0.0  0.0 /\n"
+           "PVTW\n"
+           "  1.0  1.0  4.0e-5  0.5  0.0 /\n" : "")
+        + "DENSITY\n"
+        "  800  1000  1 /\n";
+}
+
+struct Fixture {
+    explicit Fixture(const bool water)
+        : gm(1, 1, 1, 1.0, 1.0, 1.0)
+    {
+        Opm::ParserPtr parser(new Opm::Parser());
+        Opm::ParseContext parseContext;
+        deck = parser->parseString(deckString(water), parseContext);
+        eclipseState.reset(new Opm::EclipseState(deck, parseContext));
+        props.reset(new Opm::BlackoilPropertiesFromDeck(deck, eclipseState,
+                                                         *gm.c_grid(), false));
+    }
+
+    /// Compute A and dA/dp at a single pressure with abundant oil
+    /// and gas, so that both are saturated.
+    void matrix(std::vector<double>& A, std::vector<double>& dAdp) const
+    {
+        const Opm::PhaseUsage& pu = props->phaseUsage();
+        const int np = props->numPhases();
+
+        std::vector<double> z(np, 0.0);
+        if (pu.phase_used[Opm::BlackoilPhases::Aqua]) {
+            z[pu.phase_pos[Opm::BlackoilPhases::Aqua]] = 0.1;
+        }
+        z[pu.phase_pos[Opm::BlackoilPhases::Liquid]] = 1.0;
+        z[pu.phase_pos[Opm::BlackoilPhases::Vapour]] = 100.0;
+
+        const double p = 100.0e5;
+        const double T = 300.0;
+        const int cell = 0;
+
+        A.assign(np*np, 0.0);
+        dAdp.assign(np*np, 0.0);
+        props->matrix(1, &p, &T, &z[0], &cell, &A[0], &dAdp[0]);
+    }
+
+    Opm::GridManager gm;
+    Opm::DeckConstPtr deck;
+    Opm::EclipseStateConstPtr eclipseState;
+    std::unique_ptr<Opm::BlackoilPropertiesFromDeck> props;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (TwoPhaseOilGasCoupling)
+{
+    // The oil-gas part of A = R*inv(B) must not depend on whether
+    // water is present.  In particular, the Rs/Rv off-diagonals must
+    // be present in a two-phase oil-gas run.
+    Fixture twophase(false);
+    Fixture threephase(true);
+
+    const Opm::PhaseUsage& pu2 = twophase.props->phaseUsage();
+    const Opm::PhaseUsage& pu3 = threephase.props->phaseUsage();
+    BOOST_REQUIRE_EQUAL (pu2.num_phases, 2);
+    BOOST_REQUIRE_EQUAL (pu3.num_phases, 3);
+
+    std::vector<double> A2, dA2, A3, dA3;
+    twophase.matrix(A2, dA2);
+    threephase.matrix(A3, dA3);
+
+    const int o2 = pu2.phase_pos[Opm::BlackoilPhases::Liquid];
+    const int g2 = pu2.phase_pos[Opm::BlackoilPhases::Vapour];
+    const int o3 = pu3.phase_pos[Opm::BlackoilPhases::Liquid];
+    const int g3 = pu3.phase_pos[Opm::BlackoilPhases::Vapour];
+
+    // Gas dissolved in oil and oil vaporised in gas.
+    BOOST_CHECK (A2[g2 + o2*2] > 0.0);
+    BOOST_CHECK (A2[o2 + g2*2] > 0.0);
+
+    const int p2[] = { o2, g2 };
+    const int p3[] = { o3, g3 };
+    for (int col = 0; col < 2; ++col) {
+        for (int row = 0; row < 2; ++row) {
+            const int k2 = p2[row] + p2[col]*2;
+            const int k3 = p3[row] + p3[col]*3;
+            BOOST_CHECK_CLOSE (A2[k2], A3[k3], 1.0e-10);
+            BOOST_CHECK_CLOSE (dA2[k2], dA3[k3], 1.0e-10);
+        }
+    }
+}
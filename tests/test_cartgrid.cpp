@@ -33,8 +33,10 @@
 
 /* --- our own headers --- */
 #include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid/cornerpoint_grid.h>
 #include <opm/core/grid.h>
 #include <stdio.h>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE ()
 
@@ -55,4 +57,42 @@ BOOST_AUTO_TEST_CASE (facenumbers)
     destroy_grid(g);
 }
 
+BOOST_AUTO_TEST_CASE (tensor3dGeometry)
+{
+    // The closed-form tensor grid geometry must agree with the
+    // general polyhedral geometry computed from the nodes.
+    const double x[] = { 0.0, 1.0, 1.5, 3.5 };
+    const double y[] = { 0.0, 2.0, 2.25 };
+    const double z[] = { 1.0, 1.5, 2.5, 2.75, 4.0 };
+
+    struct UnstructuredGrid *g = create_grid_tensor3d(3, 2, 4, x, y, z, NULL);
+
+    const int nc = g->number_of_cells;
+    const int nf = g->number_of_faces;
+
+    std::vector<double> cvol  (g->cell_volumes,   g->cell_volumes   + 1*nc);
+    std::vector<double> ccent (g->cell_centroids, g->cell_centroids + 3*nc);
+    std::vector<double> farea (g->face_areas,     g->face_areas     + 1*nf);
+    std::vector<double> fcent (g->face_centroids, g->face_centroids + 3*nf);
+    std::vector<double> fnorm (g->face_normals,   g->face_normals   + 3*nf);
+
+    compute_geometry(g);
+
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_CLOSE (g->cell_volumes[c], cvol[c], 1.0e-10);
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_CLOSE (g->cell_centroids[3*c + d], ccent[3*c + d], 1.0e-10);
+        }
+    }
+    for (int f = 0; f < nf; ++f) {
+        BOOST_CHECK_CLOSE (g->face_areas[f], farea[f], 1.0e-10);
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_CLOSE (g->face_centroids[3*f + d], fcent[3*f + d], 1.0e-10);
+            BOOST_CHECK_SMALL (g->face_normals[3*f + d] - fnorm[3*f + d], 1.0e-12);
+        }
+    }
+
+    destroy_grid(g);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,289 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CornerPointPreprocessTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/core/grid/cpgpreprocess/preprocess.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+/// Corner-point description of an nx-by-ny-by-nz box with slanted
+/// pillars.  If faulted, it has crossing faults in both directions
+/// and some inactive cells.
+struct Deck {
+    Deck (int nx, int ny, int nz, bool faulted)
+        : coord  (6 * (nx + 1) * (ny + 1)),
+          zcorn  (8 * nx * ny * nz),
+          actnum (nx * ny * nz, 1)
+    {
+        for (int j = 0; j <= ny; ++j) {
+            for (int i = 0; i <= nx; ++i) {
+                double* c = &coord[6 * (i + (nx + 1)*j)];
+                c[0] = i;  c[1] = j;  c[2] = 0.0;
+                c[3] = i + 0.1*j;  c[4] = j;  c[5] = nz;
+            }
+        }
+
+        for (int k = 0; k < 2*nz; ++k) {
+            for (int j = 0; j < 2*ny; ++j) {
+                for (int i = 0; i < 2*nx; ++i) {
+                    const int ci = i / 2, cj = j / 2;
+                    double z = (k + 1) / 2;
+                    if (faulted) {
+                        if (ci >= nx/2) { z += (j % 2) ? 0.45 : -0.45; }
+                        if (cj >= ny/2) { z += (i % 2) ? -0.3 :  0.3;  }
+                        z += 0.01 * ((ci*7 + cj*3) % 5);
+                    }
+                    zcorn[i + 2*nx*(j + 2*ny*k)] = z;
+                }
+            }
+        }
+
+        // Make every pillar's z values non-decreasing.
+        for (int j = 0; j < 2*ny; ++j) {
+            for (int i = 0; i < 2*nx; ++i) {
+                for (int k = 1; k < 2*nz; ++k) {
+                    double& a = zcorn[i + 2*nx*(j + 2*ny*(k - 1))];
+                    double& b = zcorn[i + 2*nx*(j + 2*ny*k)];
+                    b = std::max(a, b);
+                }
+            }
+        }
+
+        if (faulted) {
+            for (std::size_t c = 0; c < actnum.size(); c += 13) {
+                actnum[c] = 0;
+            }
+        }
+
+        grdecl.dims[0] = nx;
+        grdecl.dims[1] = ny;
+        grdecl.dims[2] = nz;
+        grdecl.coord   = &coord[0];
+        grdecl.zcorn   = &zcorn[0];
+        grdecl.actnum  = &actnum[0];
+        grdecl.mapaxes = 0;
+    }
+
+    std::vector<double> coord;
+    std::vector<double> zcorn;
+    std::vector<int>    actnum;
+    struct grdecl       grdecl;
+};
+
+struct Processed {
+    explicit Processed (const Deck& deck) {
+        process_grdecl(&deck.grdecl, 0.0, &g);
+    }
+
+    ~Processed () { free_processed_grid(&g); }
+
+    struct processed_grid g;
+};
+
+void checkTopology(const struct processed_grid& g)
+{
+    const int nglobal = g.dimensions[0] * g.dimensions[1] * g.dimensions[2];
+
+    BOOST_REQUIRE (g.number_of_cells > 0);
+    for (int c = 0; c < g.number_of_cells; ++c) {
+        BOOST_REQUIRE (0 <= g.local_cell_index[c]);
+        BOOST_REQUIRE (g.local_cell_index[c] < nglobal);
+        if (c > 0) {
+            BOOST_REQUIRE (g.local_cell_index[c - 1] < g.local_cell_index[c]);
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL (g.face_ptr[0], 0);
+    for (int f = 0; f < g.number_of_faces; ++f) {
+        BOOST_REQUIRE (g.face_ptr[f + 1] - g.face_ptr[f] >= 3);
+
+        for (int i = g.face_ptr[f]; i < g.face_ptr[f + 1]; ++i) {
+            BOOST_REQUIRE (0 <= g.face_nodes[i]);
+            BOOST_REQUIRE (g.face_nodes[i] < g.number_of_nodes);
+        }
+
+        const int* n = g.face_neighbors + 2*f;
+        BOOST_REQUIRE ((n[0] >= 0) || (n[1] >= 0));
+        BOOST_REQUIRE (n[0] < g.number_of_cells);
+        BOOST_REQUIRE (n[1] < g.number_of_cells);
+    }
+}
+
+/// Check that the outward face normals of every cell sum to zero,
+/// i.e. that each cell's boundary is closed.  This holds exactly only
+/// if no face has nodes on fault intersections.
+void checkClosedCells(const UnstructuredGrid& g)
+{
+    for (int c = 0; c < g.number_of_cells; ++c) {
+        double s[3] = { 0.0, 0.0, 0.0 };
+        double a    = 0.0;
+
+        for (int i = g.cell_facepos[c]; i < g.cell_facepos[c + 1]; ++i) {
+            const int    f    = g.cell_faces[i];
+            const double sign = (g.face_cells[2*f + 0] == c) ? 1.0 : -1.0;
+
+            for (int d = 0; d < 3; ++d) {
+                s[d] += sign * g.face_normals[3*f + d];
+            }
+            a += g.face_areas[f];
+        }
+
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_SMALL (s[d] / a, 1.0e-12);
+        }
+        BOOST_CHECK (g.cell_volumes[c] > 0.0);
+    }
+}
+
+template <class T>
+bool sameArray(const T* a, const T* b, int n)
+{
+    return std::equal(a, a + n, b);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (UnfaultedBox)
+{
+    const int nx = 3, ny = 2, nz = 2;
+    Deck      deck (nx, ny, nz, false);
+    Processed p    (deck);
+
+    BOOST_CHECK_EQUAL (p.g.number_of_cells, nx * ny * nz);
+    BOOST_CHECK_EQUAL (p.g.number_of_nodes, (nx + 1) * (ny + 1) * (nz + 1));
+    BOOST_CHECK_EQUAL (p.g.number_of_nodes, p.g.number_of_nodes_on_pillars);
+    BOOST_CHECK_EQUAL (p.g.number_of_faces,
+                       (nx + 1)*ny*nz + nx*(ny + 1)*nz + nx*ny*(nz + 1));
+
+    checkTopology(p.g);
+}
+
+BOOST_AUTO_TEST_CASE (FaultedGrid)
+{
+    // More rows of faces than are processed in a single batch.
+    Deck      deck (12, 20, 4, true);
+    Processed p    (deck);
+
+    // Faults introduce nodes off the pillars.
+    BOOST_CHECK (p.g.number_of_nodes > p.g.number_of_nodes_on_pillars);
+    BOOST_CHECK (p.g.number_of_cells < 12 * 20 * 4);
+
+    checkTopology(p.g);
+}
+
+BOOST_AUTO_TEST_CASE (ShearedBoxGeometry)
+{
+    // Slanted pillars shear the unit cells without changing volume.
+    Deck deck (3, 2, 2, false);
+
+    UnstructuredGrid* g = create_grid_cornerpoint(&deck.grdecl, 0.0);
+    BOOST_REQUIRE (g != 0);
+
+    for (int c = 0; c < g->number_of_cells; ++c) {
+        BOOST_CHECK_CLOSE (g->cell_volumes[c], 1.0, 1.0e-10);
+    }
+    checkClosedCells(*g);
+
+    destroy_grid(g);
+}
+
+#ifdef _OPENMP
+BOOST_AUTO_TEST_CASE (IndependentOfThreadCount)
+{
+    Deck deck (12, 20, 4, true);
+
+    const int nthreads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+    Processed serial (deck);
+
+    omp_set_num_threads(3);
+    Processed parallel (deck);
+
+    omp_set_num_threads(nthreads);
+
+    const struct processed_grid& s = serial.g;
+    const struct processed_grid& p = parallel.g;
+
+    BOOST_REQUIRE_EQUAL (s.number_of_faces, p.number_of_faces);
+    BOOST_REQUIRE_EQUAL (s.number_of_nodes, p.number_of_nodes);
+    BOOST_REQUIRE_EQUAL (s.number_of_cells, p.number_of_cells);
+
+    const int nf = s.number_of_faces;
+    BOOST_CHECK (sameArray(s.face_ptr, p.face_ptr, nf + 1));
+    BOOST_CHECK (sameArray(s.face_nodes, p.face_nodes, s.face_ptr[nf]));
+    BOOST_CHECK (sameArray(s.face_neighbors, p.face_neighbors, 2 * nf));
+    BOOST_CHECK (sameArray(s.face_tag, p.face_tag, nf));
+    BOOST_CHECK (sameArray(s.node_coordinates, p.node_coordinates,
+                           3 * s.number_of_nodes));
+    BOOST_CHECK (sameArray(s.local_cell_index, p.local_cell_index,
+                           s.number_of_cells));
+}
+
+BOOST_AUTO_TEST_CASE (GeometryIndependentOfThreadCount)
+{
+    Deck deck (12, 20, 4, true);
+
+    const int nthreads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+    UnstructuredGrid* s = create_grid_cornerpoint(&deck.grdecl, 0.0);
+
+    omp_set_num_threads(3);
+    UnstructuredGrid* p = create_grid_cornerpoint(&deck.grdecl, 0.0);
+
+    omp_set_num_threads(nthreads);
+
+    BOOST_REQUIRE (s != 0);
+    BOOST_REQUIRE (p != 0);
+    BOOST_REQUIRE_EQUAL (s->number_of_cells, p->number_of_cells);
+    BOOST_REQUIRE_EQUAL (s->number_of_faces, p->number_of_faces);
+
+    const int nc = s->number_of_cells;
+    const int nf = s->number_of_faces;
+    BOOST_CHECK (sameArray(s->cell_volumes, p->cell_volumes, nc));
+    BOOST_CHECK (sameArray(s->cell_centroids, p->cell_centroids, 3 * nc));
+    BOOST_CHECK (sameArray(s->face_areas, p->face_areas, nf));
+    BOOST_CHECK (sameArray(s->face_centroids, p->face_centroids, 3 * nf));
+    BOOST_CHECK (sameArray(s->face_normals, p->face_normals, 3 * nf));
+
+    destroy_grid(p);
+    destroy_grid(s);
+}
+#endif
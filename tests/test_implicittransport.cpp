@@ -0,0 +1,276 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE ImplicitTransportTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/transport/implicit/CSRMatrixBlockAssembler.hpp>
+#include <opm/core/transport/implicit/ImplicitTransport.hpp>
+#include <opm/core/transport/implicit/JacobianSystem.hpp>
+#include <opm/core/transport/implicit/NormSupport.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace Opm;
+
+namespace {
+
+/// Cell-wise nonlinear problem x^3 + x - b + k*sum(x - x_nb) = 0,
+/// counting how often it is evaluated.
+class CountingModel {
+public:
+    enum { DofPerCell = 1 };
+
+    CountingModel (const std::vector<double>& b, double k)
+        : b_ (b), k_ (k), iterations (0), accumulations (0)
+    {}
+
+    template <class State, class Grid, class System>
+    void initStep (const State&, const Grid&, System& sys) {
+        std::vector<double>& x = sys.vector().writableSolution();
+        std::fill(x.begin(), x.end(), 0.0);
+    }
+
+    template <class State, class Grid, class System>
+    bool initIteration (const State&, const Grid&, System& sys) {
+        x_ = sys.vector().solution();
+        ++iterations;
+        return true;
+    }
+
+    void initResidual (const int, double* F) const { *F = 0.0; }
+
+    template <class State, class Grid>
+    void fluxConnection (const State&, const Grid& g, const double,
+                         const int c, const int f,
+                         double* J1, double* J2, double* F) const {
+        const int* n = g.face_cells + 2*f;
+        const int  o = (n[0] == c) ? n[1] : n[0];
+
+        *F  += k_ * (x_[c] - x_[o]);
+        *J1 += k_;
+        *J2 -= k_;
+    }
+
+    template <class Grid>
+    void accumulation (const Grid&, const int c, double* J, double* F) {
+        ++accumulations;
+
+        *F += x_[c]*x_[c]*x_[c] + x_[c] - b_[c];
+        *J += 3.0*x_[c]*x_[c] + 1.0;
+    }
+
+    template <class Grid, class SourceTerms>
+    void sourceTerms (const Grid&, const SourceTerms*, const int,
+                      const double, double*, double*) const {}
+
+    template <class Grid, class Solution, class State>
+    void finishStep (const Grid&, const Solution& x, State& state) {
+        state = x;
+    }
+
+    template <class Grid>
+    double residual (const Grid& g, const std::vector<double>& x) const {
+        double r = 0.0;
+        for (int c = 0; c < g.number_of_cells; ++c) {
+            double F = x[c]*x[c]*x[c] + x[c] - b_[c];
+            for (int i = g.cell_facepos[c]; i < g.cell_facepos[c + 1]; ++i) {
+                const int* n = g.face_cells + 2*g.cell_faces[i];
+                const int  o = (n[0] == c) ? n[1] : n[0];
+                if (o >= 0) { F += k_ * (x[c] - x[o]); }
+            }
+            r = std::max(r, std::fabs(F));
+        }
+        return r;
+    }
+
+private:
+    std::vector<double> b_;
+    double              k_;
+    std::vector<double> x_;
+
+public:
+    int iterations;
+    int accumulations;
+};
+
+struct NoSources {
+    int  nsrc;
+    int* cell;
+};
+
+/// Dense Gaussian elimination; the test systems are tiny.
+struct DenseSolver {
+    void solve (const struct CSRMatrix& A,
+                const std::vector<double>& b,
+                std::vector<double>& x) const {
+        const std::size_t n = A.m;
+        std::vector<double> M(n * n, 0.0), r(b);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                M[i*n + A.ja[k]] = A.sa[k];
+            }
+        }
+        for (std::size_t p = 0; p < n; ++p) {
+            for (std::size_t i = p + 1; i < n; ++i) {
+                const double l = M[i*n + p] / M[p*n + p];
+                for (std::size_t j = p; j < n; ++j) { M[i*n + j] -= l * M[p*n + j]; }
+                r[i] -= l * r[p];
+            }
+        }
+        for (std::size_t i = n; i-- > 0; ) {
+            double s = r[i];
+            for (std::size_t j = i + 1; j < n; ++j) { s -= M[i*n + j] * x[j]; }
+            x[i] = s / M[i*n + i];
+        }
+    }
+};
+
+template <class Vector>
+struct MaxNorm {
+    static double norm (const Vector& v) {
+        return ImplicitTransportDefault::AccumulationNorm<Vector, ImplicitTransportDefault::MaxAbs>::norm(v);
+    }
+};
+
+typedef ImplicitTransportDefault::NewtonVectorCollection< std::vector<double> > NVecColl;
+typedef ImplicitTransportDefault::JacobianSystem< struct CSRMatrix, NVecColl >  JacSys;
+typedef ImplicitTransport<CountingModel, JacSys, MaxNorm,
+                          ImplicitTransportDefault::VectorNegater,
+                          ImplicitTransportDefault::VectorZero,
+                          ImplicitTransportDefault::MatrixZero,
+                          ImplicitTransportDefault::VectorAssign> Solver;
+
+ImplicitTransportDetails::NRControl control ()
+{
+    ImplicitTransportDetails::NRControl ctrl;
+    ctrl.max_it    = 50;
+    ctrl.atol      = 1.0e-12;
+    ctrl.rtol      = 0.0;
+    ctrl.dxtol     = 0.0;
+    ctrl.max_it_ls = 10;
+    return ctrl;
+}
+
+struct Run {
+    Run (double bval)
+        : g (create_grid_cart2d(4, 1, 1.0, 1.0)),
+          model (std::vector<double>(g->number_of_cells, bval), 0.1),
+          solver (model),
+          ctrl (control())
+    {
+        NoSources* nosrc = 0;
+        DenseSolver linsolve;
+        solver.solve(*g, nosrc, 1.0, ctrl, x, linsolve, rpt);
+    }
+
+    ~Run () { destroy_grid(g); }
+
+    UnstructuredGrid*                  g;
+    CountingModel                      model;
+    Solver                             solver;
+    ImplicitTransportDetails::NRControl ctrl;
+    ImplicitTransportDetails::NRReport  rpt;
+    std::vector<double>                x;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (FullStepsNeedOneEvaluationPerIteration)
+{
+    // Mild problem: every full Newton step is accepted.
+    Run run (0.5);
+
+    BOOST_CHECK_EQUAL (run.rpt.flag, 1);
+    BOOST_CHECK (run.model.residual(*run.g, run.x) < 1.0e-12);
+
+    // One evaluation for the initial state, then exactly one per
+    // Newton iteration (the accepted alpha = 1 trial), which also
+    // provides the Jacobian for the next iteration.
+    const int nc = run.g->number_of_cells;
+    BOOST_CHECK_EQUAL (run.model.iterations, run.rpt.nit + 1);
+    BOOST_CHECK_EQUAL (run.model.accumulations, nc * run.model.iterations);
+}
+
+BOOST_AUTO_TEST_CASE (LineSearchEvaluatesEachTrialOnce)
+{
+    // Newton from x = 0 overshoots, so the line search must cut the
+    // first step back.
+    Run run (10.0);
+
+    BOOST_CHECK_EQUAL (run.rpt.flag, 1);
+    BOOST_CHECK (run.model.residual(*run.g, run.x) < 1.0e-12);
+
+    // More trials than iterations, but still no evaluation besides
+    // the trials themselves.
+    const int nc = run.g->number_of_cells;
+    BOOST_CHECK (run.model.iterations > run.rpt.nit + 1);
+    BOOST_CHECK_EQUAL (run.model.accumulations, nc * run.model.iterations);
+}
+
+BOOST_AUTO_TEST_CASE (StructureFollowsTheGrid)
+{
+    UnstructuredGrid* g1 = create_grid_cart2d(4, 1, 1.0, 1.0);
+    UnstructuredGrid* g2 = create_grid_cart2d(3, 2, 1.0, 1.0);
+
+    CountingModel model (std::vector<double>(6, 0.5), 0.1);
+    Solver        solver (model);
+
+    const ImplicitTransportDetails::NRControl ctrl = control();
+    ImplicitTransportDetails::NRReport        rpt;
+    NoSources*  nosrc = 0;
+    DenseSolver linsolve;
+    std::vector<double> x;
+
+    // Twice on the same grid, reusing the structure.
+    for (int i = 0; i < 2; ++i) {
+        solver.solve(*g1, nosrc, 1.0, ctrl, x, linsolve, rpt);
+        BOOST_CHECK_EQUAL (rpt.flag, 1);
+        BOOST_REQUIRE_EQUAL (x.size(), std::size_t(g1->number_of_cells));
+        BOOST_CHECK (model.residual(*g1, x) < 1.0e-12);
+    }
+
+    // A different grid, which has more connections per cell.
+    solver.solve(*g2, nosrc, 1.0, ctrl, x, linsolve, rpt);
+    BOOST_CHECK_EQUAL (rpt.flag, 1);
+    BOOST_REQUIRE_EQUAL (x.size(), std::size_t(g2->number_of_cells));
+    BOOST_CHECK (model.residual(*g2, x) < 1.0e-12);
+
+    // An explicit reset recreates the structure for the same grid.
+    solver.resetStructure();
+    solver.solve(*g2, nosrc, 1.0, ctrl, x, linsolve, rpt);
+    BOOST_CHECK_EQUAL (rpt.flag, 1);
+    BOOST_CHECK (model.residual(*g2, x) < 1.0e-12);
+
+    destroy_grid(g2);
+    destroy_grid(g1);
+}
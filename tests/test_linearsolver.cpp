@@ -29,8 +29,17 @@
 
 #include <opm/core/linalg/LinearSolverFactory.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#if HAVE_SUITESPARSE_UMFPACK_H
+#include <opm/core/linalg/LinearSolverUmfpack.hpp>
+#include <opm/core/linalg/call_umfpack.h>
+#include <opm/core/linalg/sparse_sys.h>
+#endif
+#ifdef HAVE_DUNE_ISTL
+#include <opm/core/linalg/LinearSolverIstl.hpp>
+#endif
 
 #include <dune/common/version.hh>
+#include <algorithm>
 #include <memory>
 #include <cstdlib>
 #include <string>
@@ -132,6 +141,115 @@ BOOST_AUTO_TEST_CASE(DefaultTest)
     run_test(param);
 }
 
+void check_solution(const std::vector<double>& x, const std::vector<double>& exact,
+                    double tol = 1e-10)
+{
+    BOOST_REQUIRE_EQUAL(x.size(), exact.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        BOOST_CHECK_SMALL(x[i] - exact[i], tol);
+    }
+}
+
+#if HAVE_SUITESPARSE_UMFPACK_H
+std::vector<double> umfpack_cached_solve(UMFPACKCache* cache, MyMatrix& mat,
+                                         const std::vector<double>& b)
+{
+    CSRMatrix A = { mat.rowStart.size() - 1, mat.data.size(),
+                    &mat.rowStart[0], &mat.colIndex[0], &mat.data[0] };
+    std::vector<double> x(b.size(), 0.0);
+    BOOST_CHECK(call_UMFPACK_cached(cache, &A, 1, &b[0], &x[0]));
+    return x;
+}
+
+void check_counts(const UMFPACKCache* cache, std::size_t nanalyse, std::size_t nfactor)
+{
+    std::size_t na, nf;
+    umfpack_cache_counts(cache, &na, &nf);
+    BOOST_CHECK_EQUAL(na, nanalyse);
+    BOOST_CHECK_EQUAL(nf, nfactor);
+}
+
+BOOST_AUTO_TEST_CASE(UmfpackCacheTest)
+{
+    std::unique_ptr<UMFPACKCache, void (*)(UMFPACKCache*)>
+        cache(umfpack_cache_create(), &umfpack_cache_destroy);
+    BOOST_REQUIRE(cache);
+
+    auto mat = createLaplacian(4);
+    std::vector<double> exact, b;
+    createRandomVectors(16, exact, b, *mat);
+
+    check_solution(umfpack_cached_solve(cache.get(), *mat, b), exact);
+    check_counts(cache.get(), 1, 1);
+
+    // Unchanged matrix: neither analysis nor factorisation.
+    check_solution(umfpack_cached_solve(cache.get(), *mat, b), exact);
+    check_counts(cache.get(), 1, 1);
+
+    // Changed values: refactorisation only.
+    for (int row = 0; row < 16; ++row) {
+        for (int i = mat->rowStart[row]; i < mat->rowStart[row + 1]; ++i) {
+            if (mat->colIndex[i] == row) {
+                mat->data[i] += 0.5 * row;
+            }
+        }
+    }
+    createRandomVectors(16, exact, b, *mat);
+    check_solution(umfpack_cached_solve(cache.get(), *mat, b), exact);
+    check_counts(cache.get(), 1, 2);
+
+    // Changed pattern: analysis and factorisation.
+    auto mat5 = createLaplacian(5);
+    createRandomVectors(25, exact, b, *mat5);
+    check_solution(umfpack_cached_solve(cache.get(), *mat5, b), exact);
+    check_counts(cache.get(), 2, 3);
+}
+
+BOOST_AUTO_TEST_CASE(UmfpackMultipleRhsTest)
+{
+    const int N = 4, nrhs = 3;
+    auto mat = createLaplacian(N);
+    std::vector<double> exact, b;
+    for (int k = 0; k < nrhs; ++k) {
+        std::vector<double> xk, bk;
+        createRandomVectors(N*N, xk, bk, *mat);
+        exact.insert(exact.end(), xk.begin(), xk.end());
+        b.insert(b.end(), bk.begin(), bk.end());
+    }
+    std::vector<double> x(nrhs*N*N, 0.0);
+    Opm::LinearSolverUmfpack ls;
+    auto rep = ls.solveMultiple(N*N, mat->data.size(), &(mat->rowStart[0]),
+                                &(mat->colIndex[0]), &(mat->data[0]),
+                                nrhs, &(b[0]), &(x[0]));
+    BOOST_CHECK(rep.converged);
+    check_solution(x, exact);
+}
+
+BOOST_AUTO_TEST_CASE(UmfpackFailureTest)
+{
+    // A duplicated entry in row 0 makes the matrix invalid for UMFPACK.
+    MyMatrix bad(2, 4);
+    bad.rowStart = { 0, 2, 4 };
+    bad.colIndex = { 0, 0, 0, 1 };
+    bad.data     = { 1.0, 1.0, -1.0, 2.0 };
+    std::vector<double> b(2, 1.0), x(2, 0.0);
+    Opm::LinearSolverUmfpack ls;
+    auto rep = ls.solve(2, 4, &(bad.rowStart[0]), &(bad.colIndex[0]),
+                        &(bad.data[0]), &(b[0]), &(x[0]));
+    BOOST_CHECK(!rep.converged);
+
+    // The solver remains usable afterwards.
+    auto mat = createLaplacian(4);
+    std::vector<double> exact;
+    createRandomVectors(16, exact, b, *mat);
+    x.assign(16, 0.0);
+    rep = ls.solve(16, mat->data.size(), &(mat->rowStart[0]),
+                   &(mat->colIndex[0]), &(mat->data[0]), &(b[0]), &(x[0]));
+    BOOST_CHECK(rep.converged);
+    check_solution(x, exact);
+}
+#endif
+
 #ifdef HAVE_DUNE_ISTL
 BOOST_AUTO_TEST_CASE(CGAMGTest)
 {
@@ -153,6 +271,161 @@ BOOST_AUTO_TEST_CASE(CGILUTest)
     run_test(param);
 }
 
+Opm::parameter::ParameterGroup reuse_param(int type)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver_type"), std::to_string(type));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    param.insertParameter(std::string("linsolver_reuse_pattern"), std::string("true"));
+    return param;
+}
+
+MyMatrix scaled(const MyMatrix& mat, double factor)
+{
+    MyMatrix result(mat);
+    for (auto& v : result.data) {
+        v *= factor;
+    }
+    return result;
+}
+
+// Solve with ls, and check the solution against the exact one and
+// against that of a fresh solver of the same type, without reuse.
+Opm::LinearSolverInterface::LinearSolverReport
+solve_and_compare(const Opm::LinearSolverIstl& ls, int type, const MyMatrix& mat)
+{
+    const int n = mat.rowStart.size() - 1;
+    std::vector<double> exact, b;
+    createRandomVectors(n, exact, b, mat);
+    std::vector<double> x(n, 0.0), xfresh(n, 0.0);
+    auto rep = ls.solve(n, mat.data.size(), &(mat.rowStart[0]), &(mat.colIndex[0]),
+                        &(mat.data[0]), &(b[0]), &(x[0]));
+    BOOST_CHECK(rep.converged);
+    check_solution(x, exact, 1e-6);
+
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver_type"), std::to_string(type));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    Opm::LinearSolverIstl fresh(param);
+    fresh.solve(n, mat.data.size(), &(mat.rowStart[0]), &(mat.colIndex[0]),
+                &(mat.data[0]), &(b[0]), &(xfresh[0]));
+    check_solution(x, xfresh, 1e-6);
+    return rep;
+}
+
+BOOST_AUTO_TEST_CASE(ReusePatternDriftTest)
+{
+    for (int type = 0; type <= 1; ++type) {
+        auto param = reuse_param(type);
+        param.insertParameter(std::string("linsolver_reuse_drift"), std::string("0.1"));
+        Opm::LinearSolverIstl ls(param);
+        auto mat = createLaplacian(10);
+
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, *mat).preconditioner_setups, 1);
+        // Drift below 0.1 of the values at setup: reused.
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, scaled(*mat, 1.05)).preconditioner_setups, 0);
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, scaled(*mat, 1.08)).preconditioner_setups, 0);
+        // Drift above 0.1: set up again, and measured from the new values.
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, scaled(*mat, 1.2)).preconditioner_setups, 1);
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, scaled(*mat, 1.25)).preconditioner_setups, 0);
+        // A new pattern is set up from scratch.
+        auto mat2 = createLaplacian(8);
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, *mat2).preconditioner_setups, 1);
+        BOOST_CHECK_EQUAL(solve_and_compare(ls, type, *mat2).preconditioner_setups, 0);
+    }
+}
+
+// Laplacian with its diagonal raised by shift, and scaled symmetrically
+// by D = diag(d) if spread > 0, with d varying between 1 and 1 + spread.
+MyMatrix modified(const MyMatrix& mat, double shift, double spread)
+{
+    MyMatrix result(mat);
+    const int n = mat.rowStart.size() - 1;
+    std::vector<double> d(n);
+    for (int row = 0; row < n; ++row) {
+        d[row] = 1.0 + spread * (row % 5) / 4.0;
+    }
+    for (int row = 0; row < n; ++row) {
+        for (int i = mat.rowStart[row]; i < mat.rowStart[row + 1]; ++i) {
+            const int col = mat.colIndex[i];
+            double v = mat.data[i] + ((col == row) ? shift : 0.0);
+            result.data[i] = d[row] * v * d[col];
+        }
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(ReuseIterationsTest)
+{
+    const int type = 0;
+    const double factor = 1.5;
+    auto param = reuse_param(type);
+    param.insertParameter(std::string("linsolver_reuse_policy"), std::string("iterations"));
+    param.insertParameter(std::string("linsolver_reuse_iteration_factor"), std::string("1.5"));
+    Opm::LinearSolverIstl ls(param);
+    auto mat = createLaplacian(10);
+
+    // Slowly changing values, then a strong change in scaling,
+    // slowly changing again.
+    std::vector<MyMatrix> sequence;
+    for (int k = 0; k < 4; ++k) {
+        sequence.push_back(modified(*mat, 0.01*k, 0.0));
+    }
+    for (int k = 0; k < 4; ++k) {
+        sequence.push_back(modified(*mat, 0.01*k, 50.0));
+    }
+
+    // The preconditioner is set up in the first solve, and in the solve
+    // after one that needed more than factor times the iterations of the
+    // first solve with the current preconditioner.
+    bool expect_setup = true;
+    int baseline = -1;
+    int setups = 0;
+    for (std::size_t k = 0; k < sequence.size(); ++k) {
+        auto rep = solve_and_compare(ls, type, sequence[k]);
+        BOOST_CHECK_EQUAL(rep.preconditioner_setups, expect_setup ? 1 : 0);
+        BOOST_CHECK(rep.solve_time >= 0.0);
+        if (rep.preconditioner_setups > 0) {
+            BOOST_CHECK(rep.setup_time >= 0.0);
+            baseline = rep.iterations;
+            expect_setup = false;
+            ++setups;
+        } else {
+            BOOST_CHECK_EQUAL(rep.setup_time, 0.0);
+            expect_setup = rep.iterations > factor*baseline;
+        }
+        if (k == 3) {
+            // Slow changes keep the first preconditioner.
+            BOOST_CHECK_EQUAL(setups, 1);
+        }
+    }
+    // The strong change triggered a new setup.
+    BOOST_CHECK(setups > 1);
+}
+
+BOOST_AUTO_TEST_CASE(UnsortedColumnsTest)
+{
+    // Reverse the entries of every row, so that columns are unsorted.
+    auto mat = createLaplacian(10);
+    MyMatrix reversed(*mat);
+    for (std::size_t row = 0; row + 1 < mat->rowStart.size(); ++row) {
+        std::reverse(reversed.colIndex.begin() + mat->rowStart[row],
+                     reversed.colIndex.begin() + mat->rowStart[row + 1]);
+        std::reverse(reversed.data.begin() + mat->rowStart[row],
+                     reversed.data.begin() + mat->rowStart[row + 1]);
+    }
+    for (int type = 0; type <= 2; ++type) {
+        Opm::parameter::ParameterGroup param;
+        param.insertParameter(std::string("linsolver_type"), std::to_string(type));
+        param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+        Opm::LinearSolverIstl ls(param);
+        solve_and_compare(ls, type, reversed);
+    }
+    Opm::LinearSolverIstl ls(reuse_param(0));
+    solve_and_compare(ls, 0, reversed);
+    solve_and_compare(ls, 0, scaled(reversed, 1.01));
+}
+
 BOOST_AUTO_TEST_CASE(BiCGILUTest)
 {
     Opm::parameter::ParameterGroup param;
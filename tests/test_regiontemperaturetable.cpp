@@ -0,0 +1,93 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE RegionTemperatureTableTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/core/props/pvt/RegionTemperatureTable.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using Opm::RegionTemperatureTable;
+
+BOOST_AUTO_TEST_CASE(InterpolationAndEndValues)
+{
+    RegionTemperatureTable table;
+    BOOST_CHECK(table.empty());
+
+    const std::vector<double> T0 = { 300.0, 350.0, 400.0 };
+    const std::vector<double> v0 = { 1.0, 0.5, 0.25 };
+    const std::vector<double> T1 = { 320.0 };
+    const std::vector<double> v1 = { 3.0 };
+    table.addRegion(T0, v0, 2.0);
+    table.addRegion(T1, v1);
+    BOOST_CHECK(!table.empty());
+
+    double d;
+    BOOST_CHECK_CLOSE(table.evaluate(0, 325.0, d), 1.5, 1e-12);
+    BOOST_CHECK_CLOSE(d, -0.02, 1e-12);
+    BOOST_CHECK_CLOSE(table.evaluate(0, 350.0, d), 1.0, 1e-12);
+    BOOST_CHECK_CLOSE(table.evaluate(0, 375.0, d), 0.75, 1e-12);
+    BOOST_CHECK_CLOSE(d, -0.01, 1e-12);
+
+    // constant outside the table
+    BOOST_CHECK_EQUAL(table.evaluate(0, 250.0, d), 2.0);
+    BOOST_CHECK_EQUAL(d, 0.0);
+    BOOST_CHECK_EQUAL(table.evaluate(0, 450.0, d), 0.5);
+    BOOST_CHECK_EQUAL(d, 0.0);
+    BOOST_CHECK_EQUAL(table.evaluate(1, 500.0, d), 3.0);
+    BOOST_CHECK_EQUAL(d, 0.0);
+
+    // value-only evaluation agrees with the one with derivative
+    for (double t = 240.0; t <= 460.0; t += 7.5) {
+        BOOST_CHECK_EQUAL(table.evaluate(0, t), table.evaluate(0, t, d));
+    }
+    BOOST_CHECK_EQUAL(table.evaluate(1, 300.0), 3.0);
+
+    // batched evaluation, with and without region indices
+    const int region[] = { 1, 0, 0 };
+    const double T[] = { 310.0, 325.0, 420.0 };
+    double val[3], dvaldT[3];
+    table.evaluate(3, region, T, val, dvaldT);
+    BOOST_CHECK_EQUAL(val[0], 3.0);
+    BOOST_CHECK_CLOSE(val[1], 1.5, 1e-12);
+    BOOST_CHECK_CLOSE(dvaldT[1], -0.02, 1e-12);
+    BOOST_CHECK_EQUAL(val[2], 0.5);
+    table.evaluate(3, 0, T, val, 0);
+    BOOST_CHECK_CLOSE(val[0], 1.8, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(MismatchedColumnsAreRejected)
+{
+    RegionTemperatureTable table;
+    const std::vector<double> T = { 300.0, 350.0 };
+    const std::vector<double> v = { 1.0 };
+    BOOST_CHECK_THROW(table.addRegion(T, v), std::runtime_error);
+    BOOST_CHECK_THROW(table.addRegion(std::vector<double>(), std::vector<double>()), std::runtime_error);
+}
@@ -0,0 +1,372 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE ReorderSolverTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/flowdiagnostics/TofDiscGalReorder.hpp>
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/simulator/TwophaseState.hpp>
+#include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
+#include <opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace Opm;
+
+namespace {
+
+/// Flux field on a Cartesian 2d grid with a net flow in the positive
+/// x and y directions, circulating inside each 2x2 block of cells.
+/// The blocks are the multi-cell components; with an odd nx the last
+/// column forms a chain of single cells.
+std::vector<double> blockFlux(const UnstructuredGrid& g,
+                              const int nx, const int ny)
+{
+    std::vector<double> flux(g.number_of_faces);
+    int f = 0;
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx + 1; ++i, ++f) {
+            flux[f] = (i % 2 == 1 && j % 2 == 1) ? -1.0 : 1.0;
+        }
+    }
+    for (int j = 0; j < ny + 1; ++j) {
+        for (int i = 0; i < nx; ++i, ++f) {
+            flux[f] = (j % 2 == 1 && i % 2 == 0) ? -0.5 : 0.5;
+        }
+    }
+    return flux;
+}
+
+/// Divergence-free flux field on a Cartesian 2d grid, with a uniform
+/// flow in the positive x and y directions.  With a circulation
+/// larger than the uniform flow, the flow also circulates inside each
+/// 2x2 block of cells, which then forms a multi-cell component.
+std::vector<double> uniformFlux(const UnstructuredGrid& g,
+                                const int nx, const int ny,
+                                const double circulation)
+{
+    const int nxf = (nx + 1)*ny;
+    std::vector<double> flux(g.number_of_faces, 1.0);
+    std::fill(flux.begin() + nxf, flux.end(), 0.5);
+    for (int j = 0; j + 1 < ny; j += 2) {
+        for (int i = 0; i + 1 < nx; i += 2) {
+            flux[j*(nx + 1) + i + 1]       += circulation;
+            flux[nxf + (j + 1)*nx + i + 1] += circulation;
+            flux[(j + 1)*(nx + 1) + i + 1] -= circulation;
+            flux[nxf + (j + 1)*nx + i]     -= circulation;
+        }
+    }
+    return flux;
+}
+
+/// Assigns each cell its depth in the upwind graph, i.e. one more
+/// than the largest depth of its upwind neighbours in other
+/// components.  A cell solved before all its upwind neighbours is
+/// flagged.
+class DepthSolver : public ReorderSolverInterface
+{
+public:
+    DepthSolver(const UnstructuredGrid& grid, const int throw_cell = -1)
+        : grid_(grid), throw_cell_(throw_cell), multicell_components_(0)
+    {
+    }
+
+    void solve(const double* darcyflux)
+    {
+        darcyflux_ = darcyflux;
+        depth_.assign(grid_.number_of_cells, -1);
+        early_.assign(grid_.number_of_cells, 0);
+        multicell_components_ = 0;
+        reorderAndTransport(grid_, darcyflux);
+    }
+
+    const std::vector<int>& depth() const { return depth_; }
+    bool orderRespected() const
+    {
+        return std::find(early_.begin(), early_.end(), 1) == early_.end();
+    }
+    int multicellComponents() const { return multicell_components_; }
+
+private:
+    virtual void solveSingleCell(const int cell)
+    {
+        solveMultiCell(1, &cell);
+    }
+
+    virtual void solveMultiCell(const int num_cells, const int* cells)
+    {
+        if (num_cells > 1) {
+#pragma omp atomic
+            ++multicell_components_;
+        }
+        int d = 0;
+        for (int i = 0; i < num_cells; ++i) {
+            const int cell = cells[i];
+            if (cell == throw_cell_) {
+                throw std::runtime_error("Failure in component solve");
+            }
+            for (int hf = grid_.cell_facepos[cell]; hf < grid_.cell_facepos[cell + 1]; ++hf) {
+                const int f = grid_.cell_faces[hf];
+                const int* n = grid_.face_cells + 2*f;
+                const int upw = (darcyflux_[f] > 0.0) ? n[0] : n[1];
+                if (upw < 0 || upw == cell
+                    || std::find(cells, cells + num_cells, upw) != cells + num_cells) {
+                    continue;
+                }
+                if (depth_[upw] < 0) {
+                    early_[cell] = 1;
+                }
+                d = std::max(d, depth_[upw] + 1);
+            }
+        }
+        for (int i = 0; i < num_cells; ++i) {
+            depth_[cells[i]] = d;
+        }
+    }
+
+    const UnstructuredGrid& grid_;
+    const int throw_cell_;
+    const double* darcyflux_;
+    std::vector<int> depth_;
+    std::vector<int> early_;
+    int multicell_components_;
+};
+
+struct Grid {
+    Grid(const int nx, const int ny)
+        : g(create_grid_cart2d(nx, ny, 1.0, 1.0)),
+          flux(blockFlux(*g, nx, ny))
+    {
+    }
+    ~Grid() { destroy_grid(g); }
+
+    UnstructuredGrid* g;
+    std::vector<double> flux;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (LevelsRespectUpwindOrder)
+{
+    Grid grid(21, 16);
+
+    DepthSolver serial(*grid.g);
+    serial.solve(&grid.flux[0]);
+    BOOST_CHECK (serial.orderRespected());
+    BOOST_CHECK (serial.multicellComponents() > 0);
+
+    DepthSolver parallel(*grid.g);
+    parallel.setParallelComponents(true);
+    parallel.solve(&grid.flux[0]);
+    BOOST_CHECK (parallel.orderRespected());
+    BOOST_CHECK_EQUAL (parallel.multicellComponents(), serial.multicellComponents());
+
+    BOOST_CHECK (serial.depth() == parallel.depth());
+}
+
+BOOST_AUTO_TEST_CASE (ParallelTofMatchesSerial)
+{
+    Grid grid(21, 16);
+    const int nc = grid.g->number_of_cells;
+    const std::vector<double> porevolume(nc, 0.25);
+    const std::vector<double> source(nc, 0.0);
+
+    std::vector<double> tof_serial, tof_parallel;
+
+    TofReorder serial(*grid.g);
+    serial.solveTof(&grid.flux[0], &porevolume[0], &source[0], tof_serial);
+
+    TofReorder parallel(*grid.g);
+    parallel.setParallelComponents(true);
+    parallel.solveTof(&grid.flux[0], &porevolume[0], &source[0], tof_parallel);
+
+    BOOST_REQUIRE_EQUAL (tof_serial.size(), tof_parallel.size());
+    BOOST_CHECK (tof_serial == tof_parallel);
+}
+
+BOOST_AUTO_TEST_CASE (ParallelDiscGalTofMatchesSerial)
+{
+    Grid grid(21, 16);
+    const int nc = grid.g->number_of_cells;
+    const std::vector<double> porevolume(nc, 0.25);
+    const std::vector<double> source(nc, 0.0);
+
+    std::vector<double> tof_serial, tof_parallel;
+
+    parameter::ParameterGroup param;
+    param.insertParameter("dg_degree", "1");
+    param.insertParameter("use_limiter", "true");
+
+    TofDiscGalReorder serial(*grid.g, param);
+    BOOST_CHECK (!serial.parallelComponents());
+    serial.solveTof(&grid.flux[0], &porevolume[0], &source[0], tof_serial);
+
+    param.insertParameter("parallel_components", "true");
+    TofDiscGalReorder parallel(*grid.g, param);
+    BOOST_CHECK (parallel.parallelComponents());
+    parallel.solveTof(&grid.flux[0], &porevolume[0], &source[0], tof_parallel);
+
+    BOOST_REQUIRE_EQUAL (tof_serial.size(), tof_parallel.size());
+    BOOST_CHECK (tof_serial == tof_parallel);
+}
+
+BOOST_AUTO_TEST_CASE (TofTracerSingleSweep)
+{
+    const int nx = 21, ny = 16;
+    UnstructuredGrid* g = create_grid_cart2d(nx, ny, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+    const std::vector<double> porevolume(nc, 0.25);
+    const std::vector<double> source(nc, 0.0);
+
+    // The cells with inflow from the boundary are the tracer heads,
+    // the left column for tracer 0 and the rest of the bottom row
+    // for tracer 1.
+    std::vector<int> left, bottom;
+    for (int j = 0; j < ny; ++j) { left.push_back(j*nx); }
+    for (int i = 1; i < nx; ++i) { bottom.push_back(i); }
+    SparseTable<int> heads;
+    heads.appendRow(left.begin(), left.end());
+    heads.appendRow(bottom.begin(), bottom.end());
+    std::vector<int> head_tracer(nc, -1);
+    for (int tr = 0; tr < 2; ++tr) {
+        for (int i = 0; i < heads[tr].size(); ++i) {
+            head_tracer[heads[tr][i]] = tr;
+        }
+    }
+
+    // Without and with multi-cell components.
+    for (const double circulation : { 0.0, 2.0 }) {
+        const std::vector<double> flux = uniformFlux(*g, nx, ny, circulation);
+        // Gauss-Seidel tolerance of multi-cell components, in percent.
+        const double tol = (circulation == 0.0) ? 1e-10 : 0.1;
+
+        std::vector<double> tof, tracer, tof_only;
+        TofReorder serial(*g);
+        serial.solveTofTracer(&flux[0], &porevolume[0], &source[0], heads, tof, tracer);
+        TofReorder tof_solver(*g);
+        tof_solver.solveTof(&flux[0], &porevolume[0], &source[0], tof_only);
+
+        BOOST_REQUIRE_EQUAL (tracer.size(), std::size_t(2*nc));
+        BOOST_REQUIRE_EQUAL (tof.size(), tof_only.size());
+        for (int c = 0; c < nc; ++c) {
+            if (circulation == 0.0) {
+                BOOST_CHECK_EQUAL (tof[c], tof_only[c]);
+            } else {
+                // The tracers may need more Gauss-Seidel iterations.
+                BOOST_CHECK_CLOSE (tof[c], tof_only[c], tol);
+            }
+            if (head_tracer[c] >= 0) {
+                const int tr = head_tracer[c];
+                BOOST_CHECK_EQUAL (tracer[2*c + tr], 1.0);
+                BOOST_CHECK_EQUAL (tracer[2*c + 1 - tr], 0.0);
+            } else {
+                // All inflow is from cells reached from the heads.
+                BOOST_CHECK_CLOSE (tracer[2*c] + tracer[2*c + 1], 1.0, tol);
+            }
+        }
+
+        std::vector<double> tof_parallel, tracer_parallel;
+        TofReorder parallel(*g);
+        parallel.setParallelComponents(true);
+        parallel.solveTofTracer(&flux[0], &porevolume[0], &source[0], heads,
+                                tof_parallel, tracer_parallel);
+        BOOST_CHECK (tof_parallel == tof);
+        BOOST_CHECK (tracer_parallel == tracer);
+    }
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (ParallelSolveRethrows)
+{
+    Grid grid(21, 16);
+
+    DepthSolver parallel(*grid.g, grid.g->number_of_cells / 2);
+    parallel.setParallelComponents(true);
+    BOOST_CHECK_THROW (parallel.solve(&grid.flux[0]), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (FracFlowTableMatchesExact)
+{
+    // Water injected at the left end of a row of cells.
+    const int nx = 50;
+    UnstructuredGrid* g = create_grid_cart2d(nx, 1, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+
+    const std::vector<double> rho(2, 1000.0);
+    std::vector<double> mu(2);
+    mu[0] = 1.0e-3;
+    mu[1] = 5.0e-3;
+    IncompPropertiesBasic props(2, SaturationPropsBasic::Quadratic, rho, mu,
+                                1.0, 1.0e-13, 2, nc);
+
+    std::vector<int> cells(nc), cell_class(nc, -1);
+    for (int c = 0; c < nc; ++c) {
+        cells[c] = c;
+    }
+    BOOST_CHECK_EQUAL (props.satFuncClasses(nc, &cells[0], &cell_class[0]), 1);
+    BOOST_CHECK_EQUAL (std::count(cell_class.begin(), cell_class.end(), 0), nc);
+
+    TwophaseState exact;
+    exact.init(nc, g->number_of_faces, 2);
+    for (int c = 0; c < nc; ++c) {
+        exact.saturation()[2*c] = 0.0;
+        exact.saturation()[2*c + 1] = 1.0;
+    }
+    for (int f = 1; f < nx; ++f) {
+        exact.faceflux()[f] = 1.0;
+    }
+    TwophaseState tabulated = exact;
+
+    const std::vector<double> porevolume(nc, 1.0);
+    std::vector<double> source(nc, 0.0);
+    source[0] = 1.0;
+    source[nc - 1] = -1.0;
+
+    TransportSolverTwophaseReorder exact_solver(*g, props, 0, 1.0e-12, 100);
+    exact_solver.solve(&porevolume[0], &source[0], 10.0, exact);
+
+    TransportSolverTwophaseReorder table_solver(*g, props, 0, 1.0e-12, 100);
+    table_solver.setFracFlowTable(1001);
+    table_solver.solve(&porevolume[0], &source[0], 10.0, tabulated);
+
+    BOOST_CHECK (exact.saturation()[0] > 0.5);
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_SMALL (tabulated.saturation()[2*c] - exact.saturation()[2*c], 1.0e-4);
+    }
+
+    destroy_grid(g);
+}
@@ -37,6 +37,7 @@
 #include <opm/core/utility/Units.hpp>
 
 #include <array>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <memory>
@@ -667,4 +668,85 @@ BOOST_AUTO_TEST_CASE (GwsegEPS_D)
 */
 }
 
+BOOST_AUTO_TEST_CASE (TabulatedMatchesExact)
+{
+    // Two-phase end-point scaled functions, evaluated exactly and
+    // by linear interpolation in tables.
+
+    Opm::parameter::ParameterGroup param;
+
+    Opm::GridManager gm(1, 1, 4, 1.0, 1.0, 5.0);
+    const UnstructuredGrid& grid = *(gm.c_grid());
+    Opm::ParseContext parseContext;
+    Opm::ParserPtr parser(new Opm::Parser() );
+    Opm::DeckConstPtr deck = parser->parseFile("satfuncEPS_2p.DATA" , parseContext);
+    Opm::EclipseStateConstPtr eclipseState(new Opm::EclipseState(deck , parseContext));
+    Opm::BlackoilPropertiesFromDeck exact(deck, eclipseState, grid, param, false);
+
+    const int table_size = 1001;
+    param.insertParameter("satfunc_tabulated", "true");
+    param.insertParameter("sat_tab_size", std::to_string(table_size));
+    Opm::BlackoilPropertiesFromDeck tabulated(deck, eclipseState, grid, param, false);
+
+    const int np = 2;
+    BOOST_REQUIRE(np == exact.numPhases());
+    BOOST_REQUIRE(np == tabulated.numPhases());
+
+    // Sample points away from the table nodes, so that a small
+    // perturbation stays within one table interval.
+    const int ncell = 4;
+    const int nsample = 97;
+    const int n = ncell*nsample;
+    const double h = 1.0/(table_size - 1);
+    const double eps = 1.0e-3*h;
+    std::vector<double> s(n*np), sp(n*np), sm(n*np);
+    std::vector<int> cells(n);
+    for (int c = 0; c < ncell; ++c) {
+        for (int k = 0; k < nsample; ++k) {
+            const int i = c*nsample + k;
+            const double sw = (std::floor(k*(table_size - 1.0)/nsample) + 0.37)*h;
+            cells[i] = c;
+            s[np*i] = sw;
+            s[np*i + 1] = 1.0 - sw;
+            sp[np*i] = sw + eps;
+            sp[np*i + 1] = 1.0 - sw - eps;
+            sm[np*i] = sw - eps;
+            sm[np*i + 1] = 1.0 - sw + eps;
+        }
+    }
+
+    std::vector<double> kr(n*np), dkr(n*np*np), krt(n*np), dkrt(n*np*np);
+    std::vector<double> krp(n*np), krm(n*np);
+    exact.relperm(n, &s[0], &cells[0], &kr[0], &dkr[0]);
+    tabulated.relperm(n, &s[0], &cells[0], &krt[0], &dkrt[0]);
+    tabulated.relperm(n, &sp[0], &cells[0], &krp[0], 0);
+    tabulated.relperm(n, &sm[0], &cells[0], &krm[0], 0);
+
+    std::vector<double> pc(n*np), pct(n*np), dpct(n*np*np);
+    std::vector<double> pcp(n*np), pcm(n*np);
+    exact.capPress(n, &s[0], &cells[0], &pc[0], 0);
+    tabulated.capPress(n, &s[0], &cells[0], &pct[0], &dpct[0]);
+    tabulated.capPress(n, &sp[0], &cells[0], &pcp[0], 0);
+    tabulated.capPress(n, &sm[0], &cells[0], &pcm[0], 0);
+
+    // The interpolation error is bounded by the change of slope
+    // within one table interval.
+    const double krtol = 5.0*h;
+    const double pctol = 5.0*h*Opm::unit::convert::from(10.0, Opm::unit::barsa);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < np; ++j) {
+            BOOST_CHECK_SMALL(krt[np*i + j] - kr[np*i + j], krtol);
+            BOOST_CHECK_SMALL(pct[np*i + j] - pc[np*i + j], pctol);
+
+            // The derivatives are the slopes of the tabulated functions.
+            const double dkrds = (krp[np*i + j] - krm[np*i + j])/(2.0*eps);
+            const double dpcds = (pcp[np*i + j] - pcm[np*i + j])/(2.0*eps);
+            CHECK(dkrt[np*np*i + j], dkrds, 1.0e-4);
+            CHECK(dpct[np*np*i + j], dpcds, 1.0e-4);
+            BOOST_CHECK_EQUAL(dkrt[np*np*i + np + j], 0.0);
+            BOOST_CHECK_EQUAL(dpct[np*np*i + np + j], 0.0);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
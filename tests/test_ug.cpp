@@ -18,9 +18,12 @@
 /* --- our own headers --- */
 #include <algorithm>
 #include <vector>
+#include <boost/filesystem.hpp>
 #include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
 #include <opm/core/grid/cornerpoint_grid.h>  /* compute_geometry */
 #include <opm/core/grid/GridManager.hpp>  /* compute_geometry */
+#include <opm/core/grid/grid_binary.h>
 #include <opm/core/grid/cpgpreprocess/preprocess.h>
 #include <opm/parser/eclipse/Parser/Parser.hpp>
 #include <opm/parser/eclipse/Parser/ParseContext.hpp>
@@ -114,6 +117,70 @@ BOOST_AUTO_TEST_CASE(EqualEclipseGrid) {
 }
 
 
+BOOST_AUTO_TEST_CASE(BinaryGridCache) {
+    const std::string filename = "CORNERPOINT_ACTNUM.DATA";
+    Opm::ParserPtr parser(new Opm::Parser() );
+    Opm::ParseContext parseContext;
+    Opm::DeckConstPtr deck = parser->parseFile( filename , parseContext);
+
+    std::shared_ptr<const Opm::EclipseGrid> grid(new Opm::EclipseGrid(deck));
+
+    Opm::GridManager reference(grid);
+
+    namespace fs = boost::filesystem;
+    const fs::path dir = fs::temp_directory_path() / fs::unique_path("test_ug-%%%%-%%%%");
+    BOOST_REQUIRE( fs::create_directory( dir ));
+    const std::string ugb = (dir / "test_ug.ugb").string();
+
+    // Round trip through the binary format.
+    BOOST_REQUIRE( write_grid_binary( reference.c_grid() , 42 , ugb.c_str() ));
+    uint64_t key = 0;
+    struct UnstructuredGrid * mapped = map_grid_binary( ugb.c_str() , &key );
+    BOOST_REQUIRE( mapped != NULL );
+    BOOST_CHECK_EQUAL( key , 42u );
+    BOOST_CHECK( grid_equal( reference.c_grid() , mapped ));
+    unmap_grid_binary( mapped );
+
+    Opm::GridManager fromFile( ugb );
+    BOOST_CHECK( grid_equal( reference.c_grid() , fromFile.c_grid() ));
+
+    // Not a binary grid.
+    BOOST_CHECK( map_grid_binary( filename.c_str() , NULL ) == NULL );
+
+    fs::remove( ugb );
+
+    // The first manager fills the cache with a single file.
+    const std::vector<double> noPoreVolumes;
+    {
+        Opm::GridManager first(grid, noPoreVolumes, dir.string());
+        BOOST_CHECK( grid_equal( reference.c_grid() , first.c_grid() ));
+    }
+
+    std::vector<fs::path> cached;
+    for (fs::directory_iterator it(dir), end; it != end; ++it) {
+        cached.push_back( it->path() );
+    }
+    BOOST_REQUIRE_EQUAL( cached.size() , 1u );
+
+    // Replace the cached grid by a different one under the same key.
+    // The second manager must then return that grid, which shows it
+    // was served from the cache rather than processed again.
+    mapped = map_grid_binary( cached[0].string().c_str() , &key );
+    BOOST_REQUIRE( mapped != NULL );
+    unmap_grid_binary( mapped );
+
+    struct UnstructuredGrid * marker = create_grid_cart3d( 2 , 3 , 4 );
+    BOOST_REQUIRE( write_grid_binary( marker , key , cached[0].string().c_str() ));
+    {
+        Opm::GridManager second(grid, noPoreVolumes, dir.string());
+        BOOST_CHECK( grid_equal( marker , second.c_grid() ));
+    }
+    destroy_grid( marker );
+
+    fs::remove_all( dir );
+}
+
+
 BOOST_AUTO_TEST_CASE(TOPS_Fully_Specified) {
     const char *deck1Data =
         "RUNSPEC\n"
@@ -0,0 +1,272 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE WriteVtkDataTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/vtk/writeVtkData.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace Opm;
+
+namespace {
+
+const std::uint64_t BlockSize = 1 << 15;
+
+struct Grid {
+    Grid() : g(create_grid_cart3d(2, 3, 2)) {}
+    ~Grid() { destroy_grid(g); }
+    UnstructuredGrid* g;
+};
+
+template <typename T>
+std::string bytes(const T* data, const std::size_t n)
+{
+    return std::string(reinterpret_cast<const char*>(data), n*sizeof(T));
+}
+
+std::uint64_t readUInt64(const std::string& s, const std::size_t pos)
+{
+    std::uint64_t v;
+    std::memcpy(&v, s.data() + pos, sizeof v);
+    return v;
+}
+
+/// Array of the appended data section, as written.
+struct Decoded {
+    std::string data;            // Decoded data.
+    std::uint64_t encoded_size;  // Size of headers and (compressed) data.
+    std::uint64_t num_blocks;    // Compressed only.
+    std::uint64_t partial_size;  // Compressed only.
+};
+
+Decoded decode(const std::string& appended, const std::uint64_t offset, const bool compressed)
+{
+    Decoded d;
+    if (!compressed) {
+        const std::uint64_t size = readUInt64(appended, offset);
+        d.data = appended.substr(offset + 8, size);
+        d.encoded_size = 8 + size;
+        d.num_blocks = d.partial_size = 0;
+        return d;
+    }
+#if HAVE_ZLIB
+    d.num_blocks = readUInt64(appended, offset);
+    BOOST_CHECK_EQUAL(readUInt64(appended, offset + 8), BlockSize);
+    d.partial_size = readUInt64(appended, offset + 16);
+    std::uint64_t pos = offset + 8*(3 + d.num_blocks);
+    for (std::uint64_t b = 0; b < d.num_blocks; ++b) {
+        const std::uint64_t csize = readUInt64(appended, offset + 8*(3 + b));
+        const bool last = (b + 1 == d.num_blocks);
+        const std::uint64_t size = (last && d.partial_size > 0) ? d.partial_size : BlockSize;
+        std::vector<Bytef> buf(size);
+        uLongf len = size;
+        BOOST_REQUIRE_EQUAL(uncompress(&buf[0], &len,
+                                       reinterpret_cast<const Bytef*>(appended.data() + pos), csize),
+                            Z_OK);
+        BOOST_CHECK_EQUAL(len, size);
+        d.data.append(reinterpret_cast<const char*>(&buf[0]), len);
+        pos += csize;
+    }
+    d.encoded_size = pos - offset;
+#endif
+    return d;
+}
+
+/// Check the appended data section of a .vtu file against the grid
+/// and the written data.
+void checkAppended(const std::string& vtu, const UnstructuredGrid& g,
+                   const std::vector<double>& pressure, const std::vector<double>& big,
+                   const bool compressed)
+{
+    const std::string start_tag = "<AppendedData encoding=\"raw\">\n";
+    const std::size_t start = vtu.find(start_tag);
+    BOOST_REQUIRE(start != std::string::npos);
+    const std::string xml = vtu.substr(0, start);
+    const std::size_t underscore = vtu.find('_', start + start_tag.size());
+    BOOST_REQUIRE(underscore != std::string::npos);
+    const std::string appended = vtu.substr(underscore + 1);
+
+    BOOST_CHECK(xml.find("header_type=\"UInt64\"") != std::string::npos);
+    BOOST_CHECK_EQUAL(xml.find("vtkZLibDataCompressor") != std::string::npos, compressed);
+
+    // Offsets, in order of appearance.
+    std::vector<std::pair<std::string, std::uint64_t> > arrays;
+    const std::regex tag("<DataArray ([^>]*)>");
+    const std::regex name("Name=\"([^\"]*)\"");
+    const std::regex offset("offset=\"([0-9]+)\"");
+    for (std::sregex_iterator it(xml.begin(), xml.end(), tag), end; it != end; ++it) {
+        const std::string attrs = (*it)[1];
+        std::smatch n, o;
+        BOOST_REQUIRE(std::regex_search(attrs, n, name));
+        BOOST_REQUIRE(std::regex_search(attrs, o, offset));
+        arrays.push_back(std::make_pair(n[1].str(), std::stoull(o[1].str())));
+    }
+    BOOST_REQUIRE_EQUAL(arrays.size(), 8u);
+
+    const int nc = g.number_of_cells;
+    std::map<std::string, std::string> expected;
+    expected["Coordinates"] = bytes(g.node_coordinates, 3*g.number_of_nodes);
+    expected["types"] = std::string(nc, char(42));
+    expected["pressure"] = bytes(&pressure[0], pressure.size());
+    expected["big"] = bytes(&big[0], big.size());
+    std::map<std::string, std::uint64_t> expected_size;
+    expected_size["connectivity"] = nc*8*4;
+    expected_size["offsets"] = nc*4;
+    expected_size["faces"] = nc*(1 + 6*(1 + 4))*4;
+    expected_size["faceoffsets"] = nc*4;
+
+    std::uint64_t pos = 0;
+    for (std::size_t i = 0; i < arrays.size(); ++i) {
+        BOOST_TEST_MESSAGE("Array " << arrays[i].first);
+        BOOST_CHECK_EQUAL(arrays[i].second, pos);
+        const Decoded d = decode(appended, arrays[i].second, compressed);
+        if (expected.count(arrays[i].first)) {
+            BOOST_CHECK(d.data == expected[arrays[i].first]);
+        } else {
+            BOOST_REQUIRE(expected_size.count(arrays[i].first));
+            BOOST_CHECK_EQUAL(d.data.size(), expected_size[arrays[i].first]);
+        }
+        if (compressed) {
+            BOOST_CHECK_EQUAL(d.num_blocks, (d.data.size() + BlockSize - 1)/BlockSize);
+            BOOST_CHECK_EQUAL(d.partial_size, d.data.size() % BlockSize);
+        }
+        pos += d.encoded_size;
+    }
+    // The section ends after the last array.
+    const std::regex end("\n *</AppendedData>\n[^]*");
+    BOOST_CHECK(std::regex_match(appended.substr(pos), end));
+}
+
+std::string readFile(const std::string& filename)
+{
+    std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+    BOOST_REQUIRE(is);
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+struct Data {
+    Data(const int nc, const double scale)
+        : pressure(nc), big(nc*500)
+    {
+        for (int c = 0; c < nc; ++c) {
+            pressure[c] = scale*(c + 0.5);
+        }
+        // Two compressed blocks, the last one partial.
+        for (std::size_t i = 0; i < big.size(); ++i) {
+            big[i] = scale*((i*7919) % 1000);
+        }
+        map["pressure"] = &pressure;
+        map["big"] = &big;
+    }
+
+    std::vector<double> pressure;
+    std::vector<double> big;
+    DataMap map;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (AppendedBinary)
+{
+    Grid grid;
+    Data data(grid.g->number_of_cells, 1.0);
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    writeVtkData(*grid.g, data.map, os, VtkBinary);
+    checkAppended(os.str(), *grid.g, data.pressure, data.big, false);
+}
+
+#if HAVE_ZLIB
+BOOST_AUTO_TEST_CASE (AppendedCompressed)
+{
+    Grid grid;
+    Data data(grid.g->number_of_cells, 1.0);
+    BOOST_REQUIRE(data.big.size()*sizeof(double) > BlockSize);
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    writeVtkData(*grid.g, data.map, os, VtkBinaryCompressed);
+    checkAppended(os.str(), *grid.g, data.pressure, data.big, true);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE (SeriesCollection)
+{
+    Grid grid;
+    const int nc = grid.g->number_of_cells;
+    Data step0(nc, 1.0), step1(nc, 2.0), step1_again(nc, 3.0);
+
+    namespace fs = boost::filesystem;
+    const fs::path dir = fs::temp_directory_path() / fs::unique_path("test_writevtkdata-%%%%-%%%%");
+    BOOST_REQUIRE(fs::create_directory(dir));
+
+    const VtkDataFormat formats[] = { VtkAscii, VtkBinary, VtkBinaryCompressed };
+    for (const VtkDataFormat format : formats) {
+        VtkSeriesWriter writer(*grid.g, dir.string(), "series", format);
+        writer.write(step0.map, 0, 0.0);
+        writer.write(step1.map, 1, 1.5);
+        // Rewriting a step replaces its entry.
+        writer.write(step1_again.map, 1, 2.5);
+
+        const std::string pvd = readFile((dir / "series.pvd").string());
+        const std::regex dataset("<DataSet timestep=\"([^\"]*)\" group=\"\" part=\"0\" file=\"([^\"]*)\"/>");
+        std::vector<std::pair<std::string, std::string> > entries;
+        for (std::sregex_iterator it(pvd.begin(), pvd.end(), dataset), end; it != end; ++it) {
+            entries.push_back(std::make_pair((*it)[1].str(), (*it)[2].str()));
+        }
+        BOOST_REQUIRE_EQUAL(entries.size(), 2u);
+        BOOST_CHECK_EQUAL(entries[0].first, "0");
+        BOOST_CHECK_EQUAL(entries[0].second, "series-000.vtu");
+        BOOST_CHECK_EQUAL(entries[1].first, "2.5");
+        BOOST_CHECK_EQUAL(entries[1].second, "series-001.vtu");
+
+        // The files match single writes, also with the reused grid arrays.
+        std::ostringstream os0(std::ios::out | std::ios::binary);
+        writeVtkData(*grid.g, step0.map, os0, format);
+        BOOST_CHECK(readFile((dir / "series-000.vtu").string()) == os0.str());
+        std::ostringstream os1(std::ios::out | std::ios::binary);
+        writeVtkData(*grid.g, step1_again.map, os1, format);
+        BOOST_CHECK(readFile((dir / "series-001.vtu").string()) == os1.str());
+    }
+
+    fs::remove_all(dir);
+}